@@ -0,0 +1,506 @@
+#include "../src/az_snmp_prot_handler.hpp"
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_mib_concurrent.hpp"
+#include "../src/az_snmp_thread_poll.hpp"
+#include "../src/az_snmp_mpmc_thread_poll.hpp"
+#include "../src/az_snmp_packet_pool.hpp"
+#include "../src/az_snmp_arena.hpp"
+#include "../src/az_snmp_mib_cache.hpp"
+#include "../src/az_snmp_mib_static.hpp"
+#include "../src/az_snmp_worker_task.hpp"
+#include "../src/az_snmp_trap_sender.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef AZ_SNMP_BUILD_TYPE
+#define AZ_SNMP_BUILD_TYPE "unknown"
+#endif
+
+using namespace SnmpServer;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Micro-benchmarks of the per-request hot paths.
+ * Prints one JSON document on stdout so runs can be diffed across releases:
+ *   az_snmp_bench [--filter <substring>] [--min-time-ms <ms>] [--max-oids <n>]
+ */
+
+struct BenchOptions {
+    std::string filter;
+    std::chrono::milliseconds min_time{100};
+    size_t max_oids = 1000000;
+};
+
+struct BenchResult {
+    std::string name;
+    std::vector<std::pair<std::string, uint64_t>> params;
+    uint64_t iterations;
+    double ns_per_op;
+};
+
+static std::vector<BenchResult> results;
+
+/**
+ * @brief Keeps the compiler from dropping a computed value
+ */
+template <typename T>
+static inline void keep(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+/**
+ * @brief Runs body(iterations) until one run lasts min_time, then keeps the
+ * median of five runs. body must perform exactly `iterations` operations.
+ */
+template <typename Body>
+static void measure(const BenchOptions& opts, std::string name,
+                    std::vector<std::pair<std::string, uint64_t>> params, Body&& body) {
+    std::string full = name;
+    for (const auto& [key, value] : params) full += "/" + key + "=" + std::to_string(value);
+    if (!opts.filter.empty() && full.find(opts.filter) == std::string::npos) return;
+
+    auto run = [&](uint64_t iterations) {
+        Clock::time_point start = Clock::now();
+        body(iterations);
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    uint64_t iterations = 1;
+    while (true) {
+        double elapsed = run(iterations);
+        if (elapsed >= std::chrono::duration<double, std::nano>(opts.min_time).count() || iterations >= (1ull << 32))
+            break;
+        iterations *= (elapsed < 1e6) ? 10 : 2;
+    }
+
+    std::vector<double> samples;
+    for (int i = 0; i < 5; ++i) samples.push_back(run(iterations) / iterations);
+    std::sort(samples.begin(), samples.end());
+
+    results.push_back({std::move(name), std::move(params), iterations, samples[2]});
+    std::cerr << full << ": " << samples[2] << " ns/op\n";
+}
+
+//==============================================
+// CODEC
+//==============================================
+
+static OID row_oid(uint32_t column, uint32_t row) {
+    return {1,3,6,1,2,1,2,2,1,column,row};
+}
+
+/**
+ * @brief BER request with n NULL varbinds, as a manager would send it
+ */
+static std::vector<uint8_t> encode_request(DataType command, size_t varbinds) {
+    BerWriter writer;
+    size_t list_start = writer.mark();
+    for (size_t i = varbinds; i-- > 0;) {
+        size_t start = writer.mark();
+        writer.write_null();
+        writer.write_oid(row_oid(static_cast<uint32_t>(i % 20 + 1), 1));
+        writer.close(DataType::SEQUENCE, start);
+    }
+    writer.close(DataType::SEQUENCE, list_start);
+    writer.write_integer(0);
+    writer.write_integer(0);
+    writer.write_integer(0x20A5D3E3);
+    writer.close(command, 0);
+    writer.write_octet_string("public");
+    writer.write_integer(0);
+    writer.close(DataType::SEQUENCE, 0);
+    auto data = writer.data();
+    return {data.begin(), data.end()};
+}
+
+static void bench_codec(const BenchOptions& opts) {
+    MibMgr mib;
+    for (uint32_t column = 1; column <= 20; ++column)
+        for (uint32_t row = 1; row <= 2; ++row)
+            mib.create(row_oid(column, row), (column % 2) ? SnmpVariant{int64_t{column * 1000}} : SnmpVariant{"ifDescr value"});
+
+    SnmpProtocolHandler handler(&mib);
+    CachedMib cache(&mib);
+    SnmpProtocolHandler cached_handler(&cache);
+    BerWriter writer;
+
+    for (DataType command : {DataType::GET_REQUEST, DataType::GET_NEXT_REQUEST}) {
+        std::string kind = (command == DataType::GET_REQUEST) ? "get" : "getnext";
+
+        for (uint64_t varbinds : {1, 5, 10, 25, 50}) {
+            std::vector<uint8_t> request = encode_request(command, varbinds);
+            SnmpPdu pdu = *handler.process_request(request);
+
+            measure(opts, "decode/" + kind, {{"varbinds", varbinds}}, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    auto decoded = handler.process_request(request);
+                    keep(decoded);
+                }
+            });
+
+            measure(opts, "decode_arena/" + kind, {{"varbinds", varbinds}}, [&](uint64_t n) {
+                RequestArena& arena = RequestArena::local();
+                for (uint64_t i = 0; i < n; ++i) {
+                    arena.reset();
+                    auto decoded = handler.process_request(request, arena.allocator());
+                    keep(decoded);
+                }
+            });
+
+            measure(opts, "encode/" + kind, {{"varbinds", varbinds}}, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    auto packet = handler.resp_get(pdu, writer);
+                    keep(packet);
+                }
+            });
+
+            if (command == DataType::GET_REQUEST) {
+                measure(opts, "encode_cached/" + kind, {{"varbinds", varbinds}}, [&](uint64_t n) {
+                    for (uint64_t i = 0; i < n; ++i) {
+                        auto packet = cached_handler.resp_get(pdu, writer);
+                        keep(packet);
+                    }
+                });
+            }
+
+            measure(opts, "roundtrip/" + kind, {{"varbinds", varbinds}}, [&](uint64_t n) {
+                RequestArena& arena = RequestArena::local();
+                for (uint64_t i = 0; i < n; ++i) {
+                    arena.reset();
+                    auto decoded = handler.process_request(request, arena.allocator());
+                    auto packet = handler.resp_get(*decoded, writer);
+                    keep(packet);
+                }
+            });
+        }
+    }
+}
+
+/**
+ * @brief GETBULK with one repeater (a table walk step) on a 1000-row column.
+ * Compare ns/op divided by max_repetitions with encode/getnext varbinds=1.
+ */
+static void bench_bulk(const BenchOptions& opts) {
+    MibMgr mib;
+    for (uint32_t row = 1; row <= 1000; ++row)
+        mib.create(row_oid(2, row), "ethernet-csmacd");
+
+    SnmpProtocolHandler handler(&mib);
+    BerWriter writer;
+
+    for (uint64_t repetitions : {10, 25, 50}) {
+        SnmpPdu pdu{};
+        pdu.version = 1;
+        pdu.community = "public";
+        pdu.command = DataTypeToString(DataType::GET_BULK_REQUEST);
+        pdu.req_id = 0x20A5D3E3;
+        pdu.err_idx = static_cast<uint32_t>(repetitions);
+        pdu.vars.push_back({{1,3,6,1,2,1,2,2,1,2,100}, 0, std::monostate{}});
+
+        measure(opts, "encode/getbulk", {{"max_repetitions", repetitions}}, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                auto packet = handler.resp_get(pdu, writer);
+                keep(packet);
+            }
+        });
+    }
+}
+
+/**
+ * @brief Worker decode + answer of a GET with every request timed
+ * (timed=1) or none (timed=0): the cost of a sampled request's statistics
+ */
+static void bench_stats(const BenchOptions& opts) {
+    MibMgr mib;
+    for (uint32_t column = 1; column <= 20; ++column)
+        mib.create(row_oid(column, 1), SnmpVariant{int64_t{column * 1000}});
+
+    SnmpProtocolHandler handler(&mib);
+    BerWriter writer;
+
+    for (uint64_t varbinds : {1, 10}) {
+        SnmpPacketContext context;
+        context.raw_data = encode_request(DataType::GET_REQUEST, varbinds);
+
+        for (uint64_t timed : {0, 1}) {
+            measure(opts, "stats/worker_get", {{"varbinds", varbinds}, {"timed", timed}}, [&](uint64_t n) {
+                RequestArena& arena = RequestArena::local();
+                for (uint64_t i = 0; i < n; ++i) {
+                    context.received_at = timed ? StatClock::now() : StatClock::time_point{};
+                    arena.reset();
+                    auto decoded = decode_request(handler, context, arena);
+                    auto packet = encode_response(handler, *decoded, writer, nullptr, is_timed(context));
+                    keep(packet);
+                }
+            });
+        }
+    }
+}
+
+/**
+ * @brief OID body decode/encode and compare: short (ifTable column),
+ * enterprise (multi-byte sub-identifiers) and string-indexed OIDs
+ */
+static void bench_oid(const BenchOptions& opts) {
+    std::vector<std::pair<uint64_t, OID>> cases{
+        {11, row_oid(10, 1)},
+        {16, {1,3,6,1,4,1,25000,1,1,3,2,1,4,1000,65535,2}},
+        // vacmSecurityToGroupTable row indexed by a 20-character name
+        {32, {1,3,6,1,6,3,16,1,2,1,3,3,20,'m','o','n','i','t','o','r','i','n','g','-','r','e','a','d','o','n','l','y'}},
+    };
+    for (const auto& [length, oid] : cases) {
+        BerWriter writer;
+        writer.write_oid(oid);
+        std::vector<uint8_t> tlv(writer.data().begin(), writer.data().end());
+        std::span<const uint8_t> body = std::span<const uint8_t>(tlv).subspan(2);
+
+        measure(opts, "oid/decode", {{"subids", length}}, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                OID decoded = parseOid(body)->to_oid();
+                keep(decoded);
+            }
+        });
+
+        measure(opts, "oid/encode", {{"subids", length}}, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                writer.reset();
+                writer.write_oid(oid);
+                keep(writer);
+            }
+        });
+
+        OID sibling = oid;
+        sibling.pop_back();
+        sibling.push_back(oid.back() + 1);
+        measure(opts, "oid/compare", {{"subids", length}}, [&](uint64_t n) {
+            int sum = 0;
+            for (uint64_t i = 0; i < n; ++i) {
+                sum += oid_compare(oid, sibling) + oid_has_prefix(sibling, oid);
+                keep(sum);
+            }
+        });
+    }
+}
+
+//==============================================
+// MIB
+//==============================================
+
+static void bench_mib(const BenchOptions& opts) {
+    for (uint64_t objects : {1000, 100000, 1000000}) {
+        if (objects > opts.max_oids) continue;
+
+        // ifTable-like layout: 20 columns x rows
+        uint32_t rows = static_cast<uint32_t>(objects / 20);
+        MibMgr mib;
+        for (uint32_t column = 1; column <= 20; ++column)
+            for (uint32_t row = 1; row <= rows; ++row)
+                mib.create(row_oid(column, row), int64_t{row});
+
+        std::mt19937 rng(42);
+        std::vector<OID> keys;
+        for (int i = 0; i < 4096; ++i)
+            keys.push_back(row_oid(rng() % 20 + 1, rng() % rows + 1));
+
+        measure(opts, "mib/read", {{"objects", objects}}, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                SnmpVariant value = mib.read(keys[i & 4095]);
+                keep(value);
+            }
+        });
+
+        measure(opts, "mib/read_next", {{"objects", objects}}, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                auto next = mib.read_next(keys[i & 4095]);
+                keep(next);
+            }
+        });
+    }
+}
+
+/**
+ * @brief Refresh of one ifTable column (a poll of the device counters):
+ * one update per object against a single apply_batch
+ */
+static void bench_mib_refresh(const BenchOptions& opts) {
+    const uint32_t rows = static_cast<uint32_t>(std::min<uint64_t>(opts.max_oids, 100000) / 20);
+    for (uint64_t batch : {0, 1}) {
+        ConcurrentMibMgr mib;
+        std::vector<MibEntry> column;
+        for (uint32_t c = 1; c <= 20; ++c) {
+            column.clear();
+            for (uint32_t row = 1; row <= rows; ++row) column.push_back({row_oid(c, row), int64_t{row}});
+            mib.apply_batch(column);
+        }
+
+        measure(opts, "mib/refresh_column", {{"rows", rows}, {"batch", batch}}, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                for (MibEntry& entry : column) entry.value = static_cast<int64_t>(i);
+                if (batch) {
+                    mib.apply_batch(column);
+                } else {
+                    for (const MibEntry& entry : column) mib.update(entry.oid, entry.value);
+                }
+            }
+        });
+    }
+}
+
+constexpr auto BENCH_SYSTEM_MIB = make_static_mib({
+    {{1,3,6,1,2,1,1,1,0}, "Benchmark agent, static system group"},
+    {{1,3,6,1,2,1,1,2,0}, StaticOid{1,3,6,1,4,1,32473,1}},
+    {{1,3,6,1,2,1,1,4,0}, "ops@example.com"},
+    {{1,3,6,1,2,1,1,5,0}, "agent-01"},
+    {{1,3,6,1,2,1,1,6,0}, "rack 4"},
+    {{1,3,6,1,2,1,1,7,0}, 72},
+});
+
+/**
+ * @brief GET answers for the system group: dynamic store (read, then
+ * encode) against the compile-time table (pre-encoded)
+ */
+static void bench_static_mib(const BenchOptions& opts) {
+    MibMgr store;
+    for (const StaticMibObject& object : BENCH_SYSTEM_MIB.objects)
+        store.create(object.oid.to_oid(), object.value.to_variant());
+    MibMgr empty;
+    StaticMib mib(BENCH_SYSTEM_MIB, &empty);
+
+    std::vector<OID> keys;
+    for (const StaticMibObject& object : BENCH_SYSTEM_MIB.objects) keys.push_back(object.oid.to_oid());
+    BerWriter writer;
+
+    measure(opts, "static_mib/get_answer", {{"static", 0}}, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            const OID& oid = keys[i % keys.size()];
+            writer.reset();
+            writer.write_variant(store.read(oid));
+            writer.write_oid(oid);
+            writer.close(DataType::SEQUENCE, 0);
+            keep(writer.mark());
+        }
+    });
+
+    measure(opts, "static_mib/get_answer", {{"static", 1}}, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            writer.reset();
+            mib.read_encoded(keys[i % keys.size()], [&](std::span<const uint8_t> varbind) { writer.put_bytes(varbind); });
+            keep(writer.mark());
+        }
+    });
+}
+
+//==============================================
+// POOLS
+//==============================================
+
+/**
+ * @brief One producer enqueues n empty tasks; time until all have run
+ */
+template <typename Pool>
+static void bench_thread_pool(const BenchOptions& opts, const std::string& name) {
+    for (uint64_t workers : {1, 4}) {
+        Pool pool(workers);
+        measure(opts, name + "/enqueue", {{"workers", workers}}, [&](uint64_t n) {
+            std::atomic<uint64_t> done{0};
+            for (uint64_t i = 0; i < n; ++i)
+                pool.enqueue([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+            while (done.load(std::memory_order_acquire) < n) std::this_thread::yield();
+        });
+    }
+}
+
+static void bench_packet_pool(const BenchOptions& opts) {
+    PacketPool pool(1024, 1500);
+    measure(opts, "packet_pool/acquire_release", {}, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            PacketPtr packet = pool.acquire();
+            packet->raw_data.resize(64);
+            keep(packet);
+        }
+    });
+}
+
+//==============================================
+// TRAPS
+//==============================================
+
+/**
+ * @brief Cost of send() on the application thread during a link-flap
+ * storm (the sink's rate limit coalesces nearly all of them)
+ */
+static void bench_traps(const BenchOptions& opts) {
+    TrapSink sink;
+    sink.address.sin_family = AF_INET;
+    sink.address.sin_port = htons(9); // discard
+    sink.address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sink.rate = 10;
+    TrapSender sender({sink});
+    const OID enterprise{1,3,6,1,4,1,32473};
+
+    measure(opts, "trap/send", {{"interfaces", 64}}, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            bool sent = sender.send_link(i & 64, static_cast<uint32_t>(i % 64 + 1), 1, (i & 64) ? 1 : 2, enterprise);
+            keep(sent);
+        }
+    });
+}
+
+//==============================================
+// REPORT
+//==============================================
+
+static void print_json(std::ostream& os) {
+    os << "{\n  \"suite\": \"az_snmp_bench\",\n"
+       << "  \"build_type\": \"" << AZ_SNMP_BUILD_TYPE << "\",\n"
+       << "  \"compiler\": \"" << __VERSION__ << "\",\n"
+       << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+       << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        os << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\"";
+        for (const auto& [key, value] : r.params)
+            os << ", \"" << key << "\": " << value;
+        os << ", \"iterations\": " << r.iterations
+           << ", \"ns_per_op\": " << std::fixed << std::setprecision(2) << r.ns_per_op
+           << ", \"ops_per_sec\": " << std::setprecision(0) << 1e9 / r.ns_per_op << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opts;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--filter") == 0) opts.filter = argv[i + 1];
+        else if (std::strcmp(argv[i], "--min-time-ms") == 0) opts.min_time = std::chrono::milliseconds(std::stoul(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--max-oids") == 0) opts.max_oids = std::stoul(argv[i + 1]);
+        else {
+            std::cerr << "usage: " << argv[0] << " [--filter <substring>] [--min-time-ms <ms>] [--max-oids <n>]\n";
+            return 1;
+        }
+    }
+
+    bench_codec(opts);
+    bench_bulk(opts);
+    bench_stats(opts);
+    bench_oid(opts);
+    bench_mib(opts);
+    bench_mib_refresh(opts);
+    bench_static_mib(opts);
+    bench_thread_pool<ThreadPoll>(opts, "thread_poll");
+    bench_thread_pool<MpmcThreadPoll>(opts, "mpmc_thread_poll");
+    bench_packet_pool(opts);
+    bench_traps(opts);
+
+    print_json(std::cout);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_mib_concurrent.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace SnmpServer;
+
+/**
+ * @brief Baseline: the single-threaded MibMgr behind one big mutex
+ */
+class LockedMibMgr : public MibIntf {
+private:
+    MibMgr mib;
+    std::mutex mutex;
+
+public:
+    void create(const OID& oid, const SnmpVariant& value) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        mib.create(oid, value);
+    }
+    SnmpVariant read(const OID& oid) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        return mib.read(oid);
+    }
+    std::tuple<OID, SnmpVariant> read_next(const OID& oid) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        return mib.read_next(oid);
+    }
+    void update(const OID& oid, const SnmpVariant& value) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        mib.update(oid, value);
+    }
+    void delete_oid(const OID& oid) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        mib.delete_oid(oid);
+    }
+};
+
+static OID row_oid(uint32_t column, uint32_t row) {
+    return {1,3,6,1,2,1,2,2,1,column,row};
+}
+
+/**
+ * @brief Readers do GET/GETNEXT on random rows while one writer refreshes
+ * counters continuously. Returns total reads per second.
+ */
+static double run(MibIntf& mib, uint32_t rows, int readers, std::chrono::milliseconds duration,
+                  uint64_t& updates_done) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> total_reads{0};
+    std::atomic<uint64_t> updates{0};
+
+    std::thread writer([&] {
+        std::mt19937 rng(7);
+        int64_t counter = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            mib.update(row_oid(10, rng() % rows + 1), ++counter);
+            updates.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < readers; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(t + 1);
+            uint64_t reads = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                OID oid = row_oid(rng() % 20 + 1, rng() % rows + 1);
+                if (reads & 1) mib.read_next(oid);
+                else mib.read(oid);
+                ++reads;
+            }
+            total_reads.fetch_add(reads);
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    stop.store(true);
+    for (auto& t : threads) t.join();
+    writer.join();
+
+    updates_done = updates.load();
+    return total_reads.load() / (duration.count() / 1000.0);
+}
+
+template <typename Mib>
+static void bench(const char* name, uint32_t rows, std::chrono::milliseconds duration) {
+    Mib mib;
+    for (uint32_t column = 1; column <= 20; ++column)
+        for (uint32_t row = 1; row <= rows; ++row)
+            mib.create(row_oid(column, row), int64_t{row});
+
+    for (int readers : {1, 2, 4, 8, 16}) {
+        uint64_t updates = 0;
+        double rate = run(mib, rows, readers, duration, updates);
+        std::cout << std::left << std::setw(18) << name
+                  << " readers=" << std::setw(3) << readers
+                  << " reads/s=" << std::setw(12) << static_cast<uint64_t>(rate)
+                  << " per-reader=" << std::setw(12) << static_cast<uint64_t>(rate / readers)
+                  << " updates=" << updates << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t rows = (argc > 1) ? std::stoul(argv[1]) : 5000;
+    std::chrono::milliseconds duration((argc > 2) ? std::stoul(argv[2]) : 1000);
+
+    std::cout << "MIB read scaling: " << rows * 20 << " objects, "
+              << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    bench<LockedMibMgr>("MibMgr+mutex", rows, duration);
+    bench<ConcurrentMibMgr>("ConcurrentMibMgr", rows, duration);
+    return 0;
+}
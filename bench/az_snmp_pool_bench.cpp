@@ -0,0 +1,75 @@
+#include "../src/az_snmp_thread_poll.hpp"
+#include "../src/az_snmp_mpmc_thread_poll.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+using namespace SnmpServer;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief One producer enqueues tasks in bursts (like a listener handing off
+ * a recvmmsg batch); each task records the time between enqueue and the
+ * moment a worker starts running it.
+ */
+template <typename Pool>
+static std::vector<int64_t> run(size_t workers, size_t tasks, size_t burst, std::chrono::microseconds gap) {
+    std::vector<int64_t> latency(tasks);
+    std::atomic<size_t> done{0};
+    {
+        Pool pool(workers);
+        for (size_t i = 0; i < tasks;) {
+            for (size_t b = 0; b < burst && i < tasks; ++b, ++i) {
+                Clock::time_point enqueued = Clock::now();
+                pool.enqueue([&latency, &done, i, enqueued] {
+                    latency[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - enqueued).count();
+                    done.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+            // Let the pool go idle between bursts so parking/wake-up is measured too
+            Clock::time_point until = Clock::now() + gap;
+            while (Clock::now() < until) std::this_thread::yield();
+        }
+        while (done.load() < tasks) std::this_thread::yield();
+    }
+    std::sort(latency.begin(), latency.end());
+    return latency;
+}
+
+static int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+    size_t idx = std::min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * sorted.size()));
+    return sorted[idx];
+}
+
+template <typename Pool>
+static void bench(const char* name, size_t tasks, size_t burst, std::chrono::microseconds gap) {
+    for (size_t workers : {1, 4, 16}) {
+        std::vector<int64_t> lat = run<Pool>(workers, tasks, burst, gap);
+        std::cout << std::left << std::setw(16) << name
+                  << " workers=" << std::setw(3) << workers
+                  << " p50=" << std::setw(8) << percentile(lat, 50) / 1000.0
+                  << " p90=" << std::setw(8) << percentile(lat, 90) / 1000.0
+                  << " p99=" << std::setw(8) << percentile(lat, 99) / 1000.0
+                  << " p99.9=" << std::setw(8) << percentile(lat, 99.9) / 1000.0
+                  << " max=" << lat.back() / 1000.0 << " (us)\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t tasks = (argc > 1) ? std::stoul(argv[1]) : 200000;
+    size_t burst = (argc > 2) ? std::stoul(argv[2]) : 32;
+    std::chrono::microseconds gap((argc > 3) ? std::stoul(argv[3]) : 50);
+
+    std::cout << "Enqueue-to-start latency: " << tasks << " tasks, bursts of " << burst
+              << ", " << gap.count() << "us apart, "
+              << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    bench<ThreadPoll>("ThreadPoll", tasks, burst, gap);
+    bench<MpmcThreadPoll>("MpmcThreadPoll", tasks, burst, gap);
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "../src/az_snmp_connect.hpp"
+#include "../src/az_snmp_epoll_connect.hpp"
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_thread_poll.hpp"
+#include "../src/az_snmp_listener.hpp"
+#include "../src/az_snmp_sharded_listener.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+using namespace SnmpServer;
+
+// GET 1.3.6.1.2.1.1.5.0, community "public"
+static const std::vector<uint8_t> GET_REQUEST = {
+    0x30,0x29,0x02,0x01,0x00,0x04,0x06,0x70,0x75,0x62,0x6C,0x69,0x63,0xA0,0x1C,0x02,
+    0x04,0x20,0xA5,0xD3,0xE3,0x02,0x01,0x00,0x02,0x01,0x00,0x30,0x0E,0x30,0x0C,0x06,
+    0x08,0x2B,0x06,0x01,0x02,0x01,0x01,0x05,0x00,0x05,0x00};
+
+/**
+ * @brief Keeps `window` requests in flight against the agent on loopback
+ * and returns answered requests per second.
+ */
+static double blast(int port, int window, std::chrono::milliseconds duration) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval tv{0, 200000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    sockaddr_in agent{};
+    agent.sin_family = AF_INET;
+    agent.sin_port = htons(port);
+    agent.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    uint64_t answered = 0;
+    uint8_t buf[1500];
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + duration;
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        for (int i = 0; i < window; ++i)
+            sendto(sock, GET_REQUEST.data(), GET_REQUEST.size(), 0, (sockaddr*)&agent, sizeof(agent));
+        for (int i = 0; i < window; ++i) {
+            if (recv(sock, buf, sizeof(buf), 0) <= 0) break; // lost: refill the window
+            ++answered;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    close(sock);
+    return answered / seconds;
+}
+
+template<typename Connect = ConnectMgr>
+static void bench(const char* name, size_t batch, int port, int window, std::chrono::milliseconds duration) {
+    Connect connectMgr(batch);
+    MibMgr mibMgr;
+    mibMgr.create({1,3,6,1,2,1,1,5,0}, "HOSNMP_AGENT_ALPHA");
+    ThreadPoll threadPool(2); // Destroyed (drained) before the MIB
+
+    SnmpListener listener(&connectMgr, &threadPool, &mibMgr);
+    listener.start(port);
+
+    double rate = blast(port, window, duration);
+    std::cout << std::left << std::setw(22) << name
+              << " window=" << std::setw(4) << window
+              << " responses/s=" << std::setw(8) << static_cast<uint64_t>(rate)
+              << " pool-exhausted=" << connectMgr.packet_pool().exhausted() << "\n";
+
+    listener.stop();
+}
+
+template<typename Connect = ConnectMgr>
+static void bench_sharded(const char* name, size_t batch, size_t shards, int port, int window,
+                          std::chrono::milliseconds duration) {
+    Connect connectMgr(batch);
+    MibMgr mibMgr;
+    mibMgr.create({1,3,6,1,2,1,1,5,0}, "HOSNMP_AGENT_ALPHA");
+
+    ShardedSnmpListener listener(&connectMgr, &mibMgr, shards);
+    listener.start(port);
+
+    double rate = blast(port, window, duration);
+    std::cout << std::left << std::setw(22) << name
+              << " window=" << std::setw(4) << window
+              << " responses/s=" << std::setw(8) << static_cast<uint64_t>(rate)
+              << " pool-exhausted=" << connectMgr.packet_pool().exhausted() << "\n";
+
+    listener.stop();
+}
+
+int main(int argc, char** argv) {
+    std::chrono::milliseconds duration((argc > 1) ? std::stoul(argv[1]) : 2000);
+    int port = 10171;
+
+    for (int window : {1, 16, 64}) {
+        bench("recvfrom/sendto", 1, port++, window, duration);
+        bench("recvmmsg/sendmmsg x32", 32, port++, window, duration);
+        bench_sharded("SO_REUSEPORT x2", 32, 2, port++, window, duration);
+        bench<EpollConnectMgr>("epoll x32", 32, port++, window, duration);
+        bench_sharded<EpollConnectMgr>("epoll SO_REUSEPORT x2", 32, 2, port++, window, duration);
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "../src/az_snmp_manager.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace SnmpServer;
+
+/**
+ * @brief Polls an agent with many concurrent GETs (sysDescr, sysName) and
+ * reports what came back. Run against az_server:
+ *   az_snmp_poll 127.0.0.1 10161 10000
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <agent address> <port> [requests] [sockets]\n";
+        return 2;
+    }
+
+    try {
+        sockaddr_in agent = SnmpManager::make_target(argv[1], std::stoi(argv[2]));
+        size_t requests = argc > 3 ? std::stoul(argv[3]) : 1000;
+
+        SnmpManagerOptions options;
+        options.sockets = argc > 4 ? std::stoul(argv[4]) : 2;
+        options.max_in_flight = 256;
+        SnmpManager manager(options);
+
+        std::atomic<size_t> answered{0}, failed{0};
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < requests; ++i) {
+            manager.get(agent, {{1,3,6,1,2,1,1,1,0}, {1,3,6,1,2,1,1,5,0}}, [&, i](PollResult& result) {
+                if (result.status != PollStatus::OK) {
+                    failed++;
+                    return;
+                }
+                if (i == 0) {
+                    for (const SnmpValue& var : result.pdu.vars) {
+                        printOid(std::cout, var.oid, "  ");
+                        printVariant(std::cout, var.value, " = ", true);
+                    }
+                }
+                answered++;
+            });
+        }
+        while (answered + failed < requests)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << answered << " answered, " << failed << " failed (" << manager.retries() << " retries) in "
+                  << elapsed.count() << " s, " << static_cast<size_t>(requests / elapsed.count()) << " requests/s" << std::endl;
+        return failed == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -3,13 +3,17 @@
 #include "../src/az_snmp_mib.hpp"
 #include "../src/az_snmp_thread_poll.hpp"
 #include "../src/az_snmp_listener.hpp"
+#include "../src/az_snmp_sharded_listener.hpp"
 
 #include <iostream>
+#include <string>
 
 /**
  * @brief Main function demonstrating the setup and dependency injection.
+ * @param shards 0 for the listener + thread pool model, N for N SO_REUSEPORT
+ * listeners serving requests run-to-completion.
  */
-int main_snmp_server_example() {
+int main_snmp_server_example(size_t shards) {
     using namespace SnmpServer;
     const int TEST_PORT = 10161;
 
@@ -33,9 +37,15 @@ int main_snmp_server_example() {
 
         // Dependency Injection: Injecting concrete objects via interface pointers
         SnmpListener snmpListener(&connectMgmt, &threadPool, &mibMgr);
+        ShardedSnmpListener shardedListener(&connectMgmt, &mibMgr, shards);
 
         // Start the server
-        snmpListener.start(TEST_PORT);
+        if (shards > 0) {
+            shardedListener.start(TEST_PORT);
+            std::cout << "Serving with " << shards << " SO_REUSEPORT listeners" << std::endl;
+        } else {
+            snmpListener.start(TEST_PORT);
+        }
         std::cout << "SNMP Agent running on UDP port " << TEST_PORT << std::endl;
         std::cout << "Ready to receive requests...Test with:\n\
         snmpget -v 1 -c public localhost:10161 1.3.6.1.2.1.1.1.0\n\
@@ -45,7 +55,8 @@ int main_snmp_server_example() {
         std::this_thread::sleep_for(std::chrono::seconds(30));
 
         // 4. Clean Shutdown
-        snmpListener.stop();
+        if (shards > 0) shardedListener.stop();
+        else snmpListener.stop();
 
     } catch (const std::exception& e) {
         std::cerr << "FATAL Initialization Error: " << e.what() << std::endl;
@@ -56,7 +67,12 @@ int main_snmp_server_example() {
     return 0;
 }
 
-int main()
+int main(int argc, char** argv)
 {
-    return main_snmp_server_example();
+    // --sharded N: N listeners on the same port instead of listener + pool
+    size_t shards = 0;
+    if (argc > 2 && std::string(argv[1]) == "--sharded")
+        shards = std::stoul(argv[2]);
+
+    return main_snmp_server_example(shards);
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_mib_snapshot.hpp"
+
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+using namespace SnmpServer;
+
+/**
+ * @brief Dotted OID ("1.3.6.1.2.1.1.5.0", leading dot allowed)
+ */
+static std::optional<OID> parse_dotted_oid(const std::string& text) {
+    OID oid;
+    std::istringstream in(text.starts_with('.') ? text.substr(1) : text);
+    std::string arc;
+    while (std::getline(in, arc, '.')) {
+        if (arc.empty() || arc.find_first_not_of("0123456789") != std::string::npos) return std::nullopt;
+        oid.push_back(static_cast<uint32_t>(std::stoul(arc)));
+    }
+    if (oid.empty()) return std::nullopt;
+    return oid;
+}
+
+/**
+ * @brief Builds a MibMgr from "<oid> <i|s|o> <value>" lines and writes it
+ * (i: INTEGER, s: OCTET STRING, rest of the line, o: OBJECT IDENTIFIER)
+ */
+static int write_snapshot(const std::string& path) {
+    MibMgr mib;
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(std::cin, line)) {
+        ++line_number;
+        if (line.empty() || line.starts_with('#')) continue;
+
+        std::istringstream in(line);
+        std::string oid_text, type, value;
+        in >> oid_text >> type;
+        std::getline(in >> std::ws, value);
+
+        auto oid = parse_dotted_oid(oid_text);
+        std::optional<OID> value_oid = (type == "o") ? parse_dotted_oid(value) : std::nullopt;
+        if (!oid || (type == "o" && !value_oid) || (type != "i" && type != "s" && type != "o")) {
+            std::cerr << "line " << line_number << ": expected <oid> <i|s|o> <value>\n";
+            return 1;
+        }
+        if (type == "i") mib.create(*oid, int64_t{std::stoll(value)});
+        else if (type == "s") mib.create(*oid, std::pmr::string(value));
+        else mib.create(*oid, *value_oid);
+    }
+
+    std::cout << write_mib_snapshot(mib, path) << " objects written to " << path << std::endl;
+    return 0;
+}
+
+static int dump_snapshot(const std::string& path) {
+    MibSnapshot snapshot(path);
+    std::cout << "Snapshot " << path << " (" << snapshot.size() << " objects):\n";
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        printOid(std::cout, OID(snapshot.oid(i)), "  Key=");
+        printVariant(std::cout, snapshot.value(i), " Value=", true);
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes and inspects MIB snapshots (see MappedMib):
+ *   az_snmp_snapshot write <file> < objects.txt
+ *   az_snmp_snapshot dump <file>
+ * Agents holding a live MibMgr call write_mib_snapshot() directly.
+ */
+int main(int argc, char* argv[]) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if (argc != 3 || (command != "write" && command != "dump")) {
+        std::cerr << "usage: " << argv[0] << " write <file> < objects.txt\n"
+                  << "       " << argv[0] << " dump <file>\n"
+                  << "objects.txt lines: <oid> <i|s|o> <value>, e.g. 1.3.6.1.2.1.1.5.0 s agent-01\n";
+        return 2;
+    }
+
+    try {
+        return command == "write" ? write_snapshot(argv[2]) : dump_snapshot(argv[2]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
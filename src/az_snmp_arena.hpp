@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+#include "az_snmp_global.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief Monotonic arena holding one request at a time.
+ * Decoding a PDU with allocator() carves the community, varbind list
+ * and string values out of a block that is kept for the life of the thread;
+ * nothing is freed individually. reset() rewinds to the start of the block
+ * once the previous request is gone. Requests larger than the block spill
+ * to the heap, and those spills are returned on reset().
+ */
+class RequestArena {
+private:
+    std::unique_ptr<std::byte[]> block;
+    std::pmr::monotonic_buffer_resource resource;
+
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 16 * 1024;
+
+    explicit RequestArena(size_t block_size = DEFAULT_BLOCK_SIZE)
+        : block(new std::byte[block_size]),
+          resource(block.get(), block_size, std::pmr::new_delete_resource()) {}
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    /**
+     * @brief Every object allocated from the arena must be destroyed first
+     */
+    inline void reset() { resource.release(); }
+
+    inline SnmpPdu::allocator_type allocator() { return &resource; }
+
+    /**
+     * @brief Arena of the calling thread (reused across requests)
+     */
+    static RequestArena& local() {
+        thread_local RequestArena arena;
+        return arena;
+    }
+};
+
+} //SnmpServer
@@ -0,0 +1,381 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_intfs.hpp"
+#include "az_snmp_mib.hpp"
+#include "az_snmp_prot_handler.hpp"
+#include "az_snmp_stats.hpp"
+#include "az_snmp_trace.hpp"
+
+namespace SnmpServer {
+
+//==============================================
+// AWAITABLE MIB RESULTS
+//==============================================
+
+/**
+ * @brief Result shared by a MibAwait and the MibCompletion finishing it
+ */
+template<typename T>
+struct MibPending {
+    std::mutex mutex;
+    std::variant<std::monostate, T, std::exception_ptr> result;
+    std::coroutine_handle<> waiter;
+    ThreadPollIntf* executor = nullptr; // Where the waiter resumes (nullptr: completing thread)
+
+    inline bool done() const { return result.index() != 0; }
+};
+
+/**
+ * @brief Resumes handle through executor, inline when there is none or it
+ * no longer accepts tasks (shutting down)
+ */
+inline void resume_on(ThreadPollIntf* executor, std::coroutine_handle<> handle) {
+    if (executor) {
+        try {
+            executor->enqueue([handle] { handle.resume(); });
+            return;
+        } catch (const std::exception& e) {
+            AZ_SNMP_LOG(WARN, "[Async] resuming inline: " << e.what());
+        }
+    }
+    handle.resume();
+}
+
+/**
+ * @brief Awaitable MIB value: either ready (no allocation, no suspension)
+ * or finished later by a MibCompletion from any thread. The awaiting
+ * coroutine resumes on its promise's executor() when it has one.
+ * Await it once.
+ */
+template<typename T>
+class MibAwait {
+private:
+    std::optional<T> value;
+    std::shared_ptr<MibPending<T>> pending;
+
+public:
+    explicit MibAwait(T ready) : value(std::move(ready)) {}
+    explicit MibAwait(std::shared_ptr<MibPending<T>> state) : pending(std::move(state)) {}
+
+    inline bool await_ready() const noexcept { return value.has_value(); }
+
+    template<typename Promise>
+    inline bool await_suspend(std::coroutine_handle<Promise> handle) {
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        if (pending->done()) return false;
+        if constexpr (requires(Promise& promise) { promise.executor(); })
+            pending->executor = handle.promise().executor();
+        pending->waiter = handle;
+        return true;
+    }
+
+    inline T await_resume() {
+        if (value) return std::move(*value);
+        if (auto* error = std::get_if<std::exception_ptr>(&pending->result))
+            std::rethrow_exception(*error);
+        return std::move(std::get<T>(pending->result));
+    }
+};
+
+/**
+ * @brief Producer side of a deferred MibAwait (copyable: hand it to the
+ * thread doing the slow read). Complete or fail it exactly once.
+ */
+template<typename T>
+class MibCompletion {
+private:
+    std::shared_ptr<MibPending<T>> pending = std::make_shared<MibPending<T>>();
+
+    template<typename Result>
+    inline void finish(Result&& result) {
+        std::coroutine_handle<> waiter;
+        ThreadPollIntf* executor = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            pending->result = std::forward<Result>(result);
+            waiter = std::exchange(pending->waiter, nullptr);
+            executor = pending->executor;
+        }
+        if (waiter) resume_on(executor, waiter);
+    }
+
+public:
+    inline MibAwait<T> awaitable() const { return MibAwait<T>(pending); }
+
+    inline void complete(T value) {
+        finish(std::variant<std::monostate, T, std::exception_ptr>(std::in_place_index<1>, std::move(value)));
+    }
+
+    inline void fail(std::exception_ptr error) {
+        finish(std::variant<std::monostate, T, std::exception_ptr>(std::in_place_index<2>, std::move(error)));
+    }
+};
+
+/**
+ * @brief MibIntf whose reads can complete later. Requests served by
+ * AsyncWorkerTask suspend on a pending read and the worker thread moves on
+ * to other requests. The defaults answer at once from the synchronous
+ * reads; override them for the objects that are slow to read.
+ */
+class AsyncMibIntf : public MibIntf {
+public:
+    virtual MibAwait<SnmpVariant> read_async(const OID& oid) {
+        return MibAwait<SnmpVariant>(read(oid));
+    }
+
+    virtual MibAwait<std::tuple<OID, SnmpVariant>> read_next_async(const OID& oid) {
+        return MibAwait<std::tuple<OID, SnmpVariant>>(read_next(oid));
+    }
+};
+
+/**
+ * @brief Runs the reads of slow subtrees (e.g. objects read from a device)
+ * on a dedicated pool, so they block an I/O thread instead of a worker.
+ * Other reads are answered at once. With no subtree given, every read is
+ * offloaded. GETNEXT is offloaded whenever its answer may fall in a slow
+ * subtree. Writes and walk() go straight to the wrapped store.
+ */
+class OffloadedMib : public AsyncMibIntf {
+private:
+    MibIntf* inner;
+    ThreadPollIntf* io_pool;
+    std::vector<OID> slow_subtrees;
+
+    inline bool slow(const OID& oid) const {
+        if (slow_subtrees.empty()) return true;
+        return std::any_of(slow_subtrees.begin(), slow_subtrees.end(), [&](const OID& prefix) {
+            return oid_has_prefix(oid, prefix);
+        });
+    }
+
+    /**
+     * @brief Whether the object after oid may be in a slow subtree
+     */
+    inline bool next_may_be_slow(const OID& oid) const {
+        if (slow_subtrees.empty()) return true;
+        return std::any_of(slow_subtrees.begin(), slow_subtrees.end(), [&](const OID& prefix) {
+            return oid_has_prefix(oid, prefix) || oid_compare(prefix, oid) > 0;
+        });
+    }
+
+    template<typename T, typename Read>
+    inline MibAwait<T> offload(Read read) {
+        MibCompletion<T> done;
+        MibAwait<T> result = done.awaitable();
+        io_pool->enqueue([done, read = std::move(read)]() mutable {
+            try {
+                done.complete(read());
+            } catch (...) {
+                done.fail(std::current_exception());
+            }
+        });
+        return result;
+    }
+
+public:
+    OffloadedMib(MibIntf* mib, ThreadPollIntf* io, std::vector<OID> subtrees = {})
+        : inner(mib), io_pool(io), slow_subtrees(std::move(subtrees)) {}
+
+    inline MibAwait<SnmpVariant> read_async(const OID& oid) override {
+        if (!slow(oid)) return MibAwait<SnmpVariant>(inner->read(oid));
+        return offload<SnmpVariant>([mib = inner, oid] { return mib->read(oid); });
+    }
+
+    inline MibAwait<std::tuple<OID, SnmpVariant>> read_next_async(const OID& oid) override {
+        if (!next_may_be_slow(oid)) return MibAwait<std::tuple<OID, SnmpVariant>>(inner->read_next(oid));
+        return offload<std::tuple<OID, SnmpVariant>>([mib = inner, oid] { return mib->read_next(oid); });
+    }
+
+    inline void create(const OID& oid, const SnmpVariant& value) override { inner->create(oid, value); }
+    inline SnmpVariant read(const OID& oid) override { return inner->read(oid); }
+    inline std::tuple<OID, SnmpVariant> read_next(const OID& oid) override { return inner->read_next(oid); }
+    inline void update(const OID& oid, const SnmpVariant& value) override { inner->update(oid, value); }
+    inline void delete_oid(const OID& oid) override { inner->delete_oid(oid); }
+
+    inline void apply_batch(std::span<const MibEntry> upserts, std::span<const OID> deletes = {}) override {
+        inner->apply_batch(upserts, deletes);
+    }
+
+    inline void walk(const OID& start, const std::function<bool(const OID&, const SnmpVariant&)>& visit) override {
+        inner->walk(start, visit);
+    }
+};
+
+//==============================================
+// COROUTINE WORKER
+//==============================================
+
+/**
+ * @brief Fire-and-forget coroutine serving one request. It starts at once
+ * on the calling thread, resumes on its executor after each pending read
+ * and frees itself (and its packet) when done.
+ */
+struct AsyncRequest {
+    struct promise_type {
+        ThreadPollIntf* resume_executor = nullptr;
+
+        // Sees the coroutine's arguments: the ThreadPollIntf* one is the executor
+        template<typename... Args>
+        promise_type(Args&... args) {
+            (pick(args), ...);
+        }
+
+        template<typename Arg>
+        inline void pick(Arg& arg) {
+            if constexpr (std::is_convertible_v<Arg&, ThreadPollIntf*>) resume_executor = arg;
+        }
+
+        inline ThreadPollIntf* executor() const { return resume_executor; }
+
+        inline AsyncRequest get_return_object() noexcept { return {}; }
+        inline std::suspend_never initial_suspend() noexcept { return {}; }
+        inline std::suspend_never final_suspend() noexcept { return {}; }
+        inline void return_void() noexcept {}
+
+        inline void unhandled_exception() noexcept {
+            stat_count(StatCounter::DROPS);
+            try {
+                throw;
+            } catch (const std::exception& e) {
+                AZ_SNMP_LOG(ERROR, "WORKER ERROR: " << e.what());
+            } catch (...) {
+                AZ_SNMP_LOG(ERROR, "WORKER ERROR: unknown exception");
+            }
+        }
+    };
+};
+
+inline bool is_end_of_mib(const OID& cursor, const OID& next, const SnmpVariant& value) {
+    return std::holds_alternative<ErrorCode>(value) && oid_compare(next, cursor) <= 0;
+}
+
+/**
+ * @brief Encodes the response from the values read and sends it (no
+ * suspension in between: the thread's writer is safe to use)
+ */
+inline void send_async_response(SnmpProtocolHandler& handler, const SnmpPdu& pdu, const std::vector<MibEntry>& values,
+                                ConnectIntf* connect_service, int reply_fd, const sockaddr_in& addr) {
+    thread_local BerWriter writer;
+
+    if (pdu.command == DataTypeToString(DataType::GET_BULK_REQUEST)) {
+        writer.reset_forward(SnmpProtocolHandler::BULK_HEADROOM + pdu.community.size());
+        for (const MibEntry& entry : values)
+            if (!handler.append_varbind(writer, pdu, entry.oid, entry.value)) break;
+    } else {
+        writer.reset();
+        for (auto it = values.rbegin(); it != values.rend(); ++it) {
+            size_t start = writer.mark();
+            writer.write_variant(it->value);
+            writer.write_oid(it->oid);
+            writer.close(DataType::SEQUENCE, start);
+        }
+    }
+    writer.close(DataType::SEQUENCE, 0);
+
+    auto response = handler.write_response_headers(pdu, writer);
+    connect_service->send(reply_fd, response, addr);
+    stat_count(StatCounter::PACKETS_OUT);
+}
+
+/**
+ * @brief Serves one request through an AsyncMibIntf. Pending reads suspend
+ * it and the calling pool thread returns to its queue; the request resumes
+ * on executor once the value is there and answers as soon as it has all
+ * of them.
+ * The PDU is decoded with the default allocator: the thread's RequestArena
+ * is reset by the other requests served while this one waits.
+ */
+inline AsyncRequest AsyncWorkerTask(
+    PacketPtr context,
+    AsyncMibIntf* mib_service,
+    ConnectIntf* connect_service,
+    int listener_socket_fd,
+    [[maybe_unused]] ThreadPollIntf* executor // Read by the promise
+) {
+    SnmpProtocolHandler handler(mib_service);
+    std::optional<SnmpPdu> request = handler.process_request(context->raw_data);
+    if (!request) co_return; // Malformed: no response
+    SnmpPdu& pdu = *request;
+    const SnmpVariant end_of_mib = static_cast<ErrorCode>(DataType::END_OF_MIB_VIEW);
+
+    // Every value first, in the order the synchronous handler encodes them
+    std::vector<MibEntry> values;
+    values.reserve(pdu.vars.size());
+
+    if (pdu.command == DataTypeToString(DataType::GET_REQUEST)) {
+        for (const auto& var : pdu.vars) {
+            // Named first: GCC 12 mishandles co_await inside a braced initializer
+            SnmpVariant value = co_await mib_service->read_async(var.oid);
+            values.push_back({var.oid, std::move(value)});
+        }
+
+    } else if (pdu.command == DataTypeToString(DataType::GET_NEXT_REQUEST)) {
+        for (const auto& var : pdu.vars) {
+            auto [next, value] = co_await mib_service->read_next_async(var.oid);
+            values.push_back({std::move(next), std::move(value)});
+        }
+
+    } else if (pdu.command == DataTypeToString(DataType::GET_BULK_REQUEST)) {
+        size_t non_repeaters = std::min<size_t>(pdu.err_status, pdu.vars.size());
+        size_t repeaters = pdu.vars.size() - non_repeaters;
+        size_t max_repetitions = pdu.err_idx;
+
+        // Reads stop once the response is full, as in write_bulk_varbinds
+        size_t body_len = 0;
+        bool fits = true;
+        auto keep = [&](const OID& oid, SnmpVariant value) {
+            fits = handler.reserve_varbind(body_len, pdu, oid, value);
+            if (fits) values.push_back({oid, std::move(value)});
+        };
+
+        for (size_t i = 0; i < non_repeaters && fits; ++i) {
+            auto [next, value] = co_await mib_service->read_next_async(pdu.vars[i].oid);
+            if (is_end_of_mib(pdu.vars[i].oid, next, value)) keep(pdu.vars[i].oid, end_of_mib);
+            else keep(next, std::move(value));
+        }
+
+        std::vector<OID> cursors;
+        for (size_t r = 0; r < repeaters; ++r)
+            cursors.push_back(pdu.vars[non_repeaters + r].oid);
+        std::vector<bool> ended(repeaters, false);
+
+        for (size_t rep = 0; rep < max_repetitions && repeaters > 0 && fits; ++rep) {
+            bool all_ended = true;
+            for (size_t r = 0; r < repeaters && fits; ++r) {
+                if (!ended[r]) {
+                    auto [next, value] = co_await mib_service->read_next_async(cursors[r]);
+                    if (is_end_of_mib(cursors[r], next, value)) {
+                        ended[r] = true;
+                    } else {
+                        keep(next, std::move(value));
+                        cursors[r] = std::move(next);
+                    }
+                }
+                if (ended[r]) keep(cursors[r], end_of_mib);
+                all_ended = all_ended && ended[r];
+            }
+            // One repeater: a table walk stops at its end
+            if (all_ended) break;
+        }
+
+    } else {
+        AZ_SNMP_LOG(WARN, "[Encode] Invalid command");
+        for (const auto& var : pdu.vars)
+            values.push_back({var.oid, std::monostate{}});
+    }
+
+    int reply_fd = context->socket_fd >= 0 ? context->socket_fd : listener_socket_fd;
+    send_async_response(handler, pdu, values, connect_service, reply_fd, context->client_addr);
+}
+
+} //SnmpServer
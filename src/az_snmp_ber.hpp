@@ -0,0 +1,414 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_simd.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief Non-owning view of a decoded TLV.
+ * The value span points straight into the receive buffer.
+ */
+struct BerTlv {
+    uint8_t tag;
+    std::span<const uint8_t> value;
+};
+
+/**
+ * @brief Lazily decoded OBJECT IDENTIFIER.
+ * Holds the BER body only; sub-identifiers are decoded while iterating.
+ * The body must have been validated by parseOid().
+ */
+class OidView {
+private:
+    std::span<const uint8_t> body;
+
+public:
+    class iterator {
+    private:
+        const uint8_t* pos = nullptr;
+        const uint8_t* end = nullptr;
+        uint32_t first = 0;   // First sub-identifier, carries arcs 0 and 1
+        uint32_t current = 0;
+        int arc = -1;         // -1 when exhausted
+
+        static uint32_t decode(const uint8_t*& p, const uint8_t* e) {
+            uint32_t subid = 0;
+            while (p < e) {
+                uint8_t byte = *p++;
+                subid = (subid << 7) | (byte & 0x7F);
+                if ((byte & 0x80) == 0) break;
+            }
+            return subid;
+        }
+
+    public:
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        iterator(const uint8_t* b, const uint8_t* e) : pos(b), end(e) {
+            if (pos == end) return;
+            first = decode(pos, end);
+            current = (first < 80) ? first / 40 : 2;
+            arc = 0;
+        }
+
+        uint32_t operator*() const { return current; }
+
+        iterator& operator++() {
+            if (arc == 0) {
+                current = (first < 80) ? first % 40 : first - 80;
+                arc = 1;
+            } else if (pos == end) {
+                arc = -1;
+            } else {
+                current = decode(pos, end);
+                ++arc;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(std::default_sentinel_t) const { return arc < 0; }
+        bool operator==(const iterator& other) const {
+            return arc == other.arc && (arc < 0 || pos == other.pos);
+        }
+    };
+
+    OidView() = default;
+    explicit OidView(std::span<const uint8_t> ber_body) : body(ber_body) {}
+
+    iterator begin() const { return iterator(body.data(), body.data() + body.size()); }
+    std::default_sentinel_t end() const { return {}; }
+
+    std::span<const uint8_t> encoded() const { return body; }
+
+    /**
+     * @brief Number of sub-identifiers (counted without decoding).
+     */
+    size_t size() const {
+        if (body.empty()) return 0;
+        return ber_count_subids(body) + 1; // First byte group holds two arcs
+    }
+
+    bool operator==(const OID& oid) const {
+        size_t i = 0;
+        for (uint32_t subid : *this) {
+            if (i >= oid.size() || oid[i] != subid) return false;
+            ++i;
+        }
+        return i == oid.size();
+    }
+
+    /**
+     * @brief Materialize into an owning OID (no allocation up to
+     * SnmpOid::INLINE_CAPACITY sub-identifiers).
+     */
+    OID to_oid() const {
+        OID oid;
+        if (body.empty()) return oid;
+        // Decode in bulk one slot in, then split the first group into arcs
+        oid.assign_with(size(), [&](uint32_t* ids) {
+            size_t count = ber_decode_subids(body, ids + 1);
+            uint32_t first = ids[1];
+            ids[0] = (first < 80) ? first / 40 : 2;
+            ids[1] = (first < 80) ? first % 40 : first - 80;
+            return count + 1;
+        });
+        return oid;
+    }
+};
+
+//==============================================
+// DECODING PRIMITIVES
+//==============================================
+
+/**
+ * @brief Reads one TLV at index, supporting short and long form lengths.
+ * Bounds are checked against raw_data; index is advanced past the value.
+ */
+inline std::optional<BerTlv> readBerTlv(std::span<const uint8_t> raw_data, size_t& index) {
+    if (index + 2 > raw_data.size()) return std::nullopt;
+
+    uint8_t tag = raw_data[index++];
+    size_t len = raw_data[index++];
+
+    if (len & 0x80) {
+        size_t num_bytes = len & 0x7F;
+        // Indefinite length (0x80) is not allowed in SNMP
+        if (num_bytes == 0 || num_bytes > 4 || index + num_bytes > raw_data.size())
+            return std::nullopt;
+        len = 0;
+        for (size_t i = 0; i < num_bytes; ++i)
+            len = (len << 8) | raw_data[index++];
+    }
+
+    if (len > raw_data.size() - index) return std::nullopt;
+
+    BerTlv tlv{tag, raw_data.subspan(index, len)};
+    index += len;
+    return tlv;
+}
+
+/**
+ * @brief String value parser (view into the buffer)
+ */
+inline std::string_view parseOctetString(std::span<const uint8_t> value) {
+    return {reinterpret_cast<const char*>(value.data()), value.size()};
+}
+
+/**
+ * @brief Integral value parser (two's complement, up to 64 bits)
+ */
+inline std::optional<int64_t> parseInt(std::span<const uint8_t> value) {
+    if (value.empty() || value.size() > 8) return std::nullopt;
+
+    uint64_t result = (value[0] & 0x80) ? ~uint64_t{0} : 0;
+    for (uint8_t byte : value)
+        result = (result << 8) | byte;
+    return static_cast<int64_t>(result);
+}
+
+/**
+ * @brief Object Identifier parser (validates, does not decode)
+ */
+inline std::optional<OidView> parseOid(std::span<const uint8_t> value) {
+    // Last byte must terminate a sub-identifier
+    if (value.empty() || (value.back() & 0x80)) return std::nullopt;
+    return OidView(value);
+}
+
+//==============================================
+// ENCODING PRIMITIVES
+//==============================================
+
+/**
+ * @brief Bytes taken by a BER length field
+ */
+inline size_t ber_length_size(size_t len) {
+    if (len < 0x80) return 1;
+    size_t n = 1;
+    for (; len > 0; len >>= 8) ++n;
+    return n;
+}
+
+/**
+ * @brief Bytes taken by an encoded INTEGER (tag, length and content)
+ */
+inline size_t ber_integer_size(int64_t value) {
+    size_t n = 1;
+    while (!(value >= -128 && value <= 127)) {
+        value >>= 8;
+        ++n;
+    }
+    return 2 + n;
+}
+
+/**
+ * @brief Single-pass BER encoder writing from the end of a reusable buffer.
+ * Children are written before their parent, so every length is already
+ * known when the parent header is prepended. Once the buffer has grown to
+ * the working size no further allocation happens.
+ *
+ * For content produced in order (e.g. GETBULK varbinds), reset_forward()
+ * leaves headroom at the front: append() adds bytes after the current
+ * content and the headers are prepended afterwards as usual.
+ */
+class BerWriter {
+private:
+    std::vector<uint8_t> storage;
+    size_t head;
+    size_t tail;
+
+    inline void reserve_front(size_t n) {
+        if (n <= head) return;
+
+        size_t used = tail - head;
+        size_t back = storage.size() - tail;
+        size_t capacity = std::max(storage.size() * 2, used + n + back);
+        std::vector<uint8_t> grown(capacity);
+        std::copy(storage.begin() + head, storage.begin() + tail, grown.end() - back - used);
+        storage.swap(grown);
+        tail = capacity - back;
+        head = tail - used;
+    }
+
+    inline void reserve_back(size_t n) {
+        if (tail + n <= storage.size()) return;
+        storage.resize(std::max(storage.size() * 2, tail + n));
+    }
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1500;
+
+    explicit BerWriter(size_t capacity = DEFAULT_CAPACITY)
+        : storage(capacity), head(capacity), tail(capacity) {}
+
+    /**
+     * @brief Discard the encoded bytes, keeping the buffer
+     */
+    inline void reset() { head = tail = storage.size(); }
+
+    /**
+     * @brief Discard the encoded bytes and start appending after headroom
+     * bytes reserved for the headers prepended later
+     */
+    inline void reset_forward(size_t headroom) {
+        if (storage.size() < headroom) storage.resize(headroom);
+        head = tail = headroom;
+    }
+
+    /**
+     * @brief Bytes written so far (used to delimit constructed values)
+     */
+    inline size_t mark() const { return tail - head; }
+
+    inline std::span<const uint8_t> data() const {
+        return {storage.data() + head, tail - head};
+    }
+
+    /**
+     * @brief Adds bytes after the current content
+     */
+    inline void append(std::span<const uint8_t> bytes) {
+        reserve_back(bytes.size());
+        std::copy(bytes.begin(), bytes.end(), storage.begin() + tail);
+        tail += bytes.size();
+    }
+
+    inline void put_byte(uint8_t byte) {
+        reserve_front(1);
+        storage[--head] = byte;
+    }
+
+    inline void put_bytes(std::span<const uint8_t> bytes) {
+        reserve_front(bytes.size());
+        head -= bytes.size();
+        std::copy(bytes.begin(), bytes.end(), storage.begin() + head);
+    }
+
+    /**
+     * @brief Length in short form (< 128) or long form
+     */
+    inline void put_length(size_t len) {
+        if (len < 0x80) {
+            put_byte(static_cast<uint8_t>(len));
+            return;
+        }
+        uint8_t num_bytes = 0;
+        while (len > 0) {
+            put_byte(static_cast<uint8_t>(len & 0xFF));
+            len >>= 8;
+            ++num_bytes;
+        }
+        put_byte(0x80 | num_bytes);
+    }
+
+    inline void put_header(uint8_t tag, size_t len) {
+        put_length(len);
+        put_byte(tag);
+    }
+
+    /**
+     * @brief Closes a constructed value opened at start (a previous mark())
+     */
+    inline void close(uint8_t tag, size_t start) {
+        put_header(tag, mark() - start);
+    }
+
+    inline void close(DataType type, size_t start) {
+        close(static_cast<uint8_t>(type), start);
+    }
+
+    /**
+    * @brief Encodes an INTEGER (minimal two's complement length), or an
+    * application integer type (Counter32, TimeTicks...)
+    */
+    inline void write_integer(int64_t value, DataType type = DataType::INTEGER) {
+        size_t start = mark();
+        while (true) {
+            uint8_t byte = static_cast<uint8_t>(value & 0xFF);
+            put_byte(byte);
+            value >>= 8; // arithmetic shift keeps the sign
+            if ((value == 0 && !(byte & 0x80)) || (value == -1 && (byte & 0x80)))
+                break;
+        }
+        close(type, start);
+    }
+
+    /**
+    * @brief Encodes an OCTET STRING (or an IpAddress)
+    */
+    inline void write_octet_string(std::string_view s, DataType type = DataType::OCTET_STRING) {
+        put_bytes({reinterpret_cast<const uint8_t*>(s.data()), s.size()});
+        put_header(static_cast<uint8_t>(type), s.size());
+    }
+
+    /**
+    * @brief Encodes a NULL
+    */
+    inline void write_null() {
+        put_header(static_cast<uint8_t>(DataType::VAL_NULL), 0);
+    }
+
+    /**
+    * @brief Encodes an exception value (noSuchObject, endOfMibView...)
+    */
+    inline void write_error(ErrorCode errorId) {
+        put_header(errorId, 0);
+    }
+
+    /**
+    * @brief Encodes an OID (first two arcs packed as X*40+Y)
+    */
+    inline void write_oid(const OID& oid) {
+        size_t start = mark();
+        uint32_t first = (oid.size() > 0) ? oid[0] * 40 : 0;
+        if (oid.size() > 1) first += oid[1];
+        size_t rest = (oid.size() > 2) ? oid.size() - 2 : 0;
+
+        // Body size is known up front: encode it forward in one go
+        size_t size = ber_subid_size(first) + ber_subids_size(oid.data() + 2, rest);
+        reserve_front(size);
+        head -= size;
+        uint8_t* out = ber_encode_subid(first, storage.data() + head);
+        ber_encode_subids(oid.data() + 2, rest, out);
+
+        close(DataType::OBJECT_ID, start);
+    }
+
+    /**
+    * @brief Encodes any supported SnmpVariant value
+    */
+    inline void write_variant(const SnmpVariant& value) {
+        std::visit([&](auto&& arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, int64_t>) {
+                write_integer(arg);
+            } else if constexpr (std::is_same_v<T, std::pmr::string>) {
+                write_octet_string(arg);
+            } else if constexpr (std::is_same_v<T, OID>) {
+                write_oid(arg);
+            } else if constexpr (std::is_same_v<T, ErrorCode>) {
+                write_error(arg);
+            } else {
+                write_null();
+            }
+        }, value);
+    }
+};
+
+} //SnmpServer
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_prot_handler.hpp"
+#include "az_snmp_trace.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief Shares the work of identical read requests in flight.
+ * Requests are identical when version, command, error fields (GETBULK
+ * parameters) and the encoded VarBindList match byte for byte. The first
+ * one (the leader) reads the MIB and encodes the VarBindList; requests
+ * arriving meanwhile wait for it and only add their own headers
+ * (req_id and community). Nothing is kept once the leader is done, so
+ * answers are never older than the request.
+ *
+ * Pays off when pollers ask for the same objects at the same moment and
+ * the MIB is slow (e.g. LazyMib providers). One instance is shared by all
+ * the workers of a listener.
+ */
+class RequestCoalescer {
+private:
+    struct Flight {
+        std::string key;
+        std::vector<uint8_t> varbinds; // Encoded VarBindList SEQUENCE
+        size_t waiters = 0;
+        bool done = false;
+        bool failed = false;
+    };
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::unordered_map<std::string_view, std::shared_ptr<Flight>> flights; // Keys owned by the flights
+
+    std::atomic<uint64_t> leader_count{0};
+    std::atomic<uint64_t> coalesced_count{0};
+
+    static inline bool coalescable(const SnmpPdu& pdu) {
+        return !pdu.raw_vars.empty() &&
+               (pdu.command == DataTypeToString(DataType::GET_REQUEST) ||
+                pdu.command == DataTypeToString(DataType::GET_NEXT_REQUEST) ||
+                pdu.command == DataTypeToString(DataType::GET_BULK_REQUEST));
+    }
+
+    static inline void make_key(const SnmpPdu& pdu, std::string& key) {
+        uint32_t fields[3] = {pdu.version, pdu.err_status, pdu.err_idx};
+        key.assign(reinterpret_cast<const char*>(fields), sizeof(fields));
+        key.append(pdu.command).push_back('\0');
+        key.append(reinterpret_cast<const char*>(pdu.raw_vars.data()), pdu.raw_vars.size());
+    }
+
+    /**
+     * @brief Closes the flight; varbinds are copied only for waiting requests
+     */
+    inline void finish(const std::shared_ptr<Flight>& flight, std::span<const uint8_t> varbinds, bool failed) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            flights.erase(flight->key);
+            if (flight->waiters > 0 && !failed)
+                flight->varbinds.assign(varbinds.begin(), varbinds.end());
+            flight->failed = failed;
+            flight->done = true;
+        }
+        finished.notify_all();
+    }
+
+public:
+    /**
+     * @brief Requests that computed their VarBindList
+     */
+    inline uint64_t leaders() const { return leader_count.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Requests answered from another request's VarBindList
+     */
+    inline uint64_t coalesced() const { return coalesced_count.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Same as handler.resp_get(pdu, writer), sharing the MIB reads
+     * and encoding with identical requests in flight
+     */
+    inline std::span<const uint8_t> respond(SnmpProtocolHandler& handler, const SnmpPdu& pdu, BerWriter& writer) {
+        if (!coalescable(pdu))
+            return handler.resp_get(pdu, writer);
+
+        thread_local std::string key;
+        make_key(pdu, key);
+
+        std::shared_ptr<Flight> flight;
+        bool leader = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto it = flights.find(key);
+            if (it != flights.end()) {
+                flight = it->second;
+                ++flight->waiters;
+                // Waiting on the leader's MIB reads
+                MibStageClock::Scope mib_time;
+                finished.wait(lock, [&] { return flight->done; });
+            } else {
+                flight = std::make_shared<Flight>();
+                flight->key = key;
+                flights.emplace(flight->key, flight);
+                leader = true;
+            }
+        }
+
+        if (!leader) {
+            // The leader's VarBindList no longer changes
+            if (!flight->failed) {
+                if (auto response = handler.respond_with_varbinds(pdu, flight->varbinds, writer)) {
+                    coalesced_count.fetch_add(1, std::memory_order_relaxed);
+                    AZ_SNMP_LOG(DEBUG, "[Coalesce] req_id " << pdu.req_id << " answered from a request in flight");
+                    return *response;
+                }
+            }
+            return handler.resp_get(pdu, writer);
+        }
+
+        leader_count.fetch_add(1, std::memory_order_relaxed);
+        try {
+            handler.write_varbind_list(pdu, writer);
+        } catch (...) {
+            finish(flight, {}, true);
+            throw;
+        }
+        finish(flight, writer.data(), false);
+
+        auto packet = handler.write_response_headers(pdu, writer);
+        AZ_SNMP_LOG_FMT(DEBUG, os, print_hex_buffer(os, packet, "resp_get >>> "));
+        return packet;
+    }
+};
+
+} //SnmpServer
@@ -5,8 +5,18 @@
 #include <functional>
 #include <cstring>
 #include <unistd.h>
+#include <cerrno>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <poll.h>
+#include <sys/socket.h>
 
 #include "../src/az_snmp_intfs.hpp"
+#include "../src/az_snmp_packet_pool.hpp"
+#include "../src/az_snmp_stats.hpp"
 
 namespace SnmpServer {
 
@@ -15,19 +25,91 @@ namespace SnmpServer {
  * Inherits from ConnectIntf.
  */
 class ConnectMgr : public ConnectIntf {
-private:
+protected:
     const int MAX_UDP_SIZE = 1500;
 
-public:
-    inline int init_socket(int port) override {
-        int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    // Longest wait for send buffer room on a non-blocking socket
+    static constexpr int SEND_WAIT_MS = 10;
+
+    // Datagrams per recvmmsg/sendmmsg (1 = one syscall per packet)
+    size_t batch_size;
+
+    // Receive buffers and contexts, recycled once the response is sent
+    PacketPool pool;
+
+    /**
+     * @brief Pre-registered receive slots for recvmmsg, one set per thread.
+     * Each slot holds a pooled context whose buffer the kernel writes into
+     * directly; only the slots consumed by a call are re-armed.
+     */
+    struct RecvSlots {
+        SnmpPacketBatch contexts;
+        std::vector<iovec> iov;
+        std::vector<mmsghdr> msgs;
+    };
+
+    // Owned here (not thread_local) so armed contexts return to the pool
+    // before it is destroyed; a thread-local cache skips the lock
+    std::mutex slots_mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<RecvSlots>> slots_by_thread;
+    const uint64_t instance_id;
+
+    static uint64_t next_instance_id() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    inline void arm_slot(RecvSlots& slots, size_t i) {
+        auto& context = slots.contexts[i];
+        if (!context) context = pool.acquire();
+        slots.iov[i] = {context->raw_data.data(), context->raw_data.size()};
+
+        msghdr& hdr = slots.msgs[i].msg_hdr;
+        std::memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_iov = &slots.iov[i];
+        hdr.msg_iovlen = 1;
+        hdr.msg_name = &context->client_addr;
+        hdr.msg_namelen = sizeof(context->client_addr);
+    }
+
+    inline RecvSlots& recv_slots() {
+        thread_local uint64_t cached_id = 0;
+        thread_local RecvSlots* cached = nullptr;
+        if (cached_id == instance_id) return *cached;
+
+        std::lock_guard<std::mutex> lock(slots_mutex);
+        auto& slots = slots_by_thread[std::this_thread::get_id()];
+        if (!slots) {
+            slots = std::make_unique<RecvSlots>();
+            slots->contexts.resize(batch_size);
+            slots->iov.resize(batch_size);
+            slots->msgs.resize(batch_size);
+            for (size_t i = 0; i < batch_size; ++i) arm_slot(*slots, i);
+        }
+        cached_id = instance_id;
+        cached = slots.get();
+        return *slots;
+    }
+
+    /**
+     * @param address Local address to bind (INADDR_ANY: every interface), network order
+     * @param type_flags Extra socket() type flags (e.g. SOCK_NONBLOCK)
+     */
+    inline int open_socket(int port, bool reuse_port, in_addr_t address = INADDR_ANY, int type_flags = 0) {
+        int sockfd = socket(AF_INET, SOCK_DGRAM | type_flags, 0);
         if (sockfd < 0) throw std::runtime_error("Failed to create socket.");
 
+        int enable = 1;
+        if (reuse_port && setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+            close(sockfd);
+            throw std::runtime_error("Failed to set SO_REUSEPORT.");
+        }
+
         sockaddr_in servaddr;
         std::memset(&servaddr, 0, sizeof(servaddr));
         servaddr.sin_family = AF_INET;
         servaddr.sin_port = htons(port);
-        servaddr.sin_addr.s_addr = INADDR_ANY;
+        servaddr.sin_addr.s_addr = address;
 
         if (bind(sockfd, (const struct sockaddr *)&servaddr, sizeof(servaddr)) < 0) {
             close(sockfd);
@@ -36,18 +118,62 @@ public:
         return sockfd;
     }
 
-    inline void send(int sock_fd, const std::vector<uint8_t>& data, const sockaddr_in& addr) override {
-        sendto(sock_fd, data.data(), data.size(), 0, (const struct sockaddr *)&addr, sizeof(addr));
+    /**
+     * @brief Moves the datagrams of one recvmmsg call into out, the
+     * consumed slots being re-armed
+     */
+    inline size_t recv_into(int sock_fd, SnmpPacketBatch& out, int flags) {
+        RecvSlots& slots = recv_slots();
+
+        int received = recvmmsg(sock_fd, slots.msgs.data(), batch_size, flags, nullptr);
+        if (received <= 0) return 0;
+
+        size_t count = 0;
+        for (int i = 0; i < received; ++i) {
+            auto& context = slots.contexts[i];
+            unsigned int len = slots.msgs[i].msg_len;
+            if (len == 0) continue;
+
+            context->raw_data.resize(len);
+            out.push_back(std::move(context));
+            ++count;
+        }
+        for (int i = 0; i < received; ++i) arm_slot(slots, i);
+
+        return count;
+    }
+
+public:
+    /**
+     * @param batch Datagrams per recvmmsg/sendmmsg
+     * @param pool_capacity Packet contexts kept for reuse (in flight at once)
+     */
+    explicit ConnectMgr(size_t batch = 1, size_t pool_capacity = PacketPool::DEFAULT_CAPACITY)
+        : batch_size(std::max<size_t>(batch, 1)), pool(pool_capacity, MAX_UDP_SIZE),
+          instance_id(next_instance_id()) {}
+
+    inline const PacketPool& packet_pool() const { return pool; }
+
+    inline int init_socket(int port) override {
+        return open_socket(port, false);
+    }
+
+    inline int init_shared_socket(int port) override {
+        return open_socket(port, true);
+    }
+
+    inline void send(int sock_fd, std::span<const uint8_t> data, const sockaddr_in& addr) override {
+        if (sendto(sock_fd, data.data(), data.size(), 0, (const struct sockaddr *)&addr, sizeof(addr)) < 0)
+            stat_count(StatCounter::SEND_ERRORS);
     }
 
-    inline std::unique_ptr<SnmpPacketContext> receive(int sock_fd) override {
-        auto context = std::make_unique<SnmpPacketContext>();
-        context->raw_data.resize(MAX_UDP_SIZE);
+    inline PacketPtr receive(int sock_fd) override {
+        PacketPtr context = pool.acquire();
         socklen_t addr_len = sizeof(context->client_addr);
 
         // Blocking call to receive the packet
         ssize_t bytes_received = recvfrom(
-            sock_fd, context->raw_data.data(), MAX_UDP_SIZE, 0,
+            sock_fd, context->raw_data.data(), context->raw_data.size(), 0,
             (struct sockaddr *)&context->client_addr, &addr_len
         );
 
@@ -57,6 +183,72 @@ public:
         }
         return nullptr;
     }
+
+    /**
+     * @brief Pulls up to batch_size datagrams with a single recvmmsg
+     */
+    inline size_t receive_batch(int sock_fd, SnmpPacketBatch& out) override {
+        if (batch_size == 1) return ConnectIntf::receive_batch(sock_fd, out);
+
+        // Blocks for the first datagram, then takes whatever is queued
+        return recv_into(sock_fd, out, MSG_WAITFORONE);
+    }
+
+    /**
+     * @brief Flushes responses with sendmmsg, one call per run of packets
+     * leaving through the same socket (retries partial sends)
+     */
+    inline void send_batch(int sock_fd, std::span<const SnmpOutPacket> packets) override {
+        if (batch_size == 1 || packets.size() == 1) {
+            ConnectIntf::send_batch(sock_fd, packets);
+            return;
+        }
+
+        thread_local std::vector<iovec> iov;
+        thread_local std::vector<mmsghdr> msgs;
+        iov.resize(packets.size());
+        msgs.resize(packets.size());
+
+        for (size_t i = 0; i < packets.size(); ++i) {
+            iov[i] = {const_cast<uint8_t*>(packets[i].data.data()), packets[i].data.size()};
+
+            msghdr& hdr = msgs[i].msg_hdr;
+            std::memset(&hdr, 0, sizeof(hdr));
+            hdr.msg_iov = &iov[i];
+            hdr.msg_iovlen = 1;
+            hdr.msg_name = const_cast<sockaddr_in*>(&packets[i].addr);
+            hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+
+        auto socket_of = [sock_fd](const SnmpOutPacket& packet) { return packet.socket_fd >= 0 ? packet.socket_fd : sock_fd; };
+
+        size_t sent = 0;
+        bool waited = false;
+        while (sent < packets.size()) {
+            int fd = socket_of(packets[sent]);
+            size_t end = sent + 1;
+            while (end < packets.size() && socket_of(packets[end]) == fd) ++end;
+
+            int n = sendmmsg(fd, msgs.data() + sent, end - sent, 0);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) continue;
+                // Non-blocking socket with a full send buffer: wait for room once
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && !waited) {
+                    pollfd writable{fd, POLLOUT, 0};
+                    poll(&writable, 1, SEND_WAIT_MS);
+                    waited = true;
+                    continue;
+                }
+                // Drop the datagram the kernel refused and move on (UDP semantics)
+                stat_count(StatCounter::SEND_ERRORS);
+                ++sent;
+                waited = false;
+                continue;
+            }
+            sent += n;
+            waited = false;
+        }
+    }
 };
 
 } //SnmpServer
\ No newline at end of file
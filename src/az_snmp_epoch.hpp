@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+
+// Maximum number of threads reading under an EpochGuard at the same time
+#ifndef AZ_SNMP_EBR_MAX_THREADS
+#define AZ_SNMP_EBR_MAX_THREADS 256
+#endif
+
+namespace SnmpServer {
+
+/**
+ * @brief Process-wide epoch-based reclamation (EBR) domain.
+ *
+ * Readers pin the current epoch in a per-thread slot for the duration of an
+ * EpochGuard (two stores, no locks, no retries: wait-free). Writers publish
+ * a new version, retire the old one with the epoch it was retired at, and
+ * free it once no pinned reader is at that epoch or older.
+ */
+class EpochDomain {
+private:
+    static constexpr uint64_t IDLE = 0;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{IDLE};
+        std::atomic<bool> in_use{false};
+    };
+
+    std::atomic<uint64_t> global_epoch{1};
+    std::array<Slot, AZ_SNMP_EBR_MAX_THREADS> slots;
+
+    /**
+     * @brief Per-thread slot ownership (released at thread exit)
+     */
+    struct ThreadSlot {
+        Slot* slot = nullptr;
+        uint32_t depth = 0;
+
+        ~ThreadSlot() {
+            if (slot) slot->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    inline Slot& acquire_slot(ThreadSlot& local) {
+        if (local.slot) return *local.slot;
+
+        for (Slot& slot : slots) {
+            bool expected = false;
+            if (slot.in_use.compare_exchange_strong(expected, true)) {
+                local.slot = &slot;
+                return slot;
+            }
+        }
+        throw std::runtime_error("EpochDomain: more than AZ_SNMP_EBR_MAX_THREADS reader threads.");
+    }
+
+    static ThreadSlot& local_slot() {
+        thread_local ThreadSlot local;
+        return local;
+    }
+
+public:
+    static EpochDomain& instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    /**
+     * @brief Reader side: pins the current epoch (re-entrant)
+     */
+    inline void enter() {
+        ThreadSlot& local = local_slot();
+        if (local.depth++ > 0) return;
+        acquire_slot(local).epoch.store(global_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+
+    inline void leave() {
+        ThreadSlot& local = local_slot();
+        if (--local.depth > 0) return;
+        local.slot->epoch.store(IDLE, std::memory_order_release);
+    }
+
+    /**
+     * @brief Writer side: closes the current epoch and returns it.
+     * Objects unpublished before this call may be freed once
+     * safe_epoch() is greater than the returned value.
+     */
+    inline uint64_t advance() {
+        return global_epoch.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Oldest epoch still pinned by a reader (or the current one)
+     */
+    inline uint64_t safe_epoch() const {
+        uint64_t oldest = global_epoch.load(std::memory_order_seq_cst);
+        for (const Slot& slot : slots) {
+            uint64_t e = slot.epoch.load(std::memory_order_seq_cst);
+            if (e != IDLE && e < oldest) oldest = e;
+        }
+        return oldest;
+    }
+};
+
+/**
+ * @brief RAII read-side critical section
+ */
+class EpochGuard {
+public:
+    EpochGuard() { EpochDomain::instance().enter(); }
+    ~EpochGuard() { EpochDomain::instance().leave(); }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+/**
+ * @brief Objects waiting for every reader to leave their epoch.
+ * Owned by one writer (callers serialize access).
+ */
+class RetireList {
+private:
+    struct Retired {
+        uint64_t epoch;
+        std::function<void()> reclaim;
+    };
+
+    std::vector<Retired> pending;
+
+public:
+    ~RetireList() { drain_all(); }
+
+    /**
+     * @brief Call after the object was unpublished
+     */
+    inline void retire(std::function<void()> reclaim) {
+        pending.push_back({EpochDomain::instance().advance(), std::move(reclaim)});
+        collect();
+    }
+
+    /**
+     * @brief Frees every object no reader can still see
+     */
+    inline void collect() {
+        uint64_t safe = EpochDomain::instance().safe_epoch();
+        auto keep = std::partition(pending.begin(), pending.end(), [&](const Retired& r) {
+            return r.epoch >= safe;
+        });
+        for (auto it = keep; it != pending.end(); ++it) it->reclaim();
+        pending.erase(keep, pending.end());
+    }
+
+    /**
+     * @brief Owner is going away: no reader may still reference it
+     */
+    inline void drain_all() {
+        for (auto& r : pending) r.reclaim();
+        pending.clear();
+    }
+
+    inline size_t size() const { return pending.size(); }
+};
+
+} //SnmpServer
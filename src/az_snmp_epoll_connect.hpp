@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cerrno>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "az_snmp_connect.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief Event-driven UDP transport: one epoll loop serves any number of
+ * non-blocking sockets (ports, interfaces).
+ * init_socket() / init_shared_socket() create a loop and return its handle;
+ * add_endpoint() binds more sockets to it. receive_batch(handle) sleeps in
+ * epoll_wait, then drains each ready socket with one recvmmsg. Every packet
+ * remembers its socket, so the response leaves through the port the
+ * request came in on.
+ * interrupt(handle) signals the loop's eventfd: blocked and later receive
+ * calls return at once, whatever the traffic (no reliance on shutdown() of
+ * a UDP socket). Drop-in for ConnectMgr with both listeners.
+ */
+class EpollConnectMgr : public ConnectMgr {
+private:
+    static constexpr uint64_t WAKE_TAG = ~uint64_t{0};
+    static constexpr int MAX_EVENTS = 16;
+
+    struct Loop {
+        int epoll_fd = -1;
+        int wake_fd = -1;
+        std::vector<int> sockets;
+
+        ~Loop() {
+            for (int fd : sockets) close(fd);
+            if (wake_fd >= 0) close(wake_fd);
+            if (epoll_fd >= 0) close(epoll_fd);
+        }
+    };
+
+    std::mutex loops_mutex;
+    std::unordered_map<int, std::unique_ptr<Loop>> loops; // By epoll fd (the handle)
+
+    inline Loop& find_loop(int handle) {
+        auto it = loops.find(handle);
+        if (it == loops.end())
+            throw std::runtime_error("Unknown event loop handle " + std::to_string(handle) + ".");
+        return *it->second;
+    }
+
+    inline int create_loop() {
+        auto loop = std::make_unique<Loop>();
+        loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        loop->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop->epoll_fd < 0 || loop->wake_fd < 0)
+            throw std::runtime_error("Failed to create the event loop.");
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = WAKE_TAG;
+        if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake_fd, &event) < 0)
+            throw std::runtime_error("Failed to register the event loop wake-up.");
+
+        int handle = loop->epoll_fd;
+        std::lock_guard<std::mutex> lock(loops_mutex);
+        loops.emplace(handle, std::move(loop));
+        return handle;
+    }
+
+    inline int create_loop_with(int port, bool reuse_port) {
+        int handle = create_loop();
+        try {
+            add_endpoint(handle, port, "0.0.0.0", reuse_port);
+        } catch (...) {
+            close_socket(handle);
+            throw;
+        }
+        return handle;
+    }
+
+    /**
+     * @brief Waits for readable sockets; false once the loop is interrupted
+     */
+    inline bool wait(int handle, epoll_event* events, int max_events, int& ready) {
+        do {
+            ready = epoll_wait(handle, events, max_events, -1);
+        } while (ready < 0 && errno == EINTR);
+        if (ready < 0) return false;
+
+        for (int i = 0; i < ready; ++i)
+            if (events[i].data.u64 == WAKE_TAG) return false;
+        return true;
+    }
+
+public:
+    /**
+     * @param batch Datagrams per recvmmsg/sendmmsg
+     * @param pool_capacity Packet contexts kept for reuse (in flight at once)
+     */
+    explicit EpollConnectMgr(size_t batch = 32, size_t pool_capacity = PacketPool::DEFAULT_CAPACITY)
+        : ConnectMgr(batch, pool_capacity) {}
+
+    ~EpollConnectMgr() override {
+        std::lock_guard<std::mutex> lock(loops_mutex);
+        loops.clear();
+    }
+
+    /**
+     * @brief New loop with a socket on port (every interface), returns its handle
+     */
+    inline int init_socket(int port) override {
+        return create_loop_with(port, false);
+    }
+
+    /**
+     * @brief New loop with a SO_REUSEPORT socket on port (one per shard)
+     */
+    inline int init_shared_socket(int port) override {
+        return create_loop_with(port, true);
+    }
+
+    /**
+     * @brief Binds one more socket to the loop (e.g. a second port, or one
+     * interface's address). Safe while the loop is being served.
+     * @return The socket (responses to its requests leave through it)
+     */
+    inline int add_endpoint(int handle, int port, const std::string& address = "0.0.0.0", bool reuse_port = false) {
+        in_addr addr{};
+        if (inet_pton(AF_INET, address.c_str(), &addr) != 1)
+            throw std::runtime_error("Invalid IPv4 address '" + address + "'.");
+
+        std::lock_guard<std::mutex> lock(loops_mutex);
+        Loop& loop = find_loop(handle);
+        int sockfd = open_socket(port, reuse_port, addr.s_addr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = static_cast<uint64_t>(sockfd);
+        if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, sockfd, &event) < 0) {
+            close(sockfd);
+            throw std::runtime_error("Failed to register socket on port " + std::to_string(port) + ".");
+        }
+        loop.sockets.push_back(sockfd);
+        return sockfd;
+    }
+
+    /**
+     * @brief Local ports of the loop's sockets, in the order they were added
+     * (port 0 endpoints show the port the kernel picked)
+     */
+    inline std::vector<int> ports(int handle) {
+        std::lock_guard<std::mutex> lock(loops_mutex);
+        std::vector<int> out;
+        for (int fd : find_loop(handle).sockets) {
+            sockaddr_in addr{};
+            socklen_t len = sizeof(addr);
+            getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+            out.push_back(ntohs(addr.sin_port));
+        }
+        return out;
+    }
+
+    /**
+     * @brief Blocks until at least one datagram arrives on any socket of the
+     * loop, then takes up to batch_size from each ready socket. Returns 0
+     * once the loop is interrupted.
+     */
+    inline size_t receive_batch(int handle, SnmpPacketBatch& out) override {
+        epoll_event events[MAX_EVENTS];
+        while (true) {
+            int ready = 0;
+            if (!wait(handle, events, MAX_EVENTS, ready)) return 0;
+
+            size_t count = 0;
+            for (int i = 0; i < ready; ++i) {
+                int fd = static_cast<int>(events[i].data.u64);
+                size_t first = out.size();
+                count += recv_into(fd, out, MSG_DONTWAIT);
+                for (size_t j = first; j < out.size(); ++j) out[j]->socket_fd = fd;
+            }
+            // Readiness can be stale (another thread drained the socket)
+            if (count > 0) return count;
+        }
+    }
+
+    inline PacketPtr receive(int handle) override {
+        epoll_event event;
+        while (true) {
+            int ready = 0;
+            if (!wait(handle, &event, 1, ready)) return nullptr;
+
+            int fd = static_cast<int>(event.data.u64);
+            PacketPtr context = pool.acquire();
+            socklen_t addr_len = sizeof(context->client_addr);
+            ssize_t bytes_received = recvfrom(fd, context->raw_data.data(), context->raw_data.size(), MSG_DONTWAIT,
+                                              (struct sockaddr *)&context->client_addr, &addr_len);
+            if (bytes_received > 0) {
+                context->raw_data.resize(bytes_received);
+                context->socket_fd = fd;
+                return context;
+            }
+        }
+    }
+
+    /**
+     * @brief sendto on a non-blocking socket: waits briefly for room when
+     * the send buffer is full, then drops the datagram
+     */
+    inline void send(int sock_fd, std::span<const uint8_t> data, const sockaddr_in& addr) override {
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            if (sendto(sock_fd, data.data(), data.size(), 0, (const struct sockaddr *)&addr, sizeof(addr)) >= 0)
+                return;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) break;
+            pollfd writable{sock_fd, POLLOUT, 0};
+            poll(&writable, 1, SEND_WAIT_MS);
+        }
+        stat_count(StatCounter::SEND_ERRORS);
+    }
+
+    /**
+     * @brief Wakes every thread blocked on the loop; all later receive
+     * calls return at once too
+     */
+    inline void interrupt(int handle) override {
+        std::lock_guard<std::mutex> lock(loops_mutex);
+        uint64_t one = 1;
+        if (write(find_loop(handle).wake_fd, &one, sizeof(one)) < 0)
+            throw std::runtime_error("Failed to wake the event loop.");
+    }
+
+    /**
+     * @brief Closes the loop and all its sockets
+     */
+    inline void close_socket(int handle) override {
+        std::unique_ptr<Loop> loop;
+        {
+            std::lock_guard<std::mutex> lock(loops_mutex);
+            auto it = loops.find(handle);
+            if (it == loops.end()) return;
+            loop = std::move(it->second);
+            loops.erase(it);
+        }
+    }
+};
+
+} //SnmpServer
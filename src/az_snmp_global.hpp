@@ -7,18 +7,44 @@
 #include <variant>
 #include <cstdint>
 #include <optional>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <span>
+#include <algorithm>
+#include <chrono>
+
+#include "az_snmp_oid.hpp"
 
 namespace SnmpServer {
 
 // Forward declaration
 struct SnmpValue;
 
-using OID = std::vector<uint32_t>;
+/**
+ * @brief Object identifier (inline storage, see SnmpOid)
+ */
+using OID = SnmpOid;
+
+/**
+ * @brief Three-way OID comparison in SNMP order (sub-identifier by
+ * sub-identifier, a prefix sorts before its children).
+ */
+inline int oid_compare(const OID& a, const OID& b) {
+    return a.compare(b);
+}
+
+/**
+ * @brief True when oid lies under prefix (or equals it)
+ */
+inline bool oid_has_prefix(const OID& oid, const OID& prefix) {
+    return oid.has_prefix(prefix);
+}
 
 /**
  * @brief SEQUENCE representation (list od values)
  */
-using SnmpSequence = std::vector<SnmpValue>;
+using SnmpSequence = std::pmr::vector<SnmpValue>;
 
 using ErrorCode = uint8_t;
 
@@ -28,18 +54,61 @@ using ErrorCode = uint8_t;
 using SnmpVariant = std::variant<
     std::monostate,   // NULL
     int64_t,          // INTEGER
-    std::string,      // OCTET STRING
+    std::pmr::string, // OCTET STRING
     OID,              // OBJECT IDENTIFIER
     SnmpSequence,     // SEQUENCE
     ErrorCode         // ERROR TAG
 >;
 
+struct SnmpPacketContext;
+
+/**
+ * @brief Owner of recycled packet contexts (see PacketPool)
+ */
+class PacketPoolIntf {
+public:
+    virtual ~PacketPoolIntf() = default;
+    virtual void release(SnmpPacketContext* context) = 0;
+};
+
 /**
  * @brief SNMP Request Context (Data exchanged between threads)
  */
 struct SnmpPacketContext {
     std::vector<uint8_t> raw_data;
     sockaddr_in client_addr;
+    PacketPoolIntf* owner = nullptr; // nullptr: heap allocated
+    std::chrono::steady_clock::time_point received_at{}; // Set only when the request is timed (see AgentStats)
+    int socket_fd = -1; // Socket the datagram came in on (-1: the listener's socket)
+};
+
+/**
+ * @brief Hands a context back to its pool instead of freeing it
+ */
+struct PacketRecycler {
+    inline void operator()(SnmpPacketContext* context) const {
+        if (context->owner) context->owner->release(context);
+        else delete context;
+    }
+};
+
+/**
+ * @brief Exclusive handle on a received packet (recycled on destruction)
+ */
+using PacketPtr = std::unique_ptr<SnmpPacketContext, PacketRecycler>;
+
+/**
+ * @brief Packets received together by one batched receive
+ */
+using SnmpPacketBatch = std::vector<PacketPtr>;
+
+/**
+ * @brief Outgoing datagram (view of an encoded response)
+ */
+struct SnmpOutPacket {
+    std::span<const uint8_t> data;
+    sockaddr_in addr;
+    int socket_fd = -1; // -1: the socket passed to send_batch
 };
 
 enum class DataType {
@@ -48,6 +117,11 @@ enum class DataType {
     VAL_NULL         = 0x05,
     OBJECT_ID        = 0x06,
     SEQUENCE         = 0x30,
+    IP_ADDRESS       = 0x40,
+    COUNTER32        = 0x41,
+    GAUGE32          = 0x42,
+    TIME_TICKS       = 0x43,
+    COUNTER64        = 0x46,
     NO_SUCH_NAME	 = 0x80,
     END_OF_MIB_VIEW	 = 0x82,
     NO_SUCH_OBJECT	 = 0x81,
@@ -55,16 +129,22 @@ enum class DataType {
     GET_NEXT_REQUEST = 0xA1,
     GET_RESPONSE     = 0xA2,
     SET_REQUEST      = 0xA3,
-    TRAP             = 0xA4
+    TRAP             = 0xA4,
+    GET_BULK_REQUEST = 0xA5
 };
 
-std::string DataTypeToString(DataType dt) {
+inline std::string_view DataTypeToString(DataType dt) {
     switch (dt) {
         case DataType::INTEGER:          return "INTEGER";
         case DataType::OCTET_STRING:     return "OCTET_STRING";
         case DataType::VAL_NULL:         return "VAL_NULL";
         case DataType::OBJECT_ID:        return "OBJECT_ID";
         case DataType::SEQUENCE:         return "SEQUENCE";
+        case DataType::IP_ADDRESS:       return "IP_ADDRESS";
+        case DataType::COUNTER32:        return "COUNTER32";
+        case DataType::GAUGE32:          return "GAUGE32";
+        case DataType::TIME_TICKS:       return "TIME_TICKS";
+        case DataType::COUNTER64:        return "COUNTER64";
         case DataType::NO_SUCH_NAME:     return "NO_SUCH_NAME";
         case DataType::END_OF_MIB_VIEW:  return "END_OF_MIB_VIEW";
         case DataType::NO_SUCH_OBJECT:   return "NO_SUCH_OBJECT";
@@ -73,144 +153,248 @@ std::string DataTypeToString(DataType dt) {
         case DataType::GET_RESPONSE:     return "GET_RESPONSE";
         case DataType::SET_REQUEST:      return "SET_REQUEST";
         case DataType::TRAP:             return "TRAP";
+        case DataType::GET_BULK_REQUEST: return "GET_BULK_REQUEST";
         default:                         return "UNKNOWN";
     }
 }
 
 /**
- * @brief SNMP message data encapsulation
+ * @brief Copy of value whose strings/OIDs/sequences allocate from alloc
+ */
+SnmpVariant variant_with_allocator(const SnmpVariant& value, const std::pmr::polymorphic_allocator<>& alloc);
+
+SnmpVariant variant_with_allocator(SnmpVariant&& value, const std::pmr::polymorphic_allocator<>& alloc);
+
+/**
+ * @brief SNMP message data encapsulation.
+ * Allocator-aware: inside a std::pmr container, string and sequence values
+ * allocate from the container's memory resource (the OID is inline).
  */
 typedef struct SnmpValue {
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
     OID oid;
-    uint8_t type;
+    uint8_t type = 0;
     SnmpVariant value;
+
+    SnmpValue() = default;
+    SnmpValue(const SnmpValue&) = default;
+    SnmpValue(SnmpValue&&) = default;
+    SnmpValue& operator=(const SnmpValue&) = default;
+    SnmpValue& operator=(SnmpValue&&) = default;
+
+    SnmpValue(OID oid_, uint8_t type_, SnmpVariant value_)
+        : oid(std::move(oid_)), type(type_), value(std::move(value_)) {}
+
+    explicit SnmpValue(const allocator_type&) {}
+
+    SnmpValue(const SnmpValue& other, const allocator_type& alloc)
+        : oid(other.oid), type(other.type), value(variant_with_allocator(other.value, alloc)) {}
+
+    SnmpValue(SnmpValue&& other, const allocator_type& alloc)
+        : oid(std::move(other.oid)), type(other.type), value(variant_with_allocator(std::move(other.value), alloc)) {}
 } SnmpValue;
 
+inline SnmpVariant variant_with_allocator(const SnmpVariant& value, const std::pmr::polymorphic_allocator<>& alloc) {
+    return std::visit([&](const auto& arg) -> SnmpVariant {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, std::pmr::string> || std::is_same_v<T, SnmpSequence>) {
+            return SnmpVariant(std::in_place_type<T>, arg, alloc);
+        } else {
+            return arg;
+        }
+    }, value);
+}
+
+inline SnmpVariant variant_with_allocator(SnmpVariant&& value, const std::pmr::polymorphic_allocator<>& alloc) {
+    return std::visit([&](auto&& arg) -> SnmpVariant {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, std::pmr::string> || std::is_same_v<T, SnmpSequence>) {
+            // Moves when the resources match, copies otherwise
+            return SnmpVariant(std::in_place_type<T>, std::move(arg), alloc);
+        } else {
+            return std::move(arg);
+        }
+    }, std::move(value));
+}
+
+/**
+ * @brief Decoded request. Allocator-aware: constructed with an arena
+ * allocator, the community, command and varbinds (OIDs and string values
+ * included) are all carved out of that arena.
+ */
 typedef struct SnmpPdu {
-    uint32_t version;
-    std::string community;
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    uint32_t version = 0;
+    std::pmr::string community;
+
+    std::pmr::string command;
+    uint32_t req_id = 0;
+
+    uint32_t err_status = 0;
+    uint32_t err_idx = 0;
 
-    std::string command;
-    uint32_t req_id;
+    std::pmr::vector<SnmpValue> vars;
 
-    uint32_t err_status;
-    uint32_t err_idx;
+    // Encoded VarBindList content of a decoded request (points into the
+    // receive buffer; empty for PDUs built in code)
+    std::span<const uint8_t> raw_vars;
 
-    std::vector<SnmpValue> vars;
+    SnmpPdu() = default;
+    explicit SnmpPdu(const allocator_type& alloc) : community(alloc), command(alloc), vars(alloc) {}
 } SnmpPdu;
 
+/**
+ * @brief generic-trap values of the SNMPv1 Trap-PDU (RFC 1157 4.1.6)
+ */
+enum class GenericTrap : uint32_t {
+    COLD_START             = 0,
+    WARM_START             = 1,
+    LINK_DOWN              = 2,
+    LINK_UP                = 3,
+    AUTHENTICATION_FAILURE = 4,
+    EGP_NEIGHBOR_LOSS      = 5,
+    ENTERPRISE_SPECIFIC    = 6
+};
+
+/**
+ * @brief SNMPv1 trap (see TrapSender)
+ */
+struct SnmpTrap {
+    OID enterprise;
+    in_addr_t agent_addr = 0; // Network order
+    GenericTrap generic_trap = GenericTrap::ENTERPRISE_SPECIFIC;
+    uint32_t specific_trap = 0;
+    uint32_t time_stamp = 0;  // sysUpTime when it happened, hundredths of a second
+    std::vector<SnmpValue> varbinds;
+};
+
 /**
  * @brief Prints the contents of any byte container (vector or array) in hexadecimal format.
+ * The print helpers below format into any std::ostream (trace records included);
+ * the overloads without a stream write to std::cout.
+ * @param os Destination stream.
  * @param buffer The byte container (vector or array).
  * @param separator The separator to be used between the bytes (e.g., " " or "").
  */
 template <typename Container>
-inline void print_hex_buffer(const Container& buffer, const std::string& message = " ", const std::string& separator = " ") {
+inline void print_hex_buffer(std::ostream& os, const Container& buffer, const std::string& message = " ", const std::string& separator = " ") {
     std::ios state(nullptr);
-    state.copyfmt(std::cout);
+    state.copyfmt(os);
 
-    std::cout << message << "Buffer Hex [" << buffer.size() << " bytes]: ";
+    os << message << "Buffer Hex [" << buffer.size() << " bytes]: ";
 
-    std::cout << std::hex << std::uppercase << std::setfill('0');
+    os << std::hex << std::uppercase << std::setfill('0');
 
     for (const auto& byte : buffer) {
-        std::cout << std::setw(2) << static_cast<int>(byte) << separator;
+        os << std::setw(2) << static_cast<int>(byte) << separator;
     }
 
-    std::cout << "\n";
+    os << "\n";
 
-    std::cout.copyfmt(state);
+    os.copyfmt(state);
 }
 
-inline void printOid(const OID& oid, std::string msg = "", bool lineBreak = false) {
-    std::cout << msg;
-    std::cout << "{";
+inline void printOid(std::ostream& os, const OID& oid, std::string msg = "", bool lineBreak = false) {
+    os << msg;
+    os << "{";
     for (size_t i = 0; i < oid.size(); ++i) {
-        std::cout << oid[i];
-        if (i + 1 < oid.size()) std::cout << ".";
+        os << oid[i];
+        if (i + 1 < oid.size()) os << ".";
     }
-    std::cout << "}";
+    os << "}";
 
     if(lineBreak)
-        std::cout << "\n";
+        os << "\n";
 }
 
-inline void printVariant(const SnmpVariant& var, std::string msg = "", bool lineBreak = false) {
+inline void printVariant(std::ostream& os, const SnmpVariant& var, std::string msg = "", bool lineBreak = false) {
 
-    std::cout << msg;
+    os << msg;
 
     std::visit([&](auto&& arg) {
         using T = std::decay_t<decltype(arg)>;
         if constexpr (std::is_same_v<T, std::monostate>) {
-            std::cout << "null(NULL)";
+            os << "null(NULL)";
         } else if constexpr (std::is_same_v<T, int64_t>) {
-            std::cout << arg << "(INTEGER)";
-        } else if constexpr (std::is_same_v<T, std::string>) {
-            std::cout << "\"" << arg << "\"" << "(OCTET STRING)";
+            os << arg << "(INTEGER)";
+        } else if constexpr (std::is_same_v<T, std::pmr::string>) {
+            os << "\"" << arg << "\"" << "(OCTET STRING)";
         } else if constexpr (std::is_same_v<T, OID>) {
-            printOid(arg);
-            std::cout << "(OBJECT ID)";
+            printOid(os, arg);
+            os << "(OBJECT ID)";
         } else if constexpr (std::is_same_v<T, SnmpSequence>) {
-            std::cout << "SEQUENCE [\n";
+            os << "SEQUENCE [\n";
             for (const auto& v : arg) {
-                printOid(v.oid);
-                std::cout << "(OID)";
-                std::cout << " type=0x" << std::hex << static_cast<int>(v.type) << std::dec << " value=";
-                printVariant(v.value);
-                std::cout << "\n";
+                printOid(os, v.oid);
+                os << "(OID)";
+                os << " type=0x" << std::hex << static_cast<int>(v.type) << std::dec << " value=";
+                printVariant(os, v.value);
+                os << "\n";
             }
-            std::cout << "]";
+            os << "]";
         }
     }, var);
 
     if(lineBreak)
-        std::cout << "\n";
+        os << "\n";
 }
 
-inline void printSnmpPdu(const SnmpPdu& pdu) {
-    std::cout << "SNMP PDU:\n";
-    std::cout << "  Version: " << pdu.version << "\n";
-    std::cout << "  Community: " << pdu.community << "\n";
-    std::cout << "  Command: " << pdu.command << "\n";
-    std::cout << "  Request ID: " << pdu.req_id << "\n";
-    std::cout << "  Error Status: " << pdu.err_status << "\n";
-    std::cout << "  Error Index: " << pdu.err_idx << "\n";
-
-    std::cout << "  Variables:\n";
+inline void printSnmpPdu(std::ostream& os, const SnmpPdu& pdu) {
+    os << "SNMP PDU:\n";
+    os << "  Version: " << pdu.version << "\n";
+    os << "  Community: " << pdu.community << "\n";
+    os << "  Command: " << pdu.command << "\n";
+    os << "  Request ID: " << pdu.req_id << "\n";
+    os << "  Error Status: " << pdu.err_status << "\n";
+    os << "  Error Index: " << pdu.err_idx << "\n";
+
+    os << "  Variables:\n";
     for (const auto& var : pdu.vars) {
-        std::cout << "    OID=";
-        printOid(var.oid);
-        std::cout << " type=0x" << std::hex << static_cast<int>(var.type) << std::dec << " value=";
-        printVariant(var.value);
-        std::cout << "\n";
+        os << "    OID=";
+        printOid(os, var.oid);
+        os << " type=0x" << std::hex << static_cast<int>(var.type) << std::dec << " value=";
+        printVariant(os, var.value);
+        os << "\n";
     }
 }
 
-inline void printTlv(const std::tuple<std::optional<DataType>, uint8_t, SnmpVariant>& tlv,
-                std::string msg = "", bool lineBreak = false) {
-    const auto& [typeOpt, len, value] = tlv;
+inline void printTlv(std::ostream& os, uint8_t tag, size_t len, std::string msg = "", bool lineBreak = false) {
+    os << msg;
 
-    std::cout << msg;
-
-    std::cout << "TLV:";
+    os << "TLV:";
 
     // Tipo
-    if (typeOpt) {
-        std::cout << " Type: 0x" << std::hex << static_cast<int>(*typeOpt)
-                << std::dec << "(" << DataTypeToString(*typeOpt) << ")";
-    } else {
-        std::cout << " Type: INVALID/NULL";
-    }
+    os << " Type: 0x" << std::hex << static_cast<int>(tag)
+            << std::dec << "(" << DataTypeToString(static_cast<DataType>(tag)) << ")";
 
     // Tamanho
-    std::cout << " Length: " << static_cast<int>(len);
-
-    // Valor
-    std::cout << " Value: ";
-    printVariant(value);
+    os << " Length: " << len;
 
     if(lineBreak)
-        std::cout << "\n";
+        os << "\n";
+}
+
+template <typename Container>
+inline void print_hex_buffer(const Container& buffer, const std::string& message = " ", const std::string& separator = " ") {
+    print_hex_buffer(std::cout, buffer, message, separator);
+}
+
+inline void printOid(const OID& oid, std::string msg = "", bool lineBreak = false) {
+    printOid(std::cout, oid, msg, lineBreak);
+}
+
+inline void printVariant(const SnmpVariant& var, std::string msg = "", bool lineBreak = false) {
+    printVariant(std::cout, var, msg, lineBreak);
+}
+
+inline void printSnmpPdu(const SnmpPdu& pdu) {
+    printSnmpPdu(std::cout, pdu);
+}
+
+inline void printTlv(uint8_t tag, size_t len, std::string msg = "", bool lineBreak = false) {
+    printTlv(std::cout, tag, len, msg, lineBreak);
 }
 
 } //SnmpServer
\ No newline at end of file
@@ -1,9 +1,25 @@
 #pragma once
 
+#include <span>
+#include <memory>
+#include <functional>
+#include <tuple>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include "../src/az_snmp_global.hpp"
 
 namespace SnmpServer {
 
+/**
+ * @brief One MIB object
+ */
+struct MibEntry {
+    OID oid;
+    SnmpVariant value;
+};
+
 /**
  * @brief Interface for MIB (Management Information Base) access.
  * Allows swapping between in-memory, SQLite, or other storage.
@@ -16,6 +32,45 @@ public:
     virtual std::tuple<OID, SnmpVariant> read_next(const OID& oid) = 0;
     virtual void update(const OID& oid, const SnmpVariant& value) = 0;
     virtual void delete_oid(const OID& oid) = 0;
+
+    /**
+     * @brief Visits the objects strictly after start, in OID order, until
+     * visit returns false or the MIB ends. Stores override this to scan
+     * forward from one lookup instead of one read_next per object.
+     */
+    virtual void walk(const OID& start, const std::function<bool(const OID&, const SnmpVariant&)>& visit) {
+        OID cursor = start;
+        while (true) {
+            auto [next, value] = read_next(cursor);
+            if (std::holds_alternative<ErrorCode>(value) && oid_compare(next, cursor) <= 0)
+                return; // End of MIB
+            if (!visit(next, value))
+                return;
+            cursor = std::move(next);
+        }
+    }
+
+    /**
+     * @brief Passes the encoded VarBind answering a GET on oid to emit, for
+     * stores that keep answers pre-encoded (see CachedMib). Returns false
+     * when there is none: the caller reads and encodes the value itself.
+     */
+    virtual bool read_encoded([[maybe_unused]] const OID& oid,
+                              [[maybe_unused]] const std::function<void(std::span<const uint8_t>)>& emit) {
+        return false;
+    }
+
+    /**
+     * @brief Creates or updates every object of upserts, then deletes every
+     * OID of deletes. Both spans are sorted by OID, without duplicates.
+     * Stores override this to merge the batch in one pass, and concurrent
+     * ones to publish it at once (readers see all of it or none of it).
+     * The default applies the objects one by one.
+     */
+    virtual void apply_batch(std::span<const MibEntry> upserts, std::span<const OID> deletes = {}) {
+        for (const MibEntry& entry : upserts) update(entry.oid, entry.value);
+        for (const OID& oid : deletes) delete_oid(oid);
+    }
 };
 
 /**
@@ -26,10 +81,58 @@ class ConnectIntf {
 public:
     virtual ~ConnectIntf() = default;
     virtual int init_socket(int port) = 0;
-    virtual void send(int sockfd, const std::vector<uint8_t>& data, const sockaddr_in& addr) = 0;
-    virtual std::unique_ptr<SnmpPacketContext> receive(int sockfd) = 0;
+
+    /**
+     * @brief Socket that shares its port with other sockets (SO_REUSEPORT),
+     * the kernel spreading datagrams between them.
+     */
+    virtual int init_shared_socket(int port) {
+        throw std::runtime_error("Transport does not support shared sockets (port " + std::to_string(port) + ").");
+    }
+    virtual void send(int sockfd, std::span<const uint8_t> data, const sockaddr_in& addr) = 0;
+    virtual PacketPtr receive(int sockfd) = 0;
+
+    /**
+     * @brief Receives one or more packets (blocking until at least one).
+     * Appends them to out and returns how many were added.
+     */
+    virtual size_t receive_batch(int sockfd, SnmpPacketBatch& out) {
+        auto context = receive(sockfd);
+        if (!context) return 0;
+        out.push_back(std::move(context));
+        return 1;
+    }
+
+    /**
+     * @brief Sends several responses at once (each through its packet's
+     * socket when set)
+     */
+    virtual void send_batch(int sockfd, std::span<const SnmpOutPacket> packets) {
+        for (const auto& packet : packets)
+            send(packet.socket_fd >= 0 ? packet.socket_fd : sockfd, packet.data, packet.addr);
+    }
+
+    /**
+     * @brief Makes receive calls blocked on sockfd return, now and from
+     * then on (used to stop listeners)
+     */
+    virtual void interrupt(int sockfd) {
+        shutdown(sockfd, SHUT_RDWR);
+    }
+
+    /**
+     * @brief Releases what init_socket / init_shared_socket returned
+     */
+    virtual void close_socket(int sockfd) {
+        close(sockfd);
+    }
 };
 
+/**
+ * @brief Unit of work for the pool (move-only: may own a PacketPtr)
+ */
+using SnmpTask = std::move_only_function<void()>;
+
 /**
  * @brief Interface for the Thread Pool system.
  */
@@ -37,7 +140,7 @@ class ThreadPollIntf {
 public:
     virtual ~ThreadPollIntf() = default;
     // Receives the task (lambda function) to be executed by a worker.
-    virtual void enqueue(std::function<void()> task) = 0;
+    virtual void enqueue(SnmpTask task) = 0;
 };
 
 } //SnmpServer
\ No newline at end of file
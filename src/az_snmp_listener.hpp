@@ -1,7 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <thread>
+
 #include "az_snmp_global.hpp"
 #include "az_snmp_worker_task.hpp"
+#include "az_snmp_async.hpp"
 
 namespace SnmpServer {
 
@@ -13,43 +17,123 @@ private:
     ConnectIntf* connectMgr;
     ThreadPollIntf* threadPoll;
     MibIntf* mibMgr;
+    RequestCoalescer* coalescer;
+    AsyncMibIntf* asyncMib = nullptr; // Set: requests served by AsyncWorkerTask
 
     std::thread listener_thread;
     int listener_socket_fd = -1;
-    bool running = true;
+    std::atomic<bool> running{true};
+
+    /**
+     * @brief Hand-off time of a timed task (RECEIVE stage ends here)
+     */
+    static inline StatClock::time_point handed_off(StatClock::time_point received_at) {
+        stat_count(StatCounter::TASKS_QUEUED);
+        if (received_at == StatClock::time_point{}) return {};
+        stat_record(StatStage::RECEIVE, received_at);
+        return StatClock::now();
+    }
+
+    static inline void started(StatClock::time_point queued_at) {
+        stat_count(StatCounter::TASKS_STARTED);
+        stat_record(StatStage::QUEUE_WAIT, queued_at);
+    }
+
+    inline void dispatch(PacketPtr context) {
+        StatClock::time_point queued_at = handed_off(context->received_at);
+        if (asyncMib) {
+            // The pool also runs the requests resumed after a pending read
+            threadPoll->enqueue([
+                context = std::move(context),
+                mib_service = asyncMib,
+                connect_service = connectMgr,
+                socket_fd = listener_socket_fd,
+                executor = threadPoll,
+                queued_at
+            ]() mutable {
+                started(queued_at);
+                AsyncWorkerTask(std::move(context), mib_service, connect_service, socket_fd, executor);
+            });
+            return;
+        }
+        // Dependencies are captured by value (pointers to interfaces) or by move (context)
+        threadPoll->enqueue([
+            context = std::move(context),
+            mib_service = mibMgr,
+            connect_service = connectMgr,
+            socket_fd = listener_socket_fd,
+            coalesce = coalescer,
+            queued_at
+        ]() mutable {
+            started(queued_at);
+            // 3. Call the worker logic
+            WorkerTask(
+                std::move(context),
+                mib_service,
+                connect_service,
+                socket_fd,
+                coalesce
+            );
+        });
+    }
+
+    inline void dispatch(SnmpPacketBatch batch) {
+        auto timed = std::find_if(batch.begin(), batch.end(), [](const PacketPtr& context) { return is_timed(*context); });
+        StatClock::time_point queued_at = handed_off(timed != batch.end() ? (*timed)->received_at : StatClock::time_point{});
+        // The whole batch goes to one worker, which answers with one send_batch
+        threadPoll->enqueue([
+            batch = std::move(batch),
+            mib_service = mibMgr,
+            connect_service = connectMgr,
+            socket_fd = listener_socket_fd,
+            coalesce = coalescer,
+            queued_at
+        ]() mutable {
+            started(queued_at);
+            WorkerBatchTask(
+                std::move(batch),
+                mib_service,
+                connect_service,
+                socket_fd,
+                coalesce
+            );
+        });
+    }
 
     inline void run_loop() {
+        SnmpPacketBatch batch;
         while (running) {
-            // 1. Receive packet (blocking call)
-            std::shared_ptr<SnmpPacketContext> context = connectMgr->receive(listener_socket_fd);
+            // 1. Receive one or more packets (blocking call)
+            batch.clear();
+            size_t received = connectMgr->receive_batch(listener_socket_fd, batch);
 
             if (!running) break;
+            mark_received(batch);
 
-            if (context) {
-                // 2. Dispatch task to the thread pool (Producer-Consumer)
-                // Dependencies are captured by value (pointers to interfaces) or by move (context)
-                threadPoll->enqueue([
-                    context,
-                    mib_service = mibMgr,
-                    connect_service = connectMgr,
-                    socket_fd = listener_socket_fd
-                ] {
-                    // 3. Call the worker logic
-                    WorkerTask(
-                        context,
-                        mib_service,
-                        connect_service,
-                        socket_fd
-                    );
-                });
+            // 2. Dispatch task to the thread pool (Producer-Consumer)
+            if (received > 1 && !asyncMib) {
+                dispatch(std::move(batch));
+            } else {
+                // Async requests are tasks of their own: each may suspend
+                for (auto& context : batch)
+                    dispatch(std::move(context));
             }
         }
     }
 
 public:
-    // Dependencies are injected via the constructor
-    SnmpListener(ConnectIntf* conn, ThreadPollIntf* pool, MibIntf* mib)
-        : connectMgr(conn), threadPoll(pool), mibMgr(mib) {}
+    // Dependencies are injected via the constructor (coalescer is optional)
+    SnmpListener(ConnectIntf* conn, ThreadPollIntf* pool, MibIntf* mib, RequestCoalescer* coalesce = nullptr)
+        : connectMgr(conn), threadPoll(pool), mibMgr(mib), coalescer(coalesce) {}
+
+    // Requests that wait on a slow read free their pool thread (see AsyncWorkerTask)
+    SnmpListener(ConnectIntf* conn, ThreadPollIntf* pool, AsyncMibIntf* mib)
+        : connectMgr(conn), threadPoll(pool), mibMgr(mib), coalescer(nullptr), asyncMib(mib) {}
+
+    /**
+     * @brief Socket (or transport handle, see EpollConnectMgr) being served, -1 before start()
+     */
+    inline int socket_fd() const { return listener_socket_fd; }
 
     inline void start(int port) {
         listener_socket_fd = connectMgr->init_socket(port);
@@ -59,12 +143,12 @@ public:
     inline void stop() {
         if (running) {
             running = false;
-            // Force recvfrom() to unblock and terminate the loop
-            shutdown(listener_socket_fd, SHUT_RDWR);
+            // Force the blocked receive to return and terminate the loop
+            connectMgr->interrupt(listener_socket_fd);
             if (listener_thread.joinable()) {
                 listener_thread.join();
             }
-            close(listener_socket_fd);
+            connectMgr->close_socket(listener_socket_fd);
         }
     }
 };
@@ -0,0 +1,497 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "az_snmp_connect.hpp"
+#include "az_snmp_prot_handler.hpp"
+#include "az_snmp_trace.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief Outcome of a manager request
+ */
+enum class PollStatus {
+    OK,       // Response received (pdu.err_status may still report an agent error)
+    TIMEOUT,  // No response after the last retry
+    CANCELLED // Manager stopped with the request in flight
+};
+
+/**
+ * @brief What a request's callback receives
+ */
+struct PollResult {
+    PollStatus status = PollStatus::TIMEOUT;
+    SnmpPdu pdu;                      // Decoded response (OK only)
+    sockaddr_in target{};
+    unsigned attempts = 0;            // Datagrams sent (1 + retries used)
+    std::chrono::microseconds rtt{0}; // From the last send to the response
+};
+
+/**
+ * @brief Runs on the manager's I/O thread: keep it short (hand heavy work
+ * to a pool). It may issue new requests.
+ */
+using PollCallback = std::function<void(PollResult&)>;
+
+struct SnmpManagerOptions {
+    std::string community = "public";       // Unless the request's PDU has one
+    uint32_t version = 1;                   // 0: SNMPv1, 1: SNMPv2c
+    std::chrono::milliseconds timeout{1000}; // Per attempt
+    unsigned retries = 2;
+    size_t sockets = 1;                     // Requests are spread over them round robin
+    size_t batch = 32;                      // Datagrams per sendmmsg/recvmmsg
+    size_t max_in_flight = 1024;            // Later requests wait for a free slot
+    std::chrono::milliseconds tick{10};     // Timer wheel resolution
+    size_t wheel_slots = 1024;              // One turn: wheel_slots * tick
+};
+
+/**
+ * @brief Hashed timer wheel of request ids. An id sits in the slot of its
+ * deadline tick; ids more than one turn away are met again on later turns
+ * and kept until due (the owner checks the deadline on expiry).
+ */
+class TimerWheel {
+private:
+    std::vector<std::vector<uint32_t>> slots;
+    size_t mask;
+    uint64_t current = 0; // Next tick to expire
+
+public:
+    explicit TimerWheel(size_t slot_count = 1024)
+        : slots(std::bit_ceil(std::max<size_t>(slot_count, 2))), mask(slots.size() - 1) {}
+
+    inline void schedule(uint32_t id, uint64_t tick) {
+        slots[std::max(tick, current) & mask].push_back(id);
+    }
+
+    /**
+     * @brief Visits the slots of every tick up to now. expire(id) returns
+     * false to keep an id that is not due yet; it may schedule ids again.
+     */
+    template <typename Expire>
+    inline void advance(uint64_t now, Expire&& expire) {
+        uint64_t end = now + 1;
+        // A late call visits each slot once
+        if (end > current + slots.size()) current = end - slots.size();
+        for (; current < end; ++current) {
+            std::vector<uint32_t>& slot = slots[current & mask];
+            for (size_t i = 0; i < slot.size();) {
+                if (expire(slot[i])) {
+                    slot[i] = slot.back();
+                    slot.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+        }
+    }
+};
+
+/**
+ * @brief Asynchronous SNMP manager (poller side). One I/O thread multiplexes
+ * any number of outstanding requests over a few non-blocking UDP sockets:
+ * requests are encoded and responses decoded by SnmpProtocolHandler,
+ * responses matched by req_id (and source address) in a hash table,
+ * timeouts and retries driven by a timer wheel, and datagrams moved with
+ * sendmmsg/recvmmsg (ConnectMgr). At most max_in_flight requests are on
+ * the wire, the others wait in submission order. Results are delivered to
+ * callbacks on the I/O thread. Request functions are thread-safe.
+ */
+class SnmpManager {
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint64_t WAKE_TAG = ~uint64_t{0};
+    static constexpr int MAX_EVENTS = 16;
+    static constexpr int RECEIVE_BUFFER = 4 << 20; // Bursts of answers from thousands of agents
+
+    struct Submission {
+        sockaddr_in target;
+        DataType command;
+        SnmpPdu pdu;
+        PollCallback callback;
+    };
+
+    struct Pending {
+        sockaddr_in target;
+        std::vector<uint8_t> packet; // Encoded once, resent as is on retries
+        PollCallback callback;
+        int socket_fd = -1;
+        unsigned attempts = 0;
+        uint64_t deadline = 0; // Tick
+        Clock::time_point sent_at;
+    };
+
+    SnmpManagerOptions options;
+    SnmpProtocolHandler protocol{nullptr};
+    ConnectMgr transport;
+    std::vector<int> sockets;
+    int epoll_fd = -1;
+    int wake_fd = -1;
+
+    std::mutex submit_mutex;
+    std::vector<Submission> submitted;
+    bool accepting = true; // Cleared (under submit_mutex) once the I/O thread winds down
+
+    // I/O thread only
+    std::deque<Submission> waiting; // Over the in-flight limit
+    std::unordered_map<uint32_t, Pending> pending;
+    TimerWheel wheel;
+    BerWriter writer;
+    std::vector<SnmpOutPacket> outgoing;
+    uint32_t next_req_id;
+    size_t next_socket = 0;
+    const Clock::time_point epoch = Clock::now();
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> response_count{0};
+    std::atomic<uint64_t> timeout_count{0};
+    std::atomic<uint64_t> retry_count{0};
+    std::atomic<uint64_t> unmatched_count{0};
+    std::thread io_thread;
+
+    inline uint64_t now_tick() const {
+        return static_cast<uint64_t>((Clock::now() - epoch) / options.tick);
+    }
+
+    inline uint64_t deadline_tick() const {
+        uint64_t ticks = (options.timeout + options.tick - std::chrono::milliseconds(1)) / options.tick;
+        return now_tick() + std::max<uint64_t>(ticks, 1);
+    }
+
+    inline void open_sockets() {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll_fd < 0 || wake_fd < 0)
+            throw std::runtime_error("Failed to create the manager event loop.");
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = WAKE_TAG;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+        for (size_t i = 0; i < std::max<size_t>(options.sockets, 1); ++i) {
+            int sockfd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (sockfd < 0) throw std::runtime_error("Failed to create socket.");
+            sockets.push_back(sockfd);
+
+            int size = RECEIVE_BUFFER;
+            setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)); // Best effort
+
+            // Ephemeral port on every interface
+            sockaddr_in local{};
+            local.sin_family = AF_INET;
+            local.sin_addr.s_addr = INADDR_ANY;
+            event.data.u64 = static_cast<uint64_t>(sockfd);
+            if (bind(sockfd, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) < 0 ||
+                epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sockfd, &event) < 0)
+                throw std::runtime_error("Failed to set up a manager socket.");
+        }
+    }
+
+    inline void close_sockets() {
+        for (int fd : sockets) close(fd);
+        if (wake_fd >= 0) close(wake_fd);
+        if (epoll_fd >= 0) close(epoll_fd);
+    }
+
+    inline void wake() {
+        uint64_t one = 1;
+        if (write(wake_fd, &one, sizeof(one)) < 0)
+            AZ_SNMP_LOG(WARN, "[Manager] failed to wake the I/O thread");
+    }
+
+    inline uint32_t allocate_req_id() {
+        // Positive Integer32, never one still waiting for its answer
+        do {
+            next_req_id = (next_req_id + 1) & 0x7FFFFFFF;
+        } while (next_req_id == 0 || pending.contains(next_req_id));
+        return next_req_id;
+    }
+
+    inline void queue_send(Pending& request) {
+        request.attempts++;
+        request.sent_at = Clock::now();
+        request.deadline = deadline_tick();
+        outgoing.push_back({request.packet, request.target, request.socket_fd});
+    }
+
+    inline void flush() {
+        if (outgoing.empty()) return;
+        transport.send_batch(sockets[0], outgoing);
+        outgoing.clear();
+    }
+
+    /**
+     * @brief Encodes waiting requests and queues their first send, as long
+     * as the in-flight limit allows
+     */
+    inline void start_waiting() {
+        while (!waiting.empty() && pending.size() < std::max<size_t>(options.max_in_flight, 1)) {
+            Submission& submission = waiting.front();
+            SnmpPdu& pdu = submission.pdu;
+            pdu.req_id = allocate_req_id();
+            pdu.version = options.version;
+            if (pdu.community.empty()) pdu.community = options.community;
+            std::span<const uint8_t> packet = protocol.build_request(pdu, submission.command, writer);
+
+            Pending& request = pending[pdu.req_id];
+            request.target = submission.target;
+            request.packet.assign(packet.begin(), packet.end());
+            request.callback = std::move(submission.callback);
+            request.socket_fd = sockets[next_socket++ % sockets.size()];
+            queue_send(request);
+            wheel.schedule(pdu.req_id, request.deadline);
+            waiting.pop_front();
+        }
+    }
+
+    inline void complete(std::unordered_map<uint32_t, Pending>::iterator it, PollResult& result) {
+        auto node = pending.extract(it);
+        Pending& request = node.mapped();
+        result.target = request.target;
+        result.attempts = request.attempts;
+        if (request.callback) request.callback(result);
+    }
+
+    inline void handle_response(const SnmpPacketContext& packet) {
+        auto response = protocol.process_response(packet.raw_data);
+        auto it = response ? pending.find(response->req_id) : pending.end();
+        // Late answers (already timed out) and spoofed sources are dropped
+        if (it == pending.end() ||
+            it->second.target.sin_addr.s_addr != packet.client_addr.sin_addr.s_addr ||
+            it->second.target.sin_port != packet.client_addr.sin_port) {
+            unmatched_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        response_count.fetch_add(1, std::memory_order_relaxed);
+        PollResult result;
+        result.status = PollStatus::OK;
+        result.rtt = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - it->second.sent_at);
+        result.pdu = std::move(*response);
+        result.pdu.raw_vars = {}; // Points into the receive buffer, recycled after this
+        complete(it, result);
+    }
+
+    inline void receive(int sockfd) {
+        SnmpPacketBatch batch;
+        while (transport.receive_batch(sockfd, batch) > 0) {
+            for (const PacketPtr& packet : batch) handle_response(*packet);
+            batch.clear();
+        }
+    }
+
+    inline void expire_timers() {
+        uint64_t now = now_tick();
+        wheel.advance(now, [&](uint32_t req_id) {
+            auto it = pending.find(req_id);
+            if (it == pending.end()) return true; // Answered
+            Pending& request = it->second;
+            if (request.deadline > now) return false; // Later turn
+
+            if (request.attempts <= options.retries) {
+                retry_count.fetch_add(1, std::memory_order_relaxed);
+                queue_send(request);
+                wheel.schedule(req_id, request.deadline);
+                return true;
+            }
+
+            timeout_count.fetch_add(1, std::memory_order_relaxed);
+            PollResult result;
+            result.status = PollStatus::TIMEOUT;
+            complete(it, result);
+            return true;
+        });
+    }
+
+    inline void cancel_all() {
+        std::vector<Submission> batch;
+        {
+            std::lock_guard<std::mutex> lock(submit_mutex);
+            accepting = false;
+            batch.swap(submitted);
+        }
+        for (Submission& submission : batch) waiting.push_back(std::move(submission));
+        for (Submission& submission : waiting) {
+            PollResult result;
+            result.status = PollStatus::CANCELLED;
+            result.target = submission.target;
+            if (submission.callback) submission.callback(result);
+        }
+        waiting.clear();
+        while (!pending.empty()) {
+            PollResult result;
+            result.status = PollStatus::CANCELLED;
+            complete(pending.begin(), result);
+        }
+    }
+
+    inline void run() {
+        std::vector<Submission> batch;
+        epoll_event events[MAX_EVENTS];
+        int tick_ms = static_cast<int>(options.tick.count());
+
+        while (running.load(std::memory_order_acquire)) {
+            // Idle: sleep until a request is submitted
+            int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, pending.empty() ? -1 : tick_ms);
+            if (ready < 0 && errno != EINTR) {
+                AZ_SNMP_LOG(ERROR, "[Manager] epoll_wait failed, errno " << errno);
+                break;
+            }
+
+            for (int i = 0; i < ready; ++i) {
+                if (events[i].data.u64 == WAKE_TAG) {
+                    uint64_t count;
+                    if (read(wake_fd, &count, sizeof(count)) < 0) continue;
+                } else {
+                    receive(static_cast<int>(events[i].data.u64));
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(submit_mutex);
+                batch.swap(submitted);
+            }
+            for (Submission& submission : batch) waiting.push_back(std::move(submission));
+            batch.clear();
+            start_waiting();
+            flush();
+
+            // Timeouts free slots too
+            expire_timers();
+            start_waiting();
+            flush();
+        }
+
+        cancel_all();
+    }
+
+public:
+    explicit SnmpManager(SnmpManagerOptions opts = {})
+        : options(std::move(opts)),
+          transport(options.batch, 2 * std::max<size_t>(options.batch, 1)),
+          wheel(options.wheel_slots) {
+        if (options.tick.count() <= 0)
+            throw std::runtime_error("Manager timer tick must be positive.");
+        try {
+            open_sockets();
+        } catch (...) {
+            close_sockets();
+            throw;
+        }
+        next_req_id = std::random_device{}() & 0x7FFFFFFF;
+        io_thread = std::thread(&SnmpManager::run, this);
+    }
+
+    ~SnmpManager() {
+        stop();
+        close_sockets();
+    }
+
+    SnmpManager(const SnmpManager&) = delete;
+    SnmpManager& operator=(const SnmpManager&) = delete;
+
+    /**
+     * @brief IPv4 agent address ("192.0.2.1", port 161 by default)
+     */
+    static inline sockaddr_in make_target(const std::string& address, int port = 161) {
+        sockaddr_in target{};
+        target.sin_family = AF_INET;
+        target.sin_port = htons(port);
+        if (inet_pton(AF_INET, address.c_str(), &target.sin_addr) != 1)
+            throw std::runtime_error("Invalid IPv4 address '" + address + "'.");
+        return target;
+    }
+
+    /**
+     * @brief Sends pdu's varbinds to target as a command request (GET,
+     * GETNEXT, GETBULK or SET). req_id and version are set by the manager,
+     * the community too when pdu has none. callback runs once, on the I/O
+     * thread, with the response, a timeout or a cancellation.
+     * @return false when the manager is stopped (callback not called)
+     */
+    inline bool request(const sockaddr_in& target, DataType command, SnmpPdu pdu, PollCallback callback) {
+        bool first;
+        {
+            std::lock_guard<std::mutex> lock(submit_mutex);
+            if (!accepting) return false;
+            first = submitted.empty();
+            submitted.push_back({target, command, std::move(pdu), std::move(callback)});
+        }
+        // One wake-up per batch of submissions
+        if (first) wake();
+        return true;
+    }
+
+    inline bool get(const sockaddr_in& target, const std::vector<OID>& oids, PollCallback callback) {
+        return request(target, DataType::GET_REQUEST, read_pdu(oids), std::move(callback));
+    }
+
+    inline bool get_next(const sockaddr_in& target, const std::vector<OID>& oids, PollCallback callback) {
+        return request(target, DataType::GET_NEXT_REQUEST, read_pdu(oids), std::move(callback));
+    }
+
+    inline bool get_bulk(const sockaddr_in& target, uint32_t non_repeaters, uint32_t max_repetitions,
+                         const std::vector<OID>& oids, PollCallback callback) {
+        SnmpPdu pdu = read_pdu(oids);
+        pdu.err_status = non_repeaters;
+        pdu.err_idx = max_repetitions;
+        return request(target, DataType::GET_BULK_REQUEST, std::move(pdu), std::move(callback));
+    }
+
+    /**
+     * @brief PDU asking for oids (NULL values)
+     */
+    static inline SnmpPdu read_pdu(const std::vector<OID>& oids) {
+        SnmpPdu pdu;
+        pdu.vars.reserve(oids.size());
+        for (const OID& oid : oids) pdu.vars.push_back({oid, static_cast<uint8_t>(DataType::VAL_NULL), std::monostate{}});
+        return pdu;
+    }
+
+    /**
+     * @brief Stops the I/O thread; requests still in flight complete with
+     * CANCELLED before it returns
+     */
+    inline void stop() {
+        if (!running.exchange(false)) return;
+        wake();
+        if (io_thread.joinable()) io_thread.join();
+    }
+
+    /**
+     * @brief Local ports of the manager's sockets
+     */
+    inline std::vector<int> ports() const {
+        std::vector<int> out;
+        for (int fd : sockets) {
+            sockaddr_in addr{};
+            socklen_t len = sizeof(addr);
+            getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+            out.push_back(ntohs(addr.sin_port));
+        }
+        return out;
+    }
+
+    inline uint64_t responses() const { return response_count.load(std::memory_order_relaxed); }
+    inline uint64_t timeouts() const { return timeout_count.load(std::memory_order_relaxed); }
+    inline uint64_t retries() const { return retry_count.load(std::memory_order_relaxed); }
+    inline uint64_t unmatched() const { return unmatched_count.load(std::memory_order_relaxed); }
+};
+
+} //SnmpServer
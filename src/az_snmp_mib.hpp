@@ -1,81 +1,383 @@
 #pragma once
 
-#include <map>
-#include <sstream>
+#include <vector>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
 
 #include "az_snmp_global.hpp"
 #include "az_snmp_intfs.hpp"
 
 namespace SnmpServer {
 
+//==============================================
+// CHUNKED SORTED ARRAY (shared by the MIB stores)
+//==============================================
+
+/**
+ * @brief Sorted run of at most MIB_LEAF_SIZE entries
+ */
+using MibLeaf = std::vector<MibEntry>;
+
+constexpr size_t MIB_LEAF_SIZE = 128;
+
+inline const MibLeaf& mib_leaf(const MibLeaf& leaf) { return leaf; }
+inline const MibLeaf& mib_leaf(const std::shared_ptr<const MibLeaf>& leaf) { return *leaf; }
+
+inline bool mib_entry_less(const MibEntry& entry, const OID& oid) {
+    return oid_compare(entry.oid, oid) < 0;
+}
+
+inline bool mib_oid_less(const OID& oid, const MibEntry& entry) {
+    return oid_compare(oid, entry.oid) < 0;
+}
+
+/**
+ * @brief First leaf whose last OID is >= oid (leaves.size() if none)
+ */
+template <typename Leaves>
+inline size_t mib_leaf_lower_bound(const Leaves& leaves, const OID& oid) {
+    auto it = std::partition_point(leaves.begin(), leaves.end(), [&](const auto& leaf) {
+        return oid_compare(mib_leaf(leaf).back().oid, oid) < 0;
+    });
+    return static_cast<size_t>(it - leaves.begin());
+}
+
+/**
+ * @brief First leaf whose last OID is > oid (leaves.size() if none)
+ */
+template <typename Leaves>
+inline size_t mib_leaf_upper_bound(const Leaves& leaves, const OID& oid) {
+    auto it = std::partition_point(leaves.begin(), leaves.end(), [&](const auto& leaf) {
+        return oid_compare(mib_leaf(leaf).back().oid, oid) <= 0;
+    });
+    return static_cast<size_t>(it - leaves.begin());
+}
+
+/**
+ * @brief Exact match lookup
+ */
+template <typename Leaves>
+inline const MibEntry* mib_find(const Leaves& leaves, const OID& oid) {
+    size_t idx = mib_leaf_lower_bound(leaves, oid);
+    if (idx == leaves.size()) return nullptr;
+
+    const MibLeaf& leaf = mib_leaf(leaves[idx]);
+    auto it = std::lower_bound(leaf.begin(), leaf.end(), oid, mib_entry_less);
+    if (it != leaf.end() && oid_compare(it->oid, oid) == 0)
+        return &*it;
+    return nullptr;
+}
+
+/**
+ * @brief First object strictly after oid
+ */
+template <typename Leaves>
+inline const MibEntry* mib_find_next(const Leaves& leaves, const OID& oid) {
+    size_t idx = mib_leaf_upper_bound(leaves, oid);
+    if (idx == leaves.size()) return nullptr;
+
+    const MibLeaf& leaf = mib_leaf(leaves[idx]);
+    return &*std::upper_bound(leaf.begin(), leaf.end(), oid, mib_oid_less);
+}
+
+/**
+ * @brief Visits the objects strictly after oid in order (see MibIntf::walk)
+ */
+template <typename Leaves, typename Visit>
+inline void mib_walk(const Leaves& leaves, const OID& oid, Visit&& visit) {
+    size_t idx = mib_leaf_upper_bound(leaves, oid);
+    if (idx == leaves.size()) return;
+
+    const MibLeaf& first = mib_leaf(leaves[idx]);
+    auto it = std::upper_bound(first.begin(), first.end(), oid, mib_oid_less);
+    for (; it != first.end(); ++it)
+        if (!visit(it->oid, it->value)) return;
+
+    for (++idx; idx < leaves.size(); ++idx)
+        for (const MibEntry& entry : mib_leaf(leaves[idx]))
+            if (!visit(entry.oid, entry.value)) return;
+}
+
+/**
+ * @brief Inserts or assigns inside one leaf. Returns true on insertion.
+ * The leaf may grow to MIB_LEAF_SIZE + 1; callers split it afterwards.
+ */
+inline bool mib_leaf_upsert(MibLeaf& leaf, const OID& oid, const SnmpVariant& value) {
+    auto it = std::lower_bound(leaf.begin(), leaf.end(), oid, mib_entry_less);
+    if (it != leaf.end() && oid_compare(it->oid, oid) == 0) {
+        it->value = value;
+        return false;
+    }
+    leaf.insert(it, MibEntry{oid, value});
+    return true;
+}
+
+/**
+ * @brief Removes oid from one leaf. Returns true if it was present.
+ */
+inline bool mib_leaf_erase(MibLeaf& leaf, const OID& oid) {
+    auto it = std::lower_bound(leaf.begin(), leaf.end(), oid, mib_entry_less);
+    if (it == leaf.end() || oid_compare(it->oid, oid) != 0) return false;
+    leaf.erase(it);
+    return true;
+}
+
+/**
+ * @brief Moves the upper half of an oversized leaf into a new leaf.
+ * When the last leaf grew at its end (ordered load) only the new entry
+ * moves, so sequentially created MIBs keep full leaves.
+ */
+inline MibLeaf mib_leaf_split(MibLeaf& leaf, bool appended_at_end) {
+    size_t keep = appended_at_end ? leaf.size() - 1 : leaf.size() / 2;
+    MibLeaf upper;
+    upper.reserve(MIB_LEAF_SIZE + 1);
+    std::move(leaf.begin() + keep, leaf.end(), std::back_inserter(upper));
+    leaf.resize(keep);
+    return upper;
+}
+
+/**
+ * @brief Throws unless both parts of a batch are sorted by OID, without
+ * duplicates (see MibIntf::apply_batch)
+ */
+inline void mib_check_batch(std::span<const MibEntry> upserts, std::span<const OID> deletes) {
+    for (size_t i = 1; i < upserts.size(); ++i)
+        if (oid_compare(upserts[i - 1].oid, upserts[i].oid) >= 0)
+            throw std::invalid_argument("MIB batch objects must be sorted by OID, without duplicates.");
+    for (size_t i = 1; i < deletes.size(); ++i)
+        if (oid_compare(deletes[i - 1], deletes[i]) >= 0)
+            throw std::invalid_argument("MIB batch deletions must be sorted by OID, without duplicates.");
+}
+
+/**
+ * @brief Applies a checked batch to a chunked sorted array in one pass.
+ * The batch is cut at leaf boundaries; every leaf it reaches is merged with
+ * its part and cut again into balanced leaves (make_leaf builds the stored
+ * leaf type). Other leaves are moved as they are, so the cost is linear in
+ * the batch plus the leaves it reaches. Entries of owned leaves (MibLeaf)
+ * are moved, those of shared ones copied.
+ * @return Change in the number of objects
+ */
+template <typename Leaves, typename MakeLeaf>
+inline ptrdiff_t mib_apply_batch(Leaves& leaves, std::span<const MibEntry> upserts, std::span<const OID> deletes,
+                                 MakeLeaf&& make_leaf) {
+    Leaves merged;
+    merged.reserve(leaves.size() + upserts.size() / MIB_LEAF_SIZE + 1);
+    ptrdiff_t delta = 0;
+    size_t u = 0;
+    size_t d = 0;
+    MibLeaf run;
+
+    // Existing entries merged with upserts[u, u_end), minus deletes[d, d_end)
+    auto merge = [&](auto* existing, size_t u_end, size_t d_end) {
+        run.clear();
+        size_t existing_size = existing ? existing->size() : 0;
+        run.reserve(existing_size + (u_end - u));
+        auto deleted = [&](const OID& oid) {
+            while (d < d_end && oid_compare(deletes[d], oid) < 0) ++d;
+            return d < d_end && oid_compare(deletes[d], oid) == 0;
+        };
+
+        size_t e = 0;
+        while (e < existing_size || u < u_end) {
+            int cmp = (u == u_end) ? -1 : (e == existing_size) ? 1 : oid_compare((*existing)[e].oid, upserts[u].oid);
+            if (cmp < 0) {
+                auto& entry = (*existing)[e++];
+                if (deleted(entry.oid)) --delta;
+                else if constexpr (std::is_const_v<std::remove_reference_t<decltype(entry)>>) run.push_back(entry);
+                else run.push_back(std::move(entry));
+                continue;
+            }
+            if (cmp == 0) ++e;
+            const MibEntry& entry = upserts[u++];
+            if (deleted(entry.oid)) {
+                if (cmp == 0) --delta;
+                continue;
+            }
+            if (cmp > 0) ++delta;
+            run.push_back(entry);
+        }
+        d = d_end;
+
+        size_t parts = (run.size() + MIB_LEAF_SIZE - 1) / MIB_LEAF_SIZE;
+        for (size_t part = 0, begin = 0; part < parts; ++part) {
+            size_t end = run.size() * (part + 1) / parts;
+            MibLeaf leaf;
+            leaf.reserve(MIB_LEAF_SIZE + 1);
+            std::move(run.begin() + begin, run.begin() + end, std::back_inserter(leaf));
+            merged.push_back(make_leaf(std::move(leaf)));
+            begin = end;
+        }
+    };
+
+    if (leaves.empty())
+        merge(static_cast<const MibLeaf*>(nullptr), upserts.size(), deletes.size());
+
+    for (size_t idx = 0; idx < leaves.size(); ++idx) {
+        size_t u_end = upserts.size();
+        size_t d_end = deletes.size();
+        if (idx + 1 < leaves.size()) {
+            // Objects up to this leaf's last OID belong to it
+            const OID& last = mib_leaf(leaves[idx]).back().oid;
+            u_end = static_cast<size_t>(std::partition_point(upserts.begin() + u, upserts.end(), [&](const MibEntry& entry) {
+                return oid_compare(entry.oid, last) <= 0;
+            }) - upserts.begin());
+            d_end = static_cast<size_t>(std::partition_point(deletes.begin() + d, deletes.end(), [&](const OID& oid) {
+                return oid_compare(oid, last) <= 0;
+            }) - deletes.begin());
+        }
+        if (u_end == u && d_end == d) {
+            merged.push_back(std::move(leaves[idx]));
+            continue;
+        }
+        if constexpr (std::is_same_v<typename Leaves::value_type, MibLeaf>) merge(&leaves[idx], u_end, d_end);
+        else merge(&mib_leaf(leaves[idx]), u_end, d_end);
+    }
+
+    leaves = std::move(merged);
+    return delta;
+}
+
+/**
+ * @brief Passes a batch on to inner without the objects blocked(oid,
+ * operation) keeps out (read-only ones of a decorator). The spans are
+ * copied only when something is dropped.
+ */
+template <typename Blocked>
+inline void mib_forward_batch(MibIntf* inner, std::span<const MibEntry> upserts, std::span<const OID> deletes,
+                              Blocked&& blocked) {
+    std::vector<MibEntry> kept_upserts;
+    std::vector<OID> kept_deletes;
+    bool upserts_filtered = false;
+    bool deletes_filtered = false;
+
+    for (size_t i = 0; i < upserts.size(); ++i) {
+        if (blocked(upserts[i].oid, "update")) {
+            if (!upserts_filtered) kept_upserts.assign(upserts.begin(), upserts.begin() + i);
+            upserts_filtered = true;
+        } else if (upserts_filtered) {
+            kept_upserts.push_back(upserts[i]);
+        }
+    }
+    for (size_t i = 0; i < deletes.size(); ++i) {
+        if (blocked(deletes[i], "delete")) {
+            if (!deletes_filtered) kept_deletes.assign(deletes.begin(), deletes.begin() + i);
+            deletes_filtered = true;
+        } else if (deletes_filtered) {
+            kept_deletes.push_back(deletes[i]);
+        }
+    }
+
+    inner->apply_batch(upserts_filtered ? std::span<const MibEntry>(kept_upserts) : upserts,
+                       deletes_filtered ? std::span<const OID>(kept_deletes) : deletes);
+}
+
 /**
  * @brief Concrete MIB Manager (In-Memory for simplicity).
  * Inherits from MibIntf.
+ *
+ * Objects are kept in OID order in a chunked sorted array: a vector of
+ * leaves, each a sorted vector of at most MIB_LEAF_SIZE entries. Lookups
+ * are two binary searches on the sub-identifiers (no key formatting, no
+ * allocation) and inserts only shift entries inside one leaf.
+ * Not synchronized: see ConcurrentMibMgr for multi-threaded agents.
  */
 class MibMgr : public MibIntf {
 private:
-    std::map<std::string, SnmpVariant> data;
+    std::vector<MibLeaf> leaves;
+    size_t count = 0;
 
-    std::string oid_to_str(const OID& oid) {
-        std::stringstream ss;
-        for (const auto& num : oid) ss << "." << num;
-        return ss.str();
-    }
+    inline void insert_or_assign(const OID& oid, const SnmpVariant& value) {
+        size_t idx = 0;
+        if (leaves.empty()) {
+            leaves.emplace_back().reserve(MIB_LEAF_SIZE + 1);
+        } else {
+            idx = std::min(mib_leaf_lower_bound(leaves, oid), leaves.size() - 1);
+        }
+        MibLeaf& leaf = leaves[idx];
 
-    OID str_to_oid(const std::string& s) {
-        OID oid;
-        std::stringstream ss(s);
-        std::string token;
+        bool at_end = leaf.empty() || oid_compare(leaf.back().oid, oid) < 0;
+        if (!mib_leaf_upsert(leaf, oid, value))
+            return;
 
-        // Usar '.' como separador
-        while (std::getline(ss, token, '.')) {
-            if (!token.empty()) {
-                oid.push_back(static_cast<uint32_t>(std::stoul(token)));
-            }
+        ++count;
+        if (leaf.size() > MIB_LEAF_SIZE) {
+            bool appended = at_end && idx + 1 == leaves.size();
+            MibLeaf upper = mib_leaf_split(leaf, appended);
+            leaves.insert(leaves.begin() + idx + 1, std::move(upper));
         }
-        return oid;
     }
 
 public:
     MibMgr() = default;
 
-    inline void dumpData() {
-        std::cout << "Dump std::map<std::string, SnmpVariant>:\n";
-        for (const auto& [key, value] : data) {
-            std::cout << "  Key=\"" << key << "\" Value=";
-            printVariant(value);
-            std::cout << "\n";
-        }
+    inline size_t size() const { return count; }
+
+    /**
+     * @brief Visits every object in OID order
+     */
+    template <typename Fn>
+    inline void for_each(Fn&& fn) const {
+        for (const MibLeaf& leaf : leaves)
+            for (const MibEntry& entry : leaf)
+                fn(entry.oid, entry.value);
+    }
+
+    inline void dumpData(std::ostream& os = std::cout) {
+        os << "Dump MIB (" << count << " objects):\n";
+        for_each([&](const OID& oid, const SnmpVariant& value) {
+            printOid(os, oid, "  Key=");
+            printVariant(os, value, " Value=", true);
+        });
     }
 
     inline void create(const OID& oid, const SnmpVariant& value) override {
-        data[oid_to_str(oid)] = value;
+        insert_or_assign(oid, value);
     }
 
     inline SnmpVariant read(const OID& oid) override {
         SnmpVariant ret{};
-        auto it = data.find(oid_to_str(oid));
-        if (it != data.end()) {
-            return it->second;
+        if (const MibEntry* entry = mib_find(leaves, oid)) {
+            return entry->value;
         }
         return ret;
     }
 
     inline std::tuple<OID, SnmpVariant> read_next(const OID& oid) override {
-         auto it = data.upper_bound(oid_to_str(oid));
-        if (it != data.end()) {
-            return {str_to_oid(it->first), it->second};
+        if (const MibEntry* entry = mib_find_next(leaves, oid)) {
+            return {entry->oid, entry->value};
         }
         return {oid, static_cast<ErrorCode>(DataType::NO_SUCH_OBJECT)};
     }
 
     inline void update(const OID& oid, const SnmpVariant& value) override {
-        data[oid_to_str(oid)] = value;
+        insert_or_assign(oid, value);
+    }
+
+    /**
+     * @brief One merge pass over the leaves the batch reaches (bulk load
+     * into an empty MIB builds full leaves directly)
+     */
+    inline void apply_batch(std::span<const MibEntry> upserts, std::span<const OID> deletes = {}) override {
+        mib_check_batch(upserts, deletes);
+        count += mib_apply_batch(leaves, upserts, deletes, [](MibLeaf&& leaf) { return std::move(leaf); });
+    }
+
+    inline void walk(const OID& start, const std::function<bool(const OID&, const SnmpVariant&)>& visit) override {
+        mib_walk(leaves, start, visit);
     }
 
     inline void delete_oid(const OID& oid) override {
-        data.erase(oid_to_str(oid));
+        size_t idx = mib_leaf_lower_bound(leaves, oid);
+        if (idx == leaves.size() || !mib_leaf_erase(leaves[idx], oid)) return;
+
+        --count;
+        if (leaves[idx].empty())
+            leaves.erase(leaves.begin() + idx);
     }
 };
 
-} //SnmpServer
\ No newline at end of file
+} //SnmpServer
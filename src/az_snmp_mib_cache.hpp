@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_intfs.hpp"
+#include "az_snmp_ber.hpp"
+#include "az_snmp_trace.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief MibIntf decorator keeping GET answers pre-encoded.
+ * The first GET of an object encodes its VarBind (SEQUENCE of OID and
+ * value) once; later GETs copy those bytes straight into the response.
+ * create(), update() and delete_oid() drop the cached entry, so every write
+ * must go through this object rather than the wrapped store.
+ *
+ * Meant for mostly-static objects (sysDescr, sysName...): only objects
+ * under the given subtrees are cached (all of them when none are given),
+ * and exceptions (noSuchObject...) are never stored. Thread-safe when the
+ * wrapped store is.
+ */
+class CachedMib : public MibIntf {
+private:
+    MibIntf* inner;
+    std::vector<OID> subtrees;
+    size_t max_entries;
+
+    std::shared_mutex mutex;
+    std::unordered_map<OID, std::vector<uint8_t>> entries;
+    uint64_t generation = 0; // Bumped by every write, under mutex
+
+    std::atomic<uint64_t> hit_count{0};
+    std::atomic<uint64_t> miss_count{0};
+    std::atomic<uint64_t> invalidation_count{0};
+
+    inline bool cacheable(const OID& oid) const {
+        if (subtrees.empty()) return true;
+        for (const OID& subtree : subtrees)
+            if (oid_has_prefix(oid, subtree)) return true;
+        return false;
+    }
+
+    inline void invalidate(const OID& oid) {
+        std::unique_lock lock(mutex);
+        if (entries.erase(oid)) invalidation_count.fetch_add(1, std::memory_order_relaxed);
+        ++generation;
+    }
+
+public:
+    static constexpr size_t DEFAULT_MAX_ENTRIES = 4096;
+
+    explicit CachedMib(MibIntf* mib, std::vector<OID> cached_subtrees = {},
+                       size_t max_cached = DEFAULT_MAX_ENTRIES)
+        : inner(mib), subtrees(std::move(cached_subtrees)), max_entries(max_cached) {}
+
+    inline uint64_t hits() const { return hit_count.load(std::memory_order_relaxed); }
+    inline uint64_t misses() const { return miss_count.load(std::memory_order_relaxed); }
+    inline uint64_t invalidations() const { return invalidation_count.load(std::memory_order_relaxed); }
+
+    inline size_t size() {
+        std::shared_lock lock(mutex);
+        return entries.size();
+    }
+
+    inline void create(const OID& oid, const SnmpVariant& value) override {
+        inner->create(oid, value);
+        invalidate(oid);
+    }
+
+    inline SnmpVariant read(const OID& oid) override {
+        return inner->read(oid);
+    }
+
+    inline std::tuple<OID, SnmpVariant> read_next(const OID& oid) override {
+        return inner->read_next(oid);
+    }
+
+    inline void update(const OID& oid, const SnmpVariant& value) override {
+        inner->update(oid, value);
+        invalidate(oid);
+    }
+
+    inline void delete_oid(const OID& oid) override {
+        inner->delete_oid(oid);
+        invalidate(oid);
+    }
+
+    inline void apply_batch(std::span<const MibEntry> upserts, std::span<const OID> deletes = {}) override {
+        // Held across both: a hit cannot return a pre-batch answer once
+        // the store serves the batch
+        std::unique_lock lock(mutex);
+        inner->apply_batch(upserts, deletes);
+        size_t dropped = 0;
+        for (const MibEntry& entry : upserts) dropped += entries.erase(entry.oid);
+        for (const OID& oid : deletes) dropped += entries.erase(oid);
+        invalidation_count.fetch_add(dropped, std::memory_order_relaxed);
+        ++generation;
+    }
+
+    inline void walk(const OID& start, const std::function<bool(const OID&, const SnmpVariant&)>& visit) override {
+        inner->walk(start, visit);
+    }
+
+    inline bool read_encoded(const OID& oid, const std::function<void(std::span<const uint8_t>)>& emit) override {
+        if (!cacheable(oid)) return false;
+
+        uint64_t seen;
+        {
+            std::shared_lock lock(mutex);
+            auto it = entries.find(oid);
+            if (it != entries.end()) {
+                hit_count.fetch_add(1, std::memory_order_relaxed);
+                emit(it->second);
+                return true;
+            }
+            seen = generation;
+        }
+        miss_count.fetch_add(1, std::memory_order_relaxed);
+
+        SnmpVariant value = inner->read(oid);
+        thread_local BerWriter scratch(256);
+        scratch.reset();
+        scratch.write_variant(value);
+        scratch.write_oid(oid);
+        scratch.close(DataType::SEQUENCE, 0);
+        std::span<const uint8_t> varbind = scratch.data();
+
+        bool storable = !std::holds_alternative<std::monostate>(value) && !std::holds_alternative<ErrorCode>(value);
+        if (storable) {
+            // A write since the lookup may have raced with inner->read()
+            std::unique_lock lock(mutex);
+            if (generation == seen && entries.size() < max_entries)
+                entries.try_emplace(oid, varbind.begin(), varbind.end());
+        }
+
+        AZ_SNMP_LOG_FMT(DEBUG, os, printOid(os, oid, "[Cache] MISS OID: "));
+
+        emit(varbind);
+        return true;
+    }
+};
+
+} //SnmpServer
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_intfs.hpp"
+#include "az_snmp_mib.hpp"
+#include "az_snmp_epoch.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief MIB Manager safe for many reader threads and concurrent writers.
+ * Inherits from MibIntf.
+ *
+ * Same chunked sorted array as MibMgr, but every published version is
+ * immutable: readers run wait-free against the current snapshot under an
+ * EpochGuard. Writers (serialized by a mutex) copy only the leaf they touch
+ * plus the vector of leaf pointers, publish the new version atomically, and
+ * retire the old one through epoch-based reclamation. Unchanged leaves are
+ * shared between versions.
+ */
+class ConcurrentMibMgr : public MibIntf {
+private:
+    using LeafPtr = std::shared_ptr<const MibLeaf>;
+
+    struct Version {
+        std::vector<LeafPtr> leaves;
+        size_t count = 0;
+    };
+
+    std::atomic<const Version*> current;
+
+    std::mutex writer_mutex;
+    RetireList retired;
+
+    /**
+     * @brief Publishes next and retires the previous version (writer lock held)
+     */
+    inline void publish(std::unique_ptr<Version> next) {
+        const Version* old = current.exchange(next.release(), std::memory_order_seq_cst);
+        retired.retire([old] { delete old; });
+    }
+
+    inline void write(const OID& oid, const SnmpVariant& value) {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        const Version* base = current.load(std::memory_order_relaxed);
+
+        auto next = std::make_unique<Version>(*base);
+
+        if (next->leaves.empty()) {
+            next->leaves.push_back(std::make_shared<const MibLeaf>(MibLeaf{MibEntry{oid, value}}));
+            next->count = 1;
+            publish(std::move(next));
+            return;
+        }
+
+        size_t idx = std::min(mib_leaf_lower_bound(base->leaves, oid), base->leaves.size() - 1);
+        const MibLeaf& old_leaf = *base->leaves[idx];
+        bool at_end = oid_compare(old_leaf.back().oid, oid) < 0;
+
+        MibLeaf leaf;
+        leaf.reserve(MIB_LEAF_SIZE + 1);
+        leaf = old_leaf;
+        if (mib_leaf_upsert(leaf, oid, value))
+            ++next->count;
+
+        if (leaf.size() > MIB_LEAF_SIZE) {
+            bool appended = at_end && idx + 1 == base->leaves.size();
+            MibLeaf upper = mib_leaf_split(leaf, appended);
+            next->leaves.insert(next->leaves.begin() + idx + 1, std::make_shared<const MibLeaf>(std::move(upper)));
+        }
+        next->leaves[idx] = std::make_shared<const MibLeaf>(std::move(leaf));
+
+        publish(std::move(next));
+    }
+
+public:
+    ConcurrentMibMgr() : current(new Version{}) {}
+
+    ~ConcurrentMibMgr() override {
+        retired.drain_all();
+        delete current.load();
+    }
+
+    ConcurrentMibMgr(const ConcurrentMibMgr&) = delete;
+    ConcurrentMibMgr& operator=(const ConcurrentMibMgr&) = delete;
+
+    inline size_t size() const {
+        EpochGuard guard;
+        return current.load(std::memory_order_seq_cst)->count;
+    }
+
+    /**
+     * @brief Visits every object of one consistent snapshot in OID order
+     */
+    template <typename Fn>
+    inline void for_each(Fn&& fn) const {
+        EpochGuard guard;
+        const Version* snapshot = current.load(std::memory_order_seq_cst);
+        for (const LeafPtr& leaf : snapshot->leaves)
+            for (const MibEntry& entry : *leaf)
+                fn(entry.oid, entry.value);
+    }
+
+    /**
+     * @brief Versions retired but not yet reclaimed
+     */
+    inline size_t pending_reclaim() {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        retired.collect();
+        return retired.size();
+    }
+
+    inline void create(const OID& oid, const SnmpVariant& value) override {
+        write(oid, value);
+    }
+
+    inline SnmpVariant read(const OID& oid) override {
+        EpochGuard guard;
+        const Version* snapshot = current.load(std::memory_order_seq_cst);
+        if (const MibEntry* entry = mib_find(snapshot->leaves, oid)) {
+            return entry->value;
+        }
+        return {};
+    }
+
+    inline std::tuple<OID, SnmpVariant> read_next(const OID& oid) override {
+        EpochGuard guard;
+        const Version* snapshot = current.load(std::memory_order_seq_cst);
+        if (const MibEntry* entry = mib_find_next(snapshot->leaves, oid)) {
+            return {entry->oid, entry->value};
+        }
+        return {oid, static_cast<ErrorCode>(DataType::NO_SUCH_OBJECT)};
+    }
+
+    /**
+     * @brief Walks one consistent snapshot (visit runs inside the epoch guard)
+     */
+    inline void walk(const OID& start, const std::function<bool(const OID&, const SnmpVariant&)>& visit) override {
+        EpochGuard guard;
+        mib_walk(current.load(std::memory_order_seq_cst)->leaves, start, visit);
+    }
+
+    inline void update(const OID& oid, const SnmpVariant& value) override {
+        write(oid, value);
+    }
+
+    /**
+     * @brief Merges the batch into one new version, published at once:
+     * readers see all of it or none of it (e.g. a whole table row)
+     */
+    inline void apply_batch(std::span<const MibEntry> upserts, std::span<const OID> deletes = {}) override {
+        mib_check_batch(upserts, deletes);
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        auto next = std::make_unique<Version>(*current.load(std::memory_order_relaxed));
+        next->count += mib_apply_batch(next->leaves, upserts, deletes, [](MibLeaf&& leaf) {
+            return std::make_shared<const MibLeaf>(std::move(leaf));
+        });
+        publish(std::move(next));
+    }
+
+    inline void delete_oid(const OID& oid) override {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        const Version* base = current.load(std::memory_order_relaxed);
+
+        size_t idx = mib_leaf_lower_bound(base->leaves, oid);
+        if (idx == base->leaves.size()) return;
+
+        MibLeaf leaf = *base->leaves[idx];
+        if (!mib_leaf_erase(leaf, oid)) return;
+
+        auto next = std::make_unique<Version>(*base);
+        --next->count;
+        if (leaf.empty()) {
+            next->leaves.erase(next->leaves.begin() + idx);
+        } else {
+            next->leaves[idx] = std::make_shared<const MibLeaf>(std::move(leaf));
+        }
+
+        publish(std::move(next));
+    }
+};
+
+} //SnmpServer
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <stdexcept>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_intfs.hpp"
+#include "az_snmp_mib.hpp"
+#include "az_snmp_epoch.hpp"
+#include "az_snmp_trace.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief Computes every object of one subtree, in any order (e.g. one read
+ * of /proc/net/dev for the whole ifTable). Objects outside the subtree are
+ * dropped.
+ */
+using MibProvider = std::function<void(std::vector<MibEntry>& objects)>;
+
+/**
+ * @brief MibIntf decorator serving registered subtrees from providers.
+ * Values of a subtree are computed only when a request reaches it, then
+ * kept for the subtree's TTL: every GET, GETNEXT or walk step in that
+ * window reads the same snapshot, so a request for many objects costs one
+ * provider call. Threads missing at the same time wait for a single call
+ * instead of running the provider each.
+ *
+ * Everything outside the subtrees goes to the wrapped store; read_next()
+ * and walk() merge both in OID order. Provided subtrees are read-only.
+ * Snapshots are published like ConcurrentMibMgr versions (readers under an
+ * EpochGuard), so it is thread-safe when the wrapped store is.
+ * Register subtrees before serving requests. Do not put a CachedMib in
+ * front of provided subtrees (it would keep values beyond the TTL).
+ */
+class LazyMib : public MibIntf {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Snapshot {
+        std::vector<MibEntry> entries; // Sorted
+        Clock::time_point taken;
+        Clock::time_point expires;
+    };
+
+    struct Subtree {
+        OID prefix;
+        MibProvider provider;
+        Clock::duration ttl;
+
+        std::atomic<const Snapshot*> current{nullptr};
+        std::mutex refresh_mutex; // Single flight, guards retired
+        RetireList retired;
+
+        ~Subtree() {
+            retired.drain_all();
+            delete current.load();
+        }
+    };
+
+    MibIntf* inner;
+    std::vector<std::unique_ptr<Subtree>> subtrees; // Sorted by prefix, disjoint
+    std::atomic<uint64_t> provider_call_count{0};
+
+    /**
+     * @brief Runs the provider unless another thread published a snapshot
+     * since asked (it then serves this caller too)
+     */
+    inline void refresh(Subtree& subtree, Clock::time_point asked) {
+        std::lock_guard<std::mutex> lock(subtree.refresh_mutex);
+        // Only this mutex's holder retires snapshots: current stays valid
+        const Snapshot* snapshot = subtree.current.load(std::memory_order_seq_cst);
+        if (snapshot && snapshot->taken >= asked)
+            return;
+
+        auto next = std::make_unique<Snapshot>();
+        subtree.provider(next->entries);
+        provider_call_count.fetch_add(1, std::memory_order_relaxed);
+
+        std::erase_if(next->entries, [&](const MibEntry& entry) { return !oid_has_prefix(entry.oid, subtree.prefix); });
+        std::sort(next->entries.begin(), next->entries.end(), [](const MibEntry& a, const MibEntry& b) {
+            return oid_compare(a.oid, b.oid) < 0;
+        });
+        next->taken = Clock::now();
+        next->expires = next->taken + subtree.ttl;
+
+        AZ_SNMP_LOG_FMT(DEBUG, os,
+            printOid(os, subtree.prefix, "[Lazy] Refreshed subtree: ");
+            os << " (" << next->entries.size() << " objects)");
+
+        const Snapshot* old = subtree.current.exchange(next.release(), std::memory_order_seq_cst);
+        if (old) subtree.retired.retire([old] { delete old; });
+    }
+
+    /**
+     * @brief Refreshes the subtree once its snapshot expired. Called outside
+     * any EpochGuard: a slow provider must not hold back the reclamation of
+     * every epoch-protected object in the process. Read the snapshot under
+     * a new guard afterwards.
+     */
+    inline void ensure_fresh(Subtree& subtree) {
+        Clock::time_point now = Clock::now();
+        {
+            EpochGuard guard;
+            const Snapshot* snapshot = subtree.current.load(std::memory_order_seq_cst);
+            if (snapshot && now < snapshot->expires)
+                return;
+        }
+        refresh(subtree, now);
+    }
+
+    /**
+     * @brief Subtree holding oid, nullptr if none
+     */
+    inline Subtree* owner(const OID& oid) const {
+        auto it = std::upper_bound(subtrees.begin(), subtrees.end(), oid, [](const OID& key, const auto& subtree) {
+            return oid_compare(key, subtree->prefix) < 0;
+        });
+        if (it == subtrees.begin()) return nullptr;
+        --it;
+        return oid_has_prefix(oid, (*it)->prefix) ? it->get() : nullptr;
+    }
+
+    /**
+     * @brief First subtree that may hold objects after oid
+     */
+    inline size_t first_after(const OID& oid) const {
+        auto it = std::partition_point(subtrees.begin(), subtrees.end(), [&](const auto& subtree) {
+            return oid_compare(subtree->prefix, oid) < 0 && !oid_has_prefix(oid, subtree->prefix);
+        });
+        return static_cast<size_t>(it - subtrees.begin());
+    }
+
+    inline bool provided(const OID& oid, const char* operation) const {
+        if (!owner(oid)) return false;
+        AZ_SNMP_LOG_FMT(WARN, os,
+            os << "[Lazy] " << operation << " ignored on provided OID";
+            printOid(os, oid, " "));
+        return true;
+    }
+
+public:
+    explicit LazyMib(MibIntf* mib) : inner(mib) {}
+
+    /**
+     * @brief Serves the subtree under prefix from provider, caching its
+     * results for ttl (0: no caching, only concurrent misses share a call)
+     */
+    inline void register_subtree(const OID& prefix, MibProvider provider, std::chrono::milliseconds ttl) {
+        for (const auto& subtree : subtrees) {
+            if (oid_has_prefix(prefix, subtree->prefix) || oid_has_prefix(subtree->prefix, prefix))
+                throw std::runtime_error("Provided MIB subtrees must not overlap.");
+        }
+        auto subtree = std::make_unique<Subtree>();
+        subtree->prefix = prefix;
+        subtree->provider = std::move(provider);
+        subtree->ttl = ttl;
+
+        auto it = std::upper_bound(subtrees.begin(), subtrees.end(), prefix, [](const OID& key, const auto& other) {
+            return oid_compare(key, other->prefix) < 0;
+        });
+        subtrees.insert(it, std::move(subtree));
+    }
+
+    /**
+     * @brief Provider runs so far (all subtrees)
+     */
+    inline uint64_t provider_calls() const { return provider_call_count.load(std::memory_order_relaxed); }
+
+    inline void create(const OID& oid, const SnmpVariant& value) override {
+        if (!provided(oid, "create")) inner->create(oid, value);
+    }
+
+    inline SnmpVariant read(const OID& oid) override {
+        Subtree* subtree = owner(oid);
+        if (!subtree) return inner->read(oid);
+
+        ensure_fresh(*subtree);
+        EpochGuard guard;
+        const Snapshot* snapshot = subtree->current.load(std::memory_order_seq_cst);
+        auto it = std::lower_bound(snapshot->entries.begin(), snapshot->entries.end(), oid, mib_entry_less);
+        if (it != snapshot->entries.end() && oid_compare(it->oid, oid) == 0)
+            return it->value;
+        return SnmpVariant{};
+    }
+
+    inline std::tuple<OID, SnmpVariant> read_next(const OID& oid) override {
+        auto [next, value] = inner->read_next(oid);
+        bool in_store = !(std::holds_alternative<ErrorCode>(value) && oid_compare(next, oid) <= 0);
+
+        for (size_t idx = first_after(oid); idx < subtrees.size(); ++idx) {
+            Subtree& subtree = *subtrees[idx];
+            // The store's next object comes before anything under this prefix
+            if (in_store && oid_compare(subtree.prefix, next) > 0)
+                break;
+
+            ensure_fresh(subtree);
+            EpochGuard guard;
+            const Snapshot* snapshot = subtree.current.load(std::memory_order_seq_cst);
+            auto it = std::upper_bound(snapshot->entries.begin(), snapshot->entries.end(), oid, mib_oid_less);
+            if (it == snapshot->entries.end())
+                continue;
+            if (!in_store || oid_compare(it->oid, next) < 0)
+                return {it->oid, it->value};
+            break;
+        }
+        return {std::move(next), std::move(value)};
+    }
+
+    inline void update(const OID& oid, const SnmpVariant& value) override {
+        if (!provided(oid, "update")) inner->update(oid, value);
+    }
+
+    inline void delete_oid(const OID& oid) override {
+        if (!provided(oid, "delete")) inner->delete_oid(oid);
+    }
+
+    inline void apply_batch(std::span<const MibEntry> upserts, std::span<const OID> deletes = {}) override {
+        mib_forward_batch(inner, upserts, deletes, [this](const OID& oid, const char* operation) {
+            return provided(oid, operation);
+        });
+    }
+
+    /**
+     * @brief Store walk with the provided objects interleaved in order.
+     * The store is walked up to the next subtree, which is refreshed
+     * outside the store's walk (and its EpochGuard), then the walk resumes
+     * after it.
+     */
+    inline void walk(const OID& start, const std::function<bool(const OID&, const SnmpVariant&)>& visit) override {
+        OID cursor = start;
+        bool store_done = false;
+
+        for (size_t idx = first_after(start); ; ++idx) {
+            const OID* limit = idx < subtrees.size() ? &subtrees[idx]->prefix : nullptr;
+            bool more = true;
+            if (!store_done) {
+                store_done = true;
+                inner->walk(cursor, [&](const OID& oid, const SnmpVariant& value) {
+                    if (limit && oid_compare(oid, *limit) >= 0) {
+                        store_done = false;
+                        return false;
+                    }
+                    more = visit(oid, value);
+                    return more;
+                });
+            }
+            if (!more || !limit) return;
+
+            Subtree& subtree = *subtrees[idx];
+            ensure_fresh(subtree);
+            EpochGuard guard;
+            const Snapshot* snapshot = subtree.current.load(std::memory_order_seq_cst);
+            auto it = std::upper_bound(snapshot->entries.begin(), snapshot->entries.end(), start, mib_oid_less);
+            for (; it != snapshot->entries.end(); ++it)
+                if (!visit(it->oid, it->value)) return;
+
+            // The store has nothing under the prefix: resume past the subtree
+            if (oid_compare(start, subtree.prefix) < 0) cursor = subtree.prefix;
+            if (!snapshot->entries.empty() && oid_compare(snapshot->entries.back().oid, cursor) > 0)
+                cursor = snapshot->entries.back().oid;
+        }
+    }
+};
+
+} //SnmpServer
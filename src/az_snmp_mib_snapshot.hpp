@@ -0,0 +1,412 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_intfs.hpp"
+#include "az_snmp_mib.hpp"
+#include "az_snmp_ber.hpp"
+#include "az_snmp_trace.hpp"
+
+namespace SnmpServer {
+
+//==============================================
+// ON-DISK FORMAT
+//==============================================
+
+/**
+ * @brief MIB snapshot file, version 1. Every position is an offset from the
+ * start of the file, so the file can be mapped anywhere and shared by
+ * several processes. Integers are in the byte order of the host that wrote
+ * the file (checked on open).
+ *
+ *   header    MibSnapshotHeader
+ *   index     MibSnapshotEntry[count], sorted by OID
+ *   oids      uint32_t sub-identifiers of every OID, back to back
+ *   varbinds  BER VarBind (SEQUENCE of OID and value) of every object,
+ *             exactly as a GET answer encodes it
+ */
+struct MibSnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t count;
+    uint64_t index_offset;
+    uint64_t oids_offset;
+    uint64_t varbinds_offset;
+    uint64_t file_size;
+};
+
+struct MibSnapshotEntry {
+    uint64_t oid;          // First sub-identifier, in the oids section
+    uint64_t varbind;      // First byte, in the varbinds section
+    uint32_t oid_len;
+    uint32_t varbind_len;
+};
+
+static_assert(sizeof(MibSnapshotHeader) == 56 && sizeof(MibSnapshotEntry) == 24);
+
+constexpr char MIB_SNAPSHOT_MAGIC[8] = {'A', 'Z', 'S', 'N', 'M', 'I', 'B', '\0'};
+constexpr uint32_t MIB_SNAPSHOT_VERSION = 1;
+constexpr uint32_t MIB_SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+/**
+ * @brief Writes size bytes to fd, across short writes
+ */
+inline bool write_fully(int fd, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Writes every object of mib to path as a snapshot. The file is
+ * written to a unique temporary beside path, synced and renamed over it,
+ * so agents that have the old snapshot mapped keep serving it until they
+ * reopen, and a crash leaves either the old or the new snapshot.
+ * @return Objects written
+ */
+inline size_t write_mib_snapshot(MibIntf& mib, const std::string& path) {
+    std::vector<MibSnapshotEntry> index;
+    std::vector<uint32_t> oids;
+    std::vector<uint8_t> varbinds;
+    BerWriter writer(256);
+
+    mib.walk(OID{}, [&](const OID& oid, const SnmpVariant& value) {
+        writer.reset();
+        writer.write_variant(value);
+        writer.write_oid(oid);
+        writer.close(DataType::SEQUENCE, 0);
+
+        index.push_back({oids.size(), varbinds.size(), static_cast<uint32_t>(oid.size()),
+                         static_cast<uint32_t>(writer.mark())});
+        oids.insert(oids.end(), oid.begin(), oid.end());
+        varbinds.insert(varbinds.end(), writer.data().begin(), writer.data().end());
+        return true;
+    });
+
+    MibSnapshotHeader header{};
+    std::memcpy(header.magic, MIB_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = MIB_SNAPSHOT_VERSION;
+    header.byte_order = MIB_SNAPSHOT_BYTE_ORDER;
+    header.count = index.size();
+    header.index_offset = sizeof(MibSnapshotHeader);
+    header.oids_offset = header.index_offset + index.size() * sizeof(MibSnapshotEntry);
+    header.varbinds_offset = header.oids_offset + oids.size() * sizeof(uint32_t);
+    header.file_size = header.varbinds_offset + varbinds.size();
+
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    std::string temp = path + ".XXXXXX";
+    int fd = mkstemp(temp.data());
+    if (fd < 0)
+        throw std::runtime_error("Failed to create MIB snapshot beside '" + path + "': " + std::strerror(errno));
+
+    // Readable by other agents, as a file created by open() would be
+    bool written = fchmod(fd, 0644) == 0 &&
+                   write_fully(fd, &header, sizeof(header)) &&
+                   write_fully(fd, index.data(), index.size() * sizeof(MibSnapshotEntry)) &&
+                   write_fully(fd, oids.data(), oids.size() * sizeof(uint32_t)) &&
+                   write_fully(fd, varbinds.data(), varbinds.size()) &&
+                   fsync(fd) == 0; // Data on disk before the rename
+    int error = errno;
+    close(fd);
+    if (!written) {
+        unlink(temp.c_str());
+        throw std::runtime_error("Failed to write MIB snapshot '" + temp + "': " + std::strerror(error));
+    }
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        error = errno;
+        unlink(temp.c_str());
+        throw std::runtime_error("Failed to replace MIB snapshot '" + path + "': " + std::strerror(error));
+    }
+
+    // Make the rename itself durable
+    int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+
+    AZ_SNMP_LOG(INFO, "[Snapshot] Wrote " << index.size() << " objects to " << path);
+    return index.size();
+}
+
+//==============================================
+// MAPPED SNAPSHOT
+//==============================================
+
+/**
+ * @brief Read-only mapping of a snapshot file. Opening checks the header
+ * only, whatever the number of objects: the index and values are paged in
+ * as requests touch them, from a page cache shared by every process
+ * mapping the same file.
+ */
+class MibSnapshot {
+private:
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+    const MibSnapshotEntry* index = nullptr;
+    const uint32_t* oids = nullptr;
+    const uint8_t* varbinds = nullptr;
+    size_t entries = 0;
+    size_t oids_count = 0;
+    size_t varbinds_size = 0;
+
+    [[noreturn]] static void fail(const std::string& path, const std::string& reason) {
+        throw std::runtime_error("Invalid MIB snapshot '" + path + "': " + reason + ".");
+    }
+
+public:
+    explicit MibSnapshot(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw std::runtime_error("Failed to open MIB snapshot '" + path + "': " + std::strerror(errno));
+        struct stat info{};
+        if (fstat(fd, &info) < 0) {
+            close(fd);
+            throw std::runtime_error("Failed to stat MIB snapshot '" + path + "'.");
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length < sizeof(MibSnapshotHeader)) {
+            close(fd);
+            fail(path, "truncated header");
+        }
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); // The mapping keeps the file
+        if (mapped == MAP_FAILED)
+            throw std::runtime_error("Failed to map MIB snapshot '" + path + "': " + std::strerror(errno));
+        base = static_cast<const uint8_t*>(mapped);
+
+        try {
+            const auto* header = reinterpret_cast<const MibSnapshotHeader*>(base);
+            if (std::memcmp(header->magic, MIB_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0)
+                fail(path, "not a snapshot");
+            if (header->byte_order != MIB_SNAPSHOT_BYTE_ORDER)
+                fail(path, "written with another byte order");
+            if (header->version != MIB_SNAPSHOT_VERSION)
+                fail(path, "unsupported version " + std::to_string(header->version));
+            if (header->file_size != length || header->index_offset != sizeof(MibSnapshotHeader) ||
+                header->count > (length - header->index_offset) / sizeof(MibSnapshotEntry) ||
+                header->oids_offset != header->index_offset + header->count * sizeof(MibSnapshotEntry) ||
+                header->varbinds_offset < header->oids_offset || header->varbinds_offset > length ||
+                (header->varbinds_offset - header->oids_offset) % sizeof(uint32_t) != 0)
+                fail(path, "inconsistent sections");
+
+            entries = header->count;
+            index = reinterpret_cast<const MibSnapshotEntry*>(base + header->index_offset);
+            oids = reinterpret_cast<const uint32_t*>(base + header->oids_offset);
+            oids_count = (header->varbinds_offset - header->oids_offset) / sizeof(uint32_t);
+            varbinds = base + header->varbinds_offset;
+            varbinds_size = length - header->varbinds_offset;
+        } catch (...) {
+            munmap(const_cast<uint8_t*>(base), length);
+            throw;
+        }
+    }
+
+    ~MibSnapshot() {
+        if (base) munmap(const_cast<uint8_t*>(base), length);
+    }
+
+    MibSnapshot(const MibSnapshot&) = delete;
+    MibSnapshot& operator=(const MibSnapshot&) = delete;
+
+    inline size_t size() const { return entries; }
+
+    /**
+     * @brief OID of object i (empty if the entry points outside the file)
+     */
+    inline std::span<const uint32_t> oid(size_t i) const {
+        const MibSnapshotEntry& entry = index[i];
+        if (entry.oid > oids_count || entry.oid_len > oids_count - entry.oid) return {};
+        return {oids + entry.oid, entry.oid_len};
+    }
+
+    /**
+     * @brief Encoded VarBind of object i (empty if outside the file)
+     */
+    inline std::span<const uint8_t> varbind(size_t i) const {
+        const MibSnapshotEntry& entry = index[i];
+        if (entry.varbind > varbinds_size || entry.varbind_len > varbinds_size - entry.varbind) return {};
+        return {varbinds + entry.varbind, entry.varbind_len};
+    }
+
+    /**
+     * @brief Value of object i decoded from its VarBind
+     */
+    inline SnmpVariant value(size_t i) const {
+        std::span<const uint8_t> encoded = varbind(i);
+        size_t pos = 0;
+        auto sequence = readBerTlv(encoded, pos);
+        if (!sequence) return SnmpVariant{};
+        pos = 0;
+        if (!readBerTlv(sequence->value, pos)) return SnmpVariant{}; // OID
+        auto tlv = readBerTlv(sequence->value, pos);
+        if (!tlv) return SnmpVariant{};
+
+        switch (static_cast<DataType>(tlv->tag)) {
+            case DataType::INTEGER:
+                if (auto num = parseInt(tlv->value)) return *num;
+                break;
+            case DataType::OCTET_STRING:
+                return std::pmr::string(parseOctetString(tlv->value));
+            case DataType::OBJECT_ID:
+                if (auto value_oid = parseOid(tlv->value)) return value_oid->to_oid();
+                break;
+            case DataType::VAL_NULL:
+                break;
+            default:
+                if (tlv->value.empty()) return static_cast<ErrorCode>(tlv->tag); // noSuchObject...
+                break;
+        }
+        return SnmpVariant{};
+    }
+
+    /**
+     * @brief First object whose OID is >= oid (> oid when after is set)
+     */
+    inline size_t lower_bound(const OID& key, bool after = false) const {
+        size_t low = 0, high = entries;
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            std::span<const uint32_t> mid_oid = oid(mid);
+            size_t n = std::min(mid_oid.size(), key.size());
+            size_t i = subid_mismatch(mid_oid.data(), key.data(), n);
+            int cmp = (i < n) ? (mid_oid[i] < key[i] ? -1 : 1)
+                              : (mid_oid.size() == key.size() ? 0 : (mid_oid.size() < key.size() ? -1 : 1));
+            if (cmp < 0 || (after && cmp == 0)) low = mid + 1;
+            else high = mid;
+        }
+        return low;
+    }
+
+    /**
+     * @brief Index of the object with this OID, size() if none
+     */
+    inline size_t find(const OID& key) const {
+        size_t i = lower_bound(key);
+        if (i < entries && std::ranges::equal(oid(i), key.span())) return i;
+        return entries;
+    }
+};
+
+/**
+ * @brief MibIntf serving a mapped snapshot in front of a dynamic store, so
+ * an agent answers as soon as the file is mapped instead of after creating
+ * every object. GETs on snapshot objects copy their VarBind straight from
+ * the mapping (read_encoded). Snapshot objects are read-only; everything
+ * else goes to the wrapped store, and read_next() and walk() merge both in
+ * OID order. Thread-safe when the wrapped store is.
+ */
+class MappedMib : public MibIntf {
+private:
+    MibSnapshot snapshot;
+    MibIntf* inner;
+
+    inline bool in_snapshot(const OID& oid, const char* operation) const {
+        if (snapshot.find(oid) == snapshot.size()) return false;
+        AZ_SNMP_LOG_FMT(WARN, os,
+            os << "[Snapshot] " << operation << " ignored on snapshot OID";
+            printOid(os, oid, " "));
+        return true;
+    }
+
+    inline OID to_oid(size_t i) const { return OID(snapshot.oid(i)); }
+
+public:
+    MappedMib(const std::string& path, MibIntf* mib) : snapshot(path), inner(mib) {}
+
+    inline size_t snapshot_objects() const { return snapshot.size(); }
+
+    inline void create(const OID& oid, const SnmpVariant& value) override {
+        if (!in_snapshot(oid, "create")) inner->create(oid, value);
+    }
+
+    inline SnmpVariant read(const OID& oid) override {
+        size_t i = snapshot.find(oid);
+        if (i < snapshot.size()) return snapshot.value(i);
+        return inner->read(oid);
+    }
+
+    inline bool read_encoded(const OID& oid, const std::function<void(std::span<const uint8_t>)>& emit) override {
+        size_t i = snapshot.find(oid);
+        if (i == snapshot.size()) return inner->read_encoded(oid, emit);
+        std::span<const uint8_t> varbind = snapshot.varbind(i);
+        // Entry pointing outside the file: the caller encodes read() instead
+        if (varbind.empty()) return false;
+        emit(varbind);
+        return true;
+    }
+
+    inline std::tuple<OID, SnmpVariant> read_next(const OID& oid) override {
+        auto [next, value] = inner->read_next(oid);
+        bool in_store = !(std::holds_alternative<ErrorCode>(value) && oid_compare(next, oid) <= 0);
+
+        size_t i = snapshot.lower_bound(oid, true);
+        if (i < snapshot.size()) {
+            OID candidate = to_oid(i);
+            if (!in_store || oid_compare(candidate, next) < 0)
+                return {std::move(candidate), snapshot.value(i)};
+        }
+        return {std::move(next), std::move(value)};
+    }
+
+    inline void update(const OID& oid, const SnmpVariant& value) override {
+        if (!in_snapshot(oid, "update")) inner->update(oid, value);
+    }
+
+    inline void delete_oid(const OID& oid) override {
+        if (!in_snapshot(oid, "delete")) inner->delete_oid(oid);
+    }
+
+    inline void apply_batch(std::span<const MibEntry> upserts, std::span<const OID> deletes = {}) override {
+        mib_forward_batch(inner, upserts, deletes, [this](const OID& oid, const char* operation) {
+            return in_snapshot(oid, operation);
+        });
+    }
+
+    /**
+     * @brief Store walk with the snapshot objects interleaved in order
+     */
+    inline void walk(const OID& start, const std::function<bool(const OID&, const SnmpVariant&)>& visit) override {
+        size_t i = snapshot.lower_bound(start, true);
+
+        // Visits snapshot objects before limit (all when null)
+        auto visit_snapshot = [&](const OID* limit) {
+            for (; i < snapshot.size(); ++i) {
+                OID oid = to_oid(i);
+                if (limit && oid_compare(oid, *limit) >= 0)
+                    return true;
+                if (!visit(oid, snapshot.value(i)))
+                    return false;
+            }
+            return true;
+        };
+
+        bool more = true;
+        inner->walk(start, [&](const OID& oid, const SnmpVariant& value) {
+            more = visit_snapshot(&oid) && visit(oid, value);
+            return more;
+        });
+        if (more) visit_snapshot(nullptr);
+    }
+};
+
+} //SnmpServer
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_intfs.hpp"
+#include "az_snmp_mib.hpp"
+#include "az_snmp_ber.hpp"
+#include "az_snmp_trace.hpp"
+
+namespace SnmpServer {
+
+//==============================================
+// COMPILE-TIME OBJECTS
+//==============================================
+
+/**
+ * @brief OID usable in constant expressions (fixed capacity). Its hash is
+ * the one SnmpOid maintains, so tables built at compile time are probed
+ * with oid.hash() at run time.
+ */
+struct StaticOid {
+    static constexpr size_t CAPACITY = AZ_SNMP_OID_INLINE_CAPACITY;
+
+    std::array<uint32_t, CAPACITY> ids{};
+    uint32_t len = 0;
+    uint64_t hash = SnmpOid::HASH_SEED;
+
+    constexpr StaticOid() = default;
+
+    constexpr StaticOid(std::initializer_list<uint32_t> subids) {
+        if (subids.size() > CAPACITY)
+            throw std::length_error("Static OID longer than AZ_SNMP_OID_INLINE_CAPACITY.");
+        for (uint32_t subid : subids) {
+            ids[len++] = subid;
+            hash = SnmpOid::mix(hash, subid);
+        }
+    }
+
+    constexpr std::span<const uint32_t> span() const { return {ids.data(), len}; }
+
+    inline OID to_oid() const { return OID(span()); }
+};
+
+/**
+ * @brief Three-way comparison in SNMP order (see SnmpOid::compare)
+ */
+constexpr int static_oid_compare(std::span<const uint32_t> a, std::span<const uint32_t> b) {
+    size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i)
+        if (a[i] != b[i]) return (a[i] < b[i]) ? -1 : 1;
+    if (a.size() == b.size()) return 0;
+    return (a.size() < b.size()) ? -1 : 1;
+}
+
+/**
+ * @brief Constant value of a static object: INTEGER, OCTET STRING (the
+ * characters must outlive the table: use literals) or OBJECT IDENTIFIER
+ */
+struct StaticValue {
+    enum class Kind : uint8_t { INTEGER, OCTET_STRING, OBJECT_ID };
+
+    Kind kind = Kind::INTEGER;
+    int64_t integer = 0;
+    std::string_view text;
+    StaticOid oid;
+
+    constexpr StaticValue() = default;
+
+    template <std::integral T>
+    constexpr StaticValue(T value) : kind(Kind::INTEGER), integer(static_cast<int64_t>(value)) {}
+    constexpr StaticValue(const char* value) : kind(Kind::OCTET_STRING), text(value) {}
+    constexpr StaticValue(std::string_view value) : kind(Kind::OCTET_STRING), text(value) {}
+    constexpr StaticValue(const StaticOid& value) : kind(Kind::OBJECT_ID), oid(value) {}
+
+    inline SnmpVariant to_variant() const {
+        switch (kind) {
+            case Kind::INTEGER: return integer;
+            case Kind::OCTET_STRING: return std::pmr::string(text);
+            case Kind::OBJECT_ID: return oid.to_oid();
+        }
+        return SnmpVariant{};
+    }
+};
+
+struct StaticMibObject {
+    StaticOid oid;
+    StaticValue value;
+};
+
+/**
+ * @brief Finalizer spreading every bit of the OID hash (FNV leaves the bits
+ * of OIDs that differ in their last sub-identifier clustered)
+ */
+constexpr uint64_t static_mib_mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    return x;
+}
+
+/**
+ * @brief Hash-and-displace probe: the OID hash picks a bucket, the
+ * bucket's displacement picks the slot (both counts are powers of two)
+ */
+constexpr size_t static_mib_bucket(uint64_t hash, size_t buckets) {
+    return static_cast<size_t>(static_mib_mix(hash) >> 32) & (buckets - 1);
+}
+
+constexpr size_t static_mib_slot(uint64_t hash, uint32_t displace, size_t slots) {
+    return static_cast<size_t>(static_mib_mix(hash ^ (displace * 0x9E3779B97F4A7C15ull))) & (slots - 1);
+}
+
+/**
+ * @brief Size-independent view of a StaticMibTable
+ */
+struct StaticMibView {
+    std::span<const StaticMibObject> objects;
+    std::span<const uint32_t> displacement;
+    std::span<const uint32_t> slots; // Index into objects, objects.size() if empty
+
+    /**
+     * @brief Index of the object with this OID, objects.size() if none
+     */
+    constexpr size_t find(std::span<const uint32_t> oid, uint64_t hash) const {
+        if (objects.empty()) return 0;
+        size_t idx = slots[static_mib_slot(hash, displacement[static_mib_bucket(hash, displacement.size())], slots.size())];
+        if (idx == objects.size() || objects[idx].oid.hash != hash) return objects.size();
+        return static_oid_compare(objects[idx].oid.span(), oid) == 0 ? idx : objects.size();
+    }
+};
+
+/**
+ * @brief Sorted objects plus a perfect hash over their OIDs: no two objects
+ * share a slot, so a GET is one probe and one OID comparison. Built by
+ * make_static_mib().
+ */
+template <size_t N>
+struct StaticMibTable {
+    static constexpr size_t BUCKETS = std::bit_ceil(N / 2 + 1);
+    static constexpr size_t SLOTS = std::bit_ceil(2 * N + 1); // Load factor below 1/2
+    static constexpr uint32_t EMPTY = static_cast<uint32_t>(N);
+
+    std::array<StaticMibObject, N> objects{};   // In OID order
+    std::array<uint32_t, BUCKETS> displacement{};
+    std::array<uint32_t, SLOTS> slots{};
+
+    constexpr size_t size() const { return N; }
+
+    constexpr StaticMibView view() const { return {objects, displacement, slots}; }
+};
+
+/**
+ * @brief Builds a static MIB table at compile time. Objects may be listed
+ * in any order; a duplicate OID, or a table whose hash cannot be made
+ * perfect, is a compile error.
+ *
+ *   constexpr auto SYSTEM_MIB = make_static_mib({
+ *       {{1,3,6,1,2,1,1,1,0}, "Acme router"},
+ *       {{1,3,6,1,2,1,1,2,0}, StaticOid{1,3,6,1,4,1,32473}},
+ *       {{1,3,6,1,2,1,1,7,0}, 72},
+ *   });
+ */
+template <size_t N>
+consteval StaticMibTable<N> make_static_mib(const StaticMibObject (&objects)[N]) {
+    using Table = StaticMibTable<N>;
+    Table table;
+
+    // Indices are sorted, not the (large) objects: keeps under the compiler's constexpr budget
+    std::array<uint32_t, N> order{};
+    for (uint32_t i = 0; i < N; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return static_oid_compare(objects[a].oid.span(), objects[b].oid.span()) < 0;
+    });
+    for (size_t i = 0; i < N; ++i) {
+        table.objects[i] = objects[order[i]];
+        if (i > 0 && static_oid_compare(table.objects[i - 1].oid.span(), table.objects[i].oid.span()) == 0)
+            throw std::logic_error("Static MIB objects must have distinct OIDs.");
+    }
+
+    // Objects grouped by bucket: members of bucket b are by_bucket[first[b] .. first[b + 1])
+    std::array<uint64_t, N> hashes{};
+    std::array<size_t, Table::BUCKETS + 1> first{};
+    for (size_t i = 0; i < N; ++i) {
+        hashes[i] = table.objects[i].oid.hash;
+        ++first[static_mib_bucket(hashes[i], Table::BUCKETS) + 1];
+    }
+    for (size_t b = 0; b < Table::BUCKETS; ++b) first[b + 1] += first[b];
+    std::array<uint32_t, N> by_bucket{};
+    std::array<size_t, Table::BUCKETS> filled{};
+    for (uint32_t i = 0; i < N; ++i) {
+        size_t b = static_mib_bucket(hashes[i], Table::BUCKETS);
+        by_bucket[first[b] + filled[b]++] = i;
+    }
+    size_t largest = *std::max_element(filled.begin(), filled.end());
+
+    table.slots.fill(Table::EMPTY);
+    // Largest buckets first, while most slots are free
+    for (size_t size = largest; size > 0; --size) {
+        for (size_t b = 0; b < Table::BUCKETS; ++b) {
+            if (filled[b] != size) continue;
+            const uint32_t* members = by_bucket.data() + first[b];
+
+            bool placed = false;
+            for (uint32_t displace = 0; !placed && displace < (1u << 16); ++displace) {
+                placed = true;
+                for (size_t m = 0; m < size && placed; ++m) {
+                    size_t s = static_mib_slot(hashes[members[m]], displace, Table::SLOTS);
+                    placed = table.slots[s] == Table::EMPTY;
+                    // Members of one bucket must not collide with each other either
+                    for (size_t other = 0; other < m && placed; ++other)
+                        placed = static_mib_slot(hashes[members[other]], displace, Table::SLOTS) != s;
+                }
+                if (placed) {
+                    table.displacement[b] = displace;
+                    for (size_t m = 0; m < size; ++m)
+                        table.slots[static_mib_slot(hashes[members[m]], displace, Table::SLOTS)] = members[m];
+                }
+            }
+            if (!placed)
+                throw std::logic_error("No perfect hash for the static MIB (OID hash collision).");
+        }
+    }
+    return table;
+}
+
+//==============================================
+// STATIC MIB OVERLAY
+//==============================================
+
+/**
+ * @brief MibIntf decorator serving a compile-time table in front of a
+ * dynamic store. GETs on static objects are one perfect-hash probe, and
+ * their VarBinds are encoded once at construction (read_encoded), so the
+ * handler copies the answer without reading or encoding anything.
+ * Everything else goes to the wrapped store; read_next() and walk() merge
+ * both in OID order. Static objects are read-only. The table must outlive
+ * this object (declare it constexpr at namespace scope). Thread-safe when
+ * the wrapped store is.
+ */
+class StaticMib : public MibIntf {
+private:
+    MibIntf* inner;
+    StaticMibView table;
+    std::span<const StaticMibObject> objects;
+
+    std::vector<uint8_t> encoded;      // Every VarBind, back to back
+    std::vector<size_t> encoded_end;   // End offset of each object's VarBind
+
+    inline const StaticMibObject* find(const OID& oid) const {
+        size_t idx = table.find(oid.span(), oid.hash());
+        return idx < objects.size() ? &objects[idx] : nullptr;
+    }
+
+    /**
+     * @brief First static object after oid
+     */
+    inline size_t upper_bound(const OID& oid) const {
+        auto it = std::partition_point(objects.begin(), objects.end(), [&](const StaticMibObject& object) {
+            return static_oid_compare(object.oid.span(), oid.span()) <= 0;
+        });
+        return static_cast<size_t>(it - objects.begin());
+    }
+
+    inline bool is_static(const OID& oid, const char* operation) const {
+        if (!find(oid)) return false;
+        AZ_SNMP_LOG_FMT(WARN, os,
+            os << "[Static] " << operation << " ignored on static OID";
+            printOid(os, oid, " "));
+        return true;
+    }
+
+public:
+    template <size_t N>
+    StaticMib(const StaticMibTable<N>& static_table, MibIntf* mib)
+        : inner(mib), table(static_table.view()), objects(table.objects) {
+        BerWriter writer(256);
+        for (const StaticMibObject& object : objects) {
+            writer.reset();
+            writer.write_variant(object.value.to_variant());
+            writer.write_oid(object.oid.to_oid());
+            writer.close(DataType::SEQUENCE, 0);
+            encoded.insert(encoded.end(), writer.data().begin(), writer.data().end());
+            encoded_end.push_back(encoded.size());
+        }
+    }
+
+    inline size_t static_objects() const { return objects.size(); }
+
+    inline void create(const OID& oid, const SnmpVariant& value) override {
+        if (!is_static(oid, "create")) inner->create(oid, value);
+    }
+
+    inline SnmpVariant read(const OID& oid) override {
+        if (const StaticMibObject* object = find(oid)) return object->value.to_variant();
+        return inner->read(oid);
+    }
+
+    inline bool read_encoded(const OID& oid, const std::function<void(std::span<const uint8_t>)>& emit) override {
+        const StaticMibObject* object = find(oid);
+        if (!object) return inner->read_encoded(oid, emit);
+
+        size_t idx = static_cast<size_t>(object - objects.data());
+        size_t begin = idx == 0 ? 0 : encoded_end[idx - 1];
+        emit(std::span<const uint8_t>(encoded).subspan(begin, encoded_end[idx] - begin));
+        return true;
+    }
+
+    inline std::tuple<OID, SnmpVariant> read_next(const OID& oid) override {
+        auto [next, value] = inner->read_next(oid);
+        bool in_store = !(std::holds_alternative<ErrorCode>(value) && oid_compare(next, oid) <= 0);
+
+        size_t idx = upper_bound(oid);
+        if (idx < objects.size() && (!in_store || static_oid_compare(objects[idx].oid.span(), next.span()) < 0))
+            return {objects[idx].oid.to_oid(), objects[idx].value.to_variant()};
+        return {std::move(next), std::move(value)};
+    }
+
+    inline void update(const OID& oid, const SnmpVariant& value) override {
+        if (!is_static(oid, "update")) inner->update(oid, value);
+    }
+
+    inline void delete_oid(const OID& oid) override {
+        if (!is_static(oid, "delete")) inner->delete_oid(oid);
+    }
+
+    inline void apply_batch(std::span<const MibEntry> upserts, std::span<const OID> deletes = {}) override {
+        mib_forward_batch(inner, upserts, deletes, [this](const OID& oid, const char* operation) {
+            return is_static(oid, operation);
+        });
+    }
+
+    /**
+     * @brief Store walk with the static objects interleaved in order
+     */
+    inline void walk(const OID& start, const std::function<bool(const OID&, const SnmpVariant&)>& visit) override {
+        size_t idx = upper_bound(start);
+
+        // Visits static objects before limit (all when null)
+        auto visit_static = [&](const OID* limit) {
+            for (; idx < objects.size(); ++idx) {
+                if (limit && static_oid_compare(objects[idx].oid.span(), limit->span()) >= 0)
+                    return true;
+                if (!visit(objects[idx].oid.to_oid(), objects[idx].value.to_variant()))
+                    return false;
+            }
+            return true;
+        };
+
+        bool more = true;
+        inner->walk(start, [&](const OID& oid, const SnmpVariant& value) {
+            more = visit_static(&oid) && visit(oid, value);
+            return more;
+        });
+        if (more) visit_static(nullptr);
+    }
+};
+
+} //SnmpServer
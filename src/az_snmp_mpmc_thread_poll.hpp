@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_intfs.hpp"
+#include "az_snmp_mpmc_queue.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief ThreadPollIntf backed by a lock-free MPMC ring.
+ * Workers spin briefly when the ring is empty, then park on an atomic
+ * wait; producers only issue a wake (futex) when someone is parked.
+ * A full ring applies back-pressure: enqueue yields until a slot frees.
+ */
+class MpmcThreadPoll : public ThreadPollIntf {
+private:
+    static constexpr int SPIN_ROUNDS = 256;
+
+    // Spinning only pays off when producer and workers run on separate cores
+    const int spin_rounds = std::thread::hardware_concurrency() > 1 ? SPIN_ROUNDS : 0;
+
+    MpmcQueue<SnmpTask> tasks;
+    std::vector<std::thread> workers;
+
+    alignas(64) std::atomic<uint32_t> sleepers{0};
+    alignas(64) std::atomic<uint32_t> wake_signal{0};
+    std::atomic<bool> wake_pending{false};
+    std::atomic<bool> stop{false};
+
+    static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    /**
+     * @brief Wakes one parked worker unless a wake-up is already in flight.
+     * Parking workers clear wake_pending before their last queue check, so
+     * a skipped wake is always covered by a worker that will look again.
+     */
+    inline void wake_one() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) > 0 && !wake_pending.exchange(true)) {
+            wake_signal.fetch_add(1, std::memory_order_seq_cst);
+            wake_signal.notify_one();
+        }
+    }
+
+    // The main loop executed by each worker thread
+    inline void worker_loop() {
+        SnmpTask task;
+        while (true) {
+            bool found = false;
+            for (int i = 0; i < spin_rounds && !found; ++i) {
+                found = tasks.try_pop(task);
+                if (!found) cpu_relax();
+            }
+
+            if (!found) {
+                // Announce parking before the last check so a concurrent
+                // enqueue either sees us or we see its task
+                sleepers.fetch_add(1, std::memory_order_seq_cst);
+                wake_pending.store(false, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                uint32_t signal = wake_signal.load(std::memory_order_seq_cst);
+                found = tasks.try_pop(task);
+                if (!found) {
+                    if (stop.load(std::memory_order_seq_cst)) {
+                        sleepers.fetch_sub(1, std::memory_order_seq_cst);
+                        return;
+                    }
+                    wake_signal.wait(signal, std::memory_order_seq_cst);
+                    wake_pending.store(false, std::memory_order_seq_cst);
+                }
+                sleepers.fetch_sub(1, std::memory_order_seq_cst);
+            }
+
+            if (found) {
+                // Producers skip their wake while one is pending, so more
+                // work may be queued behind this task: pass the wake-up on
+                if (!tasks.empty()) wake_one();
+                // Execute the task (WorkerTask)
+                task();
+                task = nullptr;
+            }
+        }
+    }
+
+public:
+    MpmcThreadPoll(size_t threads, size_t queue_capacity = 4096) : tasks(queue_capacity) {
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this]{ this->worker_loop(); });
+        }
+    }
+
+    inline void enqueue(SnmpTask task) override {
+        if (stop.load(std::memory_order_relaxed))
+            throw std::runtime_error("ThreadPool cannot enqueue: already stopped.");
+
+        while (!tasks.try_push(task)) {
+            wake_one();
+            std::this_thread::yield();
+        }
+        wake_one();
+    }
+
+    inline ~MpmcThreadPoll() {
+        stop.store(true, std::memory_order_seq_cst);
+        wake_signal.fetch_add(1, std::memory_order_seq_cst);
+        wake_signal.notify_all();
+        for (std::thread& worker : workers)
+            if (worker.joinable()) worker.join();
+    }
+};
+
+} //SnmpServer
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <span>
+
+#include "az_snmp_simd.hpp"
+
+// Sub-identifiers stored without a heap allocation
+#ifndef AZ_SNMP_OID_INLINE_CAPACITY
+#define AZ_SNMP_OID_INLINE_CAPACITY 20
+#endif
+
+namespace SnmpServer {
+
+/**
+ * @brief Object identifier with inline storage.
+ * Up to INLINE_CAPACITY sub-identifiers live inside the object; longer OIDs
+ * spill to one heap block. A 64-bit hash is kept up to date on every
+ * mutation, so equality rejects most mismatches without touching the
+ * sub-identifiers and hashed containers never rehash the OID. Elements are
+ * read-only once stored (build with push_back or the constructors).
+ */
+class SnmpOid {
+public:
+    static constexpr size_t INLINE_CAPACITY = AZ_SNMP_OID_INLINE_CAPACITY;
+
+    using value_type = uint32_t;
+    using size_type = size_t;
+    using const_iterator = const uint32_t*;
+    using iterator = const_iterator;
+
+    static constexpr uint64_t HASH_SEED = 14695981039346656037ull; // FNV-1a
+    static constexpr uint64_t HASH_PRIME = 1099511628211ull;
+
+    /**
+     * @brief One hash step: hash() is the fold of mix over the sub-identifiers
+     * from HASH_SEED (constexpr for tables hashed at compile time)
+     */
+    static constexpr uint64_t mix(uint64_t hash, uint32_t subid) {
+        return (hash ^ subid) * HASH_PRIME;
+    }
+
+private:
+    union {
+        uint32_t inline_ids[INLINE_CAPACITY];
+        uint32_t* heap_ids;
+    };
+    uint32_t len = 0;
+    uint32_t cap = INLINE_CAPACITY;
+    uint64_t hash_value = HASH_SEED;
+
+    inline bool on_heap() const { return cap > INLINE_CAPACITY; }
+
+    inline uint32_t* ids() { return on_heap() ? heap_ids : inline_ids; }
+
+    inline void rehash() {
+        hash_value = HASH_SEED;
+        for (uint32_t subid : *this) hash_value = mix(hash_value, subid);
+    }
+
+    inline void release() {
+        if (on_heap()) delete[] heap_ids;
+        cap = INLINE_CAPACITY;
+    }
+
+    inline void assign(const uint32_t* src, size_t n) {
+        reserve(n);
+        std::copy(src, src + n, ids());
+        len = static_cast<uint32_t>(n);
+        rehash();
+    }
+
+public:
+    SnmpOid() noexcept {}
+
+    SnmpOid(std::initializer_list<uint32_t> subids) {
+        assign(subids.begin(), subids.size());
+    }
+
+    explicit SnmpOid(std::span<const uint32_t> subids) {
+        assign(subids.data(), subids.size());
+    }
+
+    template <typename It>
+    SnmpOid(It first, It last) {
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    SnmpOid(const SnmpOid& other) {
+        assign(other.data(), other.len);
+    }
+
+    SnmpOid(SnmpOid&& other) noexcept : len(other.len), cap(other.cap), hash_value(other.hash_value) {
+        if (other.on_heap()) {
+            heap_ids = other.heap_ids;
+            other.cap = INLINE_CAPACITY;
+        } else {
+            std::memcpy(inline_ids, other.inline_ids, len * sizeof(uint32_t));
+        }
+        other.len = 0;
+        other.hash_value = HASH_SEED;
+    }
+
+    SnmpOid& operator=(const SnmpOid& other) {
+        if (this != &other) assign(other.data(), other.len);
+        return *this;
+    }
+
+    SnmpOid& operator=(SnmpOid&& other) noexcept {
+        if (this == &other) return *this;
+        release();
+        len = other.len;
+        hash_value = other.hash_value;
+        if (other.on_heap()) {
+            heap_ids = other.heap_ids;
+            cap = other.cap;
+            other.cap = INLINE_CAPACITY;
+        } else {
+            std::memcpy(inline_ids, other.inline_ids, len * sizeof(uint32_t));
+        }
+        other.len = 0;
+        other.hash_value = HASH_SEED;
+        return *this;
+    }
+
+    ~SnmpOid() { release(); }
+
+    inline const uint32_t* data() const { return on_heap() ? heap_ids : inline_ids; }
+    inline size_t size() const { return len; }
+    inline bool empty() const { return len == 0; }
+    inline size_t capacity() const { return cap; }
+
+    /**
+     * @brief True while the sub-identifiers are stored inside the object
+     */
+    inline bool is_inline() const { return !on_heap(); }
+
+    inline const_iterator begin() const { return data(); }
+    inline const_iterator end() const { return data() + len; }
+
+    inline uint32_t operator[](size_t i) const { return data()[i]; }
+    inline uint32_t front() const { return data()[0]; }
+    inline uint32_t back() const { return data()[len - 1]; }
+
+    inline std::span<const uint32_t> span() const { return {data(), len}; }
+
+    /**
+     * @brief Hash of the sub-identifiers (maintained, not computed here)
+     */
+    inline uint64_t hash() const { return hash_value; }
+
+    inline void reserve(size_t n) {
+        if (n <= cap) return;
+        uint32_t* grown = new uint32_t[n];
+        std::copy(data(), data() + len, grown);
+        release();
+        heap_ids = grown;
+        cap = static_cast<uint32_t>(n);
+    }
+
+    inline void push_back(uint32_t subid) {
+        if (len == cap) reserve(cap * 2);
+        ids()[len++] = subid;
+        hash_value = mix(hash_value, subid);
+    }
+
+    /**
+     * @brief Replaces the contents: write(ids) stores at most n
+     * sub-identifiers at ids and returns how many it stored
+     */
+    template <typename Writer>
+    inline void assign_with(size_t n, Writer&& write) {
+        len = 0;
+        reserve(n);
+        len = static_cast<uint32_t>(write(ids()));
+        rehash();
+    }
+
+    inline void pop_back() {
+        --len;
+        rehash();
+    }
+
+    inline void clear() {
+        len = 0;
+        hash_value = HASH_SEED;
+    }
+
+    /**
+     * @brief Three-way comparison in SNMP order (sub-identifier by
+     * sub-identifier, a prefix sorts before its children)
+     */
+    inline int compare(const SnmpOid& other) const {
+        const uint32_t* a = data();
+        const uint32_t* b = other.data();
+        size_t n = std::min(len, other.len);
+        size_t i = subid_mismatch(a, b, n);
+        if (i < n) return (a[i] < b[i]) ? -1 : 1;
+        if (len == other.len) return 0;
+        return (len < other.len) ? -1 : 1;
+    }
+
+    /**
+     * @brief True when this OID lies under prefix (or equals it)
+     */
+    inline bool has_prefix(const SnmpOid& prefix) const {
+        return len >= prefix.len && subid_mismatch(data(), prefix.data(), prefix.len) == prefix.len;
+    }
+
+    friend inline bool operator==(const SnmpOid& a, const SnmpOid& b) {
+        return a.len == b.len && a.hash_value == b.hash_value &&
+               subid_mismatch(a.data(), b.data(), a.len) == a.len;
+    }
+
+    friend inline std::strong_ordering operator<=>(const SnmpOid& a, const SnmpOid& b) {
+        return a.compare(b) <=> 0;
+    }
+};
+
+} //SnmpServer
+
+template <>
+struct std::hash<SnmpServer::SnmpOid> {
+    size_t operator()(const SnmpServer::SnmpOid& oid) const noexcept {
+        return static_cast<size_t>(oid.hash());
+    }
+};
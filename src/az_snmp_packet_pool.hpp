@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_mpmc_queue.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief Fixed slab of packet contexts with pre-sized receive buffers.
+ * acquire() pops a free context (no allocation), and the PacketPtr puts it
+ * back when the worker is done with it, from whichever thread that is.
+ * When the slab is exhausted a heap context is handed out instead and the
+ * event is counted, so a burst degrades to the old behaviour, not to drops.
+ * The pool must outlive every packet it handed out.
+ */
+class PacketPool : public PacketPoolIntf {
+private:
+    std::unique_ptr<SnmpPacketContext[]> slab;
+    size_t slab_size;
+    size_t buffer_size;
+
+    MpmcQueue<SnmpPacketContext*> free_list;
+    std::atomic<uint64_t> exhausted_count{0};
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    explicit PacketPool(size_t capacity = DEFAULT_CAPACITY, size_t buffer = 1500)
+        : slab(new SnmpPacketContext[std::max<size_t>(capacity, 1)]),
+          slab_size(std::max<size_t>(capacity, 1)),
+          buffer_size(buffer),
+          free_list(std::max<size_t>(capacity, 1)) {
+        for (size_t i = 0; i < slab_size; ++i) {
+            SnmpPacketContext* context = &slab[i];
+            context->raw_data.resize(buffer_size);
+            context->owner = this;
+            free_list.try_push(context);
+        }
+    }
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator=(const PacketPool&) = delete;
+
+    /**
+     * @brief Context whose raw_data spans the full receive buffer
+     */
+    inline PacketPtr acquire() {
+        SnmpPacketContext* context = nullptr;
+        if (free_list.try_pop(context)) {
+            // Capacity is kept across uses: this never reallocates
+            context->raw_data.resize(buffer_size);
+            context->received_at = {};
+            context->socket_fd = -1;
+            return PacketPtr(context);
+        }
+
+        exhausted_count.fetch_add(1, std::memory_order_relaxed);
+        auto fallback = new SnmpPacketContext();
+        fallback->raw_data.resize(buffer_size);
+        return PacketPtr(fallback);
+    }
+
+    inline void release(SnmpPacketContext* context) override {
+        // Every slab context has a reserved cell: the push cannot fail
+        free_list.try_push(context);
+    }
+
+    inline size_t capacity() const { return slab_size; }
+
+    /**
+     * @brief Number of acquire() calls served from the heap
+     */
+    inline uint64_t exhausted() const { return exhausted_count.load(std::memory_order_relaxed); }
+};
+
+} //SnmpServer
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstring>
 #include <iostream>
 #include <optional>
 
 #include "az_snmp_global.hpp"
+#include "az_snmp_intfs.hpp"
+#include "az_snmp_ber.hpp"
+#include "az_snmp_stats.hpp"
+#include "az_snmp_trace.hpp"
 
 namespace SnmpServer {
 
@@ -13,11 +18,18 @@ namespace SnmpServer {
 class SnmpProtocolHandler {
 private:
     MibIntf* mib_service;
+    size_t max_response_size;
 
 public:
+    // 1500-byte Ethernet MTU minus the IPv4 and UDP headers
+    static constexpr size_t MAX_RESPONSE_SIZE = 1472;
 
-    SnmpProtocolHandler(MibIntf* mib_ptr) {
+    // Room left in front of GETBULK varbinds for the message headers
+    static constexpr size_t BULK_HEADROOM = 64;
+
+    SnmpProtocolHandler(MibIntf* mib_ptr, size_t max_response = MAX_RESPONSE_SIZE) {
         mib_service = mib_ptr;
+        max_response_size = max_response;
     }
 
     //==============================================
@@ -25,194 +37,128 @@ public:
     //==============================================
 
     /**
-     * @brief String value parser
-     */
-    inline std::string parseOctetString(const std::vector<uint8_t>& raw_data, const uint8_t len,  size_t& index) {
-        std::string result(reinterpret_cast<const char*>(&raw_data[index]), len);
-        index += len;
-        return result;
-    }
-
-    /**
-     * @brief Integral value parser
+     * @brief TLV processor (zero-copy, long form lengths, bounds checked)
      */
-    inline int parseInt(const std::vector<uint8_t>& raw_data, const uint8_t len, size_t& index) {
-        int value = 0;
-        for (int i = 0; i < len; ++i) {
-            value = (value << 8) | raw_data[index++];
+    inline std::optional<BerTlv> readTlv(std::span<const uint8_t> raw_data, size_t& index) {
+        auto tlv = readBerTlv(raw_data, index);
+        if (!tlv) {
+            AZ_SNMP_LOG(WARN, "[Decode] truncated or malformed TLV at index " << index);
+            return std::nullopt;
         }
-        return value;
+
+        AZ_SNMP_LOG_FMT(TRACE, os, printTlv(os, tlv->tag, tlv->value.size(), "[Decode] "));
+
+        return tlv;
     }
 
     /**
-     * @brief Object Identifier parser
+     * @brief Reads a TLV and checks its tag
      */
-    inline OID parseOid(const std::vector<uint8_t>& raw_data, const uint8_t len, size_t& index) {
-        OID oid;
-        uint8_t first = raw_data[index++];
-        oid.push_back(first / 40);
-        oid.push_back(first % 40);
-
-        size_t end = index + (len - 1);
-        while (index < end) {
-            uint32_t subid = 0;
-            while (true) {
-                uint8_t byte = raw_data[index++];
-                subid = (subid << 7) | (byte & 0x7F);
-                if ((byte & 0x80) == 0) break;
-            }
-            oid.push_back(subid);
-        }
-
-        return oid;
+    inline std::optional<BerTlv> expectTlv(std::span<const uint8_t> raw_data, size_t& index, DataType type) {
+        auto tlv = readTlv(raw_data, index);
+        if (!tlv || tlv->tag != static_cast<uint8_t>(type))
+            return std::nullopt;
+        return tlv;
     }
 
     /**
-     * @brief TLV processor
+     * @brief Reads an INTEGER TLV
      */
-    inline std::tuple<std::optional<DataType>, uint8_t, SnmpVariant> readTlv(const std::vector<uint8_t>& raw_data, size_t& index) {
-
-        std::optional<DataType> type {std::nullopt};
-        uint8_t len{0u};
-        SnmpVariant value{};
-
-        if (raw_data.size() == 0 || index > raw_data.size()) {
-            std::cerr << "Erro: buffer is empty or invalid index\n";
-            return {type, len, value};
-        }
-
-        std::cerr << "[Decode] start readTlv index " << index << "\n";
-
-        switch (raw_data[index++]) {
-            case 0x02: type = DataType::INTEGER;          break;
-            case 0x04: type = DataType::OCTET_STRING;     break;
-            case 0x05: type = DataType::VAL_NULL;         break;
-            case 0x06: type = DataType::OBJECT_ID;        break;
-            case 0x30: type = DataType::SEQUENCE;         break;
-            case 0xA0: type = DataType::GET_REQUEST;      break;
-            case 0xA1: type = DataType::GET_NEXT_REQUEST; break;
-            case 0xA2: type = DataType::GET_RESPONSE;     break;
-            case 0xA3: type = DataType::SET_REQUEST;      break;
-            case 0xA4: type = DataType::TRAP;             break;
-            default:   type = std::nullopt;               break;
-        }
-
-        len = static_cast<uint8_t>(raw_data[index++]);
-
-        std::string debugType{""};
-
-        switch(*type) {
-            case DataType::INTEGER:
-                debugType = "DataType::INTEGER";
-                value = parseInt(raw_data, len, index);
-            break;
-            case DataType::OCTET_STRING:
-                debugType = "DataType::OCTET_STRING";
-                value = parseOctetString(raw_data, len, index);
-            break;
-            case DataType::VAL_NULL:
-                debugType = "DataType::VAL_NULL";
-            break;
-            case DataType::OBJECT_ID:
-                debugType = "DataType::OBJECT_ID";
-                value = parseOid(raw_data, len, index);
-            break;
-            case DataType::SEQUENCE:
-                debugType = "DataType::SEQUENCE";
-            break;
-            case DataType::GET_REQUEST:
-                debugType = "DataType::GET_REQUEST";
-                value = "GET_REQUEST";
-            break;
-            case DataType::GET_NEXT_REQUEST:
-                debugType = "DataType::GET_NEXT_REQUEST";
-                value  = "GET_NEXT_REQUEST";
-            break;
-            case DataType::SET_REQUEST:
-                debugType = "DataType::SET_REQUEST";
-                value  = "SET_REQUEST";
-            break;
-        }
-
-        printTlv({type, len, value}, "[Decode] ", true);
-
-        return {type, len, value};
+    inline std::optional<int64_t> expectInt(std::span<const uint8_t> raw_data, size_t& index) {
+        auto tlv = expectTlv(raw_data, index, DataType::INTEGER);
+        if (!tlv) return std::nullopt;
+        return parseInt(tlv->value);
     }
 
     /**
-     * @brief Internal vars data parser
+     * @brief Internal var (VarBind) data parser
      */
-    inline bool process_oid_sequence(const std::vector<uint8_t>& raw_data, SnmpPdu& data, size_t& index) {
-        std::cout << "[Decode] start process_oid_sequence" << " index:" << index << "\n";
-
-        if (raw_data.size() == 0) {
-            std::cerr << "Erro: buffer is empty or invalid index\n";
+    inline bool process_oid_sequence(std::span<const uint8_t> raw_data, SnmpPdu& data, size_t& index) {
+        auto varbind = expectTlv(raw_data, index, DataType::SEQUENCE);
+        if (!varbind)
             return false;
-        }
-        if (index > raw_data.size())
-            return true;
 
-        SnmpValue var{};
-        std::optional<DataType> type{};
-        uint8_t len{};
-        SnmpVariant value{};
-
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type!=DataType::SEQUENCE)
-            return false;
+        size_t pos = 0;
 
         // OID
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::OBJECT_ID)
-            var.oid = std::get<OID>(value);
-        else
+        auto oid_tlv = expectTlv(varbind->value, pos, DataType::OBJECT_ID);
+        if (!oid_tlv)
+            return false;
+        auto oid = parseOid(oid_tlv->value);
+        if (!oid)
             return false;
 
         // value
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::VAL_NULL)
-            var.value = std::monostate{};
-        else if(type && *type == DataType::INTEGER)
-            var.value  = std::get<int64_t>(value);
-        else if(type && *type == DataType::OCTET_STRING)
-            var.value = std::get<std::string>(value);
-        else
+        auto val_tlv = readTlv(varbind->value, pos);
+        if (!val_tlv)
             return false;
 
-        data.vars.push_back(var);
+        // String values allocate from the PDU's resource (the request arena)
+        SnmpValue& var = data.vars.emplace_back();
+        std::pmr::polymorphic_allocator<> alloc = data.vars.get_allocator();
+        var.oid = oid->to_oid();
+        // Tags the variant does not tell apart (Counter32 from INTEGER...)
+        if (val_tlv->tag >= static_cast<uint8_t>(DataType::IP_ADDRESS)) var.type = val_tlv->tag;
 
-         // Vars
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::SEQUENCE) {
-            index -= 2;
-            process_var_sequence(raw_data, data, index);
+        switch (static_cast<DataType>(val_tlv->tag)) {
+            case DataType::VAL_NULL:
+                var.value = std::monostate{};
+            break;
+            case DataType::INTEGER:
+            case DataType::COUNTER32:
+            case DataType::GAUGE32:
+            case DataType::TIME_TICKS:
+            case DataType::COUNTER64: {
+                // Unsigned 64-bit counters carry a leading zero byte
+                std::span<const uint8_t> digits = val_tlv->value;
+                if (digits.size() == 9 && digits[0] == 0) digits = digits.subspan(1);
+                auto num = parseInt(digits);
+                if (!num) return false;
+                var.value = *num;
+            } break;
+            case DataType::OCTET_STRING:
+            case DataType::IP_ADDRESS:
+                var.value.emplace<std::pmr::string>(parseOctetString(val_tlv->value), alloc);
+            break;
+            case DataType::NO_SUCH_NAME:
+            case DataType::NO_SUCH_OBJECT:
+            case DataType::END_OF_MIB_VIEW:
+                // Exceptions in responses (see write_error)
+                var.value = static_cast<ErrorCode>(val_tlv->tag);
+            break;
+            case DataType::OBJECT_ID: {
+                auto val_oid = parseOid(val_tlv->value);
+                if (!val_oid) return false;
+                var.value.emplace<OID>(val_oid->to_oid());
+            } break;
+            default:
+                return false;
         }
 
         return true;
     }
 
     /**
-     * @brief Internal vars data parser
+     * @brief Internal vars (VarBindList) data parser
      */
-    inline bool process_var_sequence(const std::vector<uint8_t>& raw_data, SnmpPdu& data, size_t& index) {
-        std::cout << "[Decode] start process_var_sequence" << " index:" << index << "\n";
-
-        if (raw_data.size() == 0) {
-            std::cerr << "Erro: buffer is empty or invalid index\n";
+    inline bool process_var_sequence(std::span<const uint8_t> raw_data, SnmpPdu& data, size_t& index) {
+        auto list = expectTlv(raw_data, index, DataType::SEQUENCE);
+        if (!list)
             return false;
+        data.raw_vars = list->value;
+
+        // Count varbinds first so the vector is allocated once
+        size_t count = 0;
+        for (size_t pos = 0; pos < list->value.size(); ++count) {
+            if (!readBerTlv(list->value, pos))
+                return false;
         }
-        if (index > raw_data.size())
-            return true;
-
-        SnmpValue var{};
-        std::optional<DataType> type{};
-        uint8_t len{};
-        SnmpVariant value{};
-
-         // Vars
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::SEQUENCE) {
-             process_oid_sequence(raw_data, data, index);
+        data.vars.reserve(count);
+
+        size_t pos = 0;
+        while (pos < list->value.size()) {
+            if (!process_oid_sequence(list->value, data, pos))
+                return false;
         }
 
         return true;
@@ -220,171 +166,302 @@ public:
 
     /**
      * @brief Data frame parser
+     * @param response Accept a GET_RESPONSE PDU instead of a request
      */
-    inline bool process_pdu_sequence(const std::vector<uint8_t>& raw_data, SnmpPdu& data, size_t& index) {
-        std::cout << "[Decode] start process_pdu_sequence" << " index:" << index << "\n";
+    inline bool process_pdu_sequence(std::span<const uint8_t> raw_data, SnmpPdu& data, size_t& index, bool response = false) {
+        AZ_SNMP_LOG(DEBUG, "[Decode] start process_pdu_sequence" << " index:" << index);
 
         if (raw_data.size() == 0) {
-            std::cerr << "Erro: buffer is empty or invalid index\n";
+            AZ_SNMP_LOG(WARN, "[Decode] buffer is empty or invalid index");
             return false;
         }
-        if (index > raw_data.size())
-            return true;
-
-        print_hex_buffer(raw_data, "process_pdu_sequence >> ");
 
-        std::optional<DataType> type{};
-        uint8_t len{};
-        SnmpVariant value{};
+        AZ_SNMP_LOG_FMT(DEBUG, os, print_hex_buffer(os, raw_data, "process_pdu_sequence >> "));
 
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type!=DataType::SEQUENCE)
+        auto message = expectTlv(raw_data, index, DataType::SEQUENCE);
+        if (!message)
             return false;
 
+        std::span<const uint8_t> body = message->value;
+        size_t pos = 0;
+
         // Version
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::INTEGER)
-            data.version = std::get<int64_t>(value);
-        else
+        auto version = expectInt(body, pos);
+        if (!version)
             return false;
+        data.version = *version;
 
         // Community
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::OCTET_STRING)
-            data.community = std::get<std::string>(value);
-        else
+        auto community = expectTlv(body, pos, DataType::OCTET_STRING);
+        if (!community)
             return false;
+        data.community = parseOctetString(community->value);
 
         // Command
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::GET_REQUEST || type == DataType::GET_NEXT_REQUEST || type == DataType::SET_REQUEST)
-            data.command = std::get<std::string>(value);
-        else
+        auto command = readTlv(body, pos);
+        if (!command)
+            return false;
+        DataType cmd_type = static_cast<DataType>(command->tag);
+        bool request = cmd_type == DataType::GET_REQUEST || cmd_type == DataType::GET_NEXT_REQUEST ||
+                       cmd_type == DataType::SET_REQUEST || cmd_type == DataType::GET_BULK_REQUEST;
+        if (response ? cmd_type != DataType::GET_RESPONSE : !request)
             return false;
+        data.command = DataTypeToString(cmd_type);
+
+        std::span<const uint8_t> pdu_body = command->value;
+        pos = 0;
 
         // Req_id
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::INTEGER)
-            data.req_id  = std::get<int64_t>(value);
-        else
+        auto req_id = expectInt(pdu_body, pos);
+        if (!req_id)
             return false;
+        data.req_id = *req_id;
 
-        // Err_status
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::INTEGER)
-            data.err_status  = std::get<int64_t>(value);
-        else
+        // Err_status (non-repeaters for GETBULK)
+        auto err_status = expectInt(pdu_body, pos);
+        if (!err_status)
             return false;
+        data.err_status = *err_status;
 
-        // Err_idx
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::INTEGER)
-            data.err_idx = std::get<int64_t>(value);
-        else
+        // Err_idx (max-repetitions for GETBULK)
+        auto err_idx = expectInt(pdu_body, pos);
+        if (!err_idx)
             return false;
+        data.err_idx = *err_idx;
 
         // Vars
-        std::tie(type, len, value) = readTlv(raw_data, index);
-        if(type && *type == DataType::SEQUENCE) {
-            index -= 2;
-            process_var_sequence(raw_data, data, index);
-        }
+        if (!process_var_sequence(pdu_body, data, pos))
+            return false;
 
-        printSnmpPdu(data);
+        AZ_SNMP_LOG_FMT(DEBUG, os, printSnmpPdu(os, data));
 
         return true;
     }
 
     /**
      * @brief protocol parsing
+     * @param alloc Resource for everything the PDU owns (e.g. a RequestArena)
+     * @return nullopt when the datagram is not a well-formed request
+     * (counted in DECODE_ERRORS): it must be dropped, not answered
      */
-    inline SnmpPdu process_request(const std::vector<uint8_t>& raw_data) {
-        std::cout << "[Decode] start process_request\n";
+    inline std::optional<SnmpPdu> process_request(std::span<const uint8_t> raw_data,
+                                                  const SnmpPdu::allocator_type& alloc = {}) {
+        AZ_SNMP_LOG(TRACE, "[Decode] start process_request");
 
-        SnmpPdu data{};
+        std::optional<SnmpPdu> data(std::in_place, alloc);
         size_t index = {0};
-        process_pdu_sequence(raw_data, data, index);
+        if (!process_pdu_sequence(raw_data, *data, index)) {
+            stat_count(StatCounter::DECODE_ERRORS);
+            return std::nullopt;
+        }
 
         return data;
     }
 
+    /**
+     * @brief Response parsing (manager side, see SnmpManager). Application
+     * types and exceptions keep their wire tag in SnmpValue::type (Counter32
+     * and TimeTicks values are INTEGERs in the variant)
+     * @return nullopt when the datagram is not a well-formed GET_RESPONSE
+     */
+    inline std::optional<SnmpPdu> process_response(std::span<const uint8_t> raw_data,
+                                                   const SnmpPdu::allocator_type& alloc = {}) {
+        std::optional<SnmpPdu> data(std::in_place, alloc);
+        size_t index = {0};
+        if (!process_pdu_sequence(raw_data, *data, index, true))
+            return std::nullopt;
+        return data;
+    }
+
 
     //==============================================
     // ENCODING
     //==============================================
+
     /**
-    * Encodes an INTEGER
-    */
-    inline std::vector<uint8_t> encodeInteger(int value) {
-        std::vector<uint8_t> out;
-        out.push_back(0x02); // INTEGER tag
-        out.push_back(4);    // length (4 bytes)
-        out.push_back((value >> 24) & 0xFF);
-        out.push_back((value >> 16) & 0xFF);
-        out.push_back((value >> 8) & 0xFF);
-        out.push_back(value & 0xFF);
-        return out;
+     * @brief Encodes one VarBind (OID + value read from the MIB)
+     */
+    inline void write_varbind(BerWriter& writer, DataType cmd_type, const OID& req_oid) {
+        size_t start = writer.mark();
+
+        // Read value from the MIB (via injected interface)
+        if(cmd_type == DataType::GET_REQUEST) {
+            MibStageClock::Scope mib_time;
+            // Pre-encoded answer spliced as is
+            if (mib_service->read_encoded(req_oid, [&writer](std::span<const uint8_t> varbind) { writer.put_bytes(varbind); }))
+                return;
+            SnmpVariant mib_value = mib_service->read(req_oid);
+            mib_time.stop();
+
+            AZ_SNMP_LOG_FMT(DEBUG, os,
+                printOid(os, req_oid, "[Encode] MIB READ OID: ");
+                printVariant(os, mib_value, " Value: "));
+
+            writer.write_variant(mib_value);
+            writer.write_oid(req_oid);
+
+        } else if(cmd_type == DataType::GET_NEXT_REQUEST) {
+            MibStageClock::Scope mib_time;
+            auto [next_oid, mib_value] = mib_service->read_next(req_oid);
+            mib_time.stop();
+
+            AZ_SNMP_LOG_FMT(DEBUG, os,
+                printOid(os, next_oid, "[Encode] MIB READ_NEXT OID: ");
+                printVariant(os, mib_value, " Value: "));
+
+            writer.write_variant(mib_value);
+            writer.write_oid(next_oid);
+        }
+        else {
+            AZ_SNMP_LOG(WARN, "[Encode] Invalid command");
+            writer.write_null();
+            writer.write_oid(req_oid);
+        }
+
+        writer.close(DataType::SEQUENCE, start);
     }
 
+    //==============================================
+    // GETBULK
+    //==============================================
+
     /**
-    * @brief Encodes an OCTET STRING
-    */
-    inline std::vector<uint8_t> encodeOctetString(const std::string& s) {
-        std::vector<uint8_t> out;
-        out.push_back(0x04); // OCTET STRING tag
-        out.push_back(static_cast<uint8_t>(s.size()));
-        out.insert(out.end(), s.begin(), s.end());
-        return out;
+     * @brief One varbind, encoded into a thread-local scratch buffer
+     */
+    static inline std::span<const uint8_t> encode_varbind(const OID& oid, const SnmpVariant& value) {
+        thread_local BerWriter scratch(256);
+        scratch.reset();
+        scratch.write_variant(value);
+        scratch.write_oid(oid);
+        scratch.close(DataType::SEQUENCE, 0);
+        return scratch.data();
     }
 
     /**
-    * @brief @brief Encodes an NULL
-    */
-    inline std::vector<uint8_t> encodeNull() {
-        return {0x05, 0x00};
+     * @brief Size of the whole response message around body_len bytes of varbinds
+     */
+    inline size_t response_size(const SnmpPdu& pdu, size_t body_len) const {
+        size_t list = 1 + ber_length_size(body_len) + body_len;
+        size_t content = list + 2 * ber_integer_size(0) + ber_integer_size(static_cast<int32_t>(pdu.req_id));
+        size_t message = 1 + ber_length_size(content) + content
+                       + ber_integer_size(pdu.version)
+                       + 1 + ber_length_size(pdu.community.size()) + pdu.community.size();
+        return 1 + ber_length_size(message) + message;
     }
 
     /**
-    * @brief @brief Encodes an NULL
-    */
-    inline std::vector<uint8_t> encodeError(ErrorCode errorId) {
-        return {errorId, 0x00};
+     * @brief Encodes one varbind after those already in writer, unless the
+     * response would outgrow max_response_size. Returns false when full.
+     */
+    inline bool append_varbind(BerWriter& writer, const SnmpPdu& pdu, const OID& oid, const SnmpVariant& value) {
+        // Called from MIB walks: encoding is not MIB time
+        MibStageClock::Pause encoding;
+        std::span<const uint8_t> varbind = encode_varbind(oid, value);
+
+        if (response_size(pdu, writer.mark() + varbind.size()) > max_response_size)
+            return false;
+        writer.append(varbind);
+        return true;
     }
 
     /**
-    * @brief Encodes an OID
-    */
-    inline std::vector<uint8_t> encodeOid(const OID& oid) {
-        std::vector<uint8_t> out;
-        out.push_back(0x06); // OBJECT IDENTIFIER tag
-
-        std::vector<uint8_t> body;
-        if (oid.size() >= 2) {
-            body.push_back(oid[0] * 40 + oid[1]); // ASN.1 role
-            for (size_t i = 2; i < oid.size(); ++i) {
-                body.push_back(static_cast<uint8_t>(oid[i]));
-            }
-        }
-        out.push_back(static_cast<uint8_t>(body.size()));
-        out.insert(out.end(), body.begin(), body.end());
-        return out;
+     * @brief Same limit as append_varbind, for responses encoded later
+     * (see AsyncWorkerTask): adds the varbind's size to body_len unless
+     * the response would outgrow max_response_size. Returns false when full.
+     */
+    inline bool reserve_varbind(size_t& body_len, const SnmpPdu& pdu, const OID& oid, const SnmpVariant& value) const {
+        size_t size = encode_varbind(oid, value).size();
+        if (response_size(pdu, body_len + size) > max_response_size)
+            return false;
+        body_len += size;
+        return true;
     }
 
     /**
-    * @brief Function to encapsulate SEQUENCE
-    */
-    inline std::vector<uint8_t> encodeSequence(const std::vector<uint8_t>& content) {
-        std::vector<uint8_t> out;
-        out.push_back(0x30); // SEQUENCE tag
-        out.push_back(static_cast<uint8_t>(content.size()));
-        out.insert(out.end(), content.begin(), content.end());
-        return out;
+     * @brief GETBULK varbinds (RFC 3416 4.2.3), encoded in order as the MIB
+     * is read and truncated once the response is full.
+     */
+    inline void write_bulk_varbinds(BerWriter& writer, const SnmpPdu& pdu) {
+        MibStageClock::Scope mib_time;
+        const SnmpVariant end_of_mib = static_cast<ErrorCode>(DataType::END_OF_MIB_VIEW);
+        size_t non_repeaters = std::min<size_t>(pdu.err_status, pdu.vars.size());
+        size_t repeaters = pdu.vars.size() - non_repeaters;
+        size_t max_repetitions = pdu.err_idx;
+
+        // Non-repeaters: one GETNEXT each
+        for (size_t i = 0; i < non_repeaters; ++i) {
+            bool found = false;
+            bool fits = true;
+            mib_service->walk(pdu.vars[i].oid, [&](const OID& oid, const SnmpVariant& value) {
+                found = true;
+                fits = append_varbind(writer, pdu, oid, value);
+                return false;
+            });
+            if (!found) fits = append_varbind(writer, pdu, pdu.vars[i].oid, end_of_mib);
+            if (!fits) return;
+        }
+
+        if (repeaters == 0 || max_repetitions == 0) return;
+
+        thread_local OID last;
+        if (repeaters == 1) {
+            // Table walk: a single forward scan of the MIB into the response
+            last = pdu.vars[non_repeaters].oid;
+            size_t count = 0;
+            bool fits = true;
+            mib_service->walk(last, [&](const OID& oid, const SnmpVariant& value) {
+                fits = append_varbind(writer, pdu, oid, value);
+                if (!fits) return false;
+                last = oid;
+                return ++count < max_repetitions;
+            });
+            if (fits && count < max_repetitions)
+                append_varbind(writer, pdu, last, end_of_mib);
+            return;
+        }
+
+        // Several repeaters: rows interleave, one GETNEXT per column per row
+        std::vector<OID> cursors;
+        cursors.reserve(repeaters);
+        for (size_t r = 0; r < repeaters; ++r)
+            cursors.push_back(pdu.vars[non_repeaters + r].oid);
+        std::vector<bool> ended(repeaters, false);
+
+        for (size_t rep = 0; rep < max_repetitions; ++rep) {
+            bool all_ended = true;
+            for (size_t r = 0; r < repeaters; ++r) {
+                bool fits = true;
+                if (!ended[r]) {
+                    bool found = false;
+                    mib_service->walk(cursors[r], [&](const OID& oid, const SnmpVariant& value) {
+                        found = true;
+                        fits = append_varbind(writer, pdu, oid, value);
+                        last = oid;
+                        return false;
+                    });
+                    if (found) cursors[r] = last;
+                    else ended[r] = true;
+                }
+                if (ended[r]) fits = append_varbind(writer, pdu, cursors[r], end_of_mib);
+                if (!fits) return;
+                all_ended = all_ended && ended[r];
+            }
+            if (all_ended) return;
+        }
     }
 
     /**
-     * @brief Build a SNMP buffer from a SnmpPdu
+     * @brief Encodes the VarBindList SEQUENCE of the response alone into
+     * writer. GETBULK varbinds are appended in order after some headroom
+     * (see write_bulk_varbinds), the others are written back to front.
      */
-    inline std::vector<uint8_t> buildSnmpPdu(const SnmpPdu& pdu) {
+    inline void write_varbind_list(const SnmpPdu& pdu, BerWriter& writer) {
+        if(pdu.command == DataTypeToString(DataType::GET_BULK_REQUEST)) {
+            writer.reset_forward(BULK_HEADROOM + pdu.community.size());
+            write_bulk_varbinds(writer, pdu);
+            writer.close(DataType::SEQUENCE, 0);
+            return;
+        }
 
         DataType cmd_type{DataType::VAL_NULL};
         if(pdu.command == DataTypeToString(DataType::GET_REQUEST)) {
@@ -393,97 +470,194 @@ public:
             cmd_type = DataType::GET_NEXT_REQUEST;
         }
 
-        std::vector<uint8_t> version = encodeInteger(pdu.version);
-        std::vector<uint8_t> community = encodeOctetString(pdu.community);
-
-        // Request ID, Error Status, Error Index
-        std::vector<uint8_t> reqId = encodeInteger(pdu.req_id);
-        std::vector<uint8_t> errStatus = encodeInteger(pdu.err_status);
-        std::vector<uint8_t> errIdx = encodeInteger(pdu.err_idx);
-
-        // VarBindList
-        std::vector<uint8_t> varbindsContent;
-        for (const auto& var : pdu.vars) {
-            // Read value from the MIB (via injected interface)
-            std::vector<uint8_t> oid{};
-            SnmpVariant mib_value{};
-            if(cmd_type == DataType::GET_REQUEST) {
-                mib_value = mib_service->read(var.oid);
-                oid = encodeOid(var.oid);
-
-                printOid(var.oid, "[Encode] MIB READ_NEXT OID: ", true);
-                printVariant(mib_value, "[Encode] MIB READ Value: ", true);
-
-            } else if(cmd_type == DataType::GET_NEXT_REQUEST) {
-                auto tmp_var = mib_service->read_next(var.oid);
-                auto tmp_oid = std::get<0>(tmp_var);
-                mib_value = std::get<1>(tmp_var);
-                oid = encodeOid(tmp_oid);
-
-                printOid(tmp_oid, "[Encode] MIB READ_NEXT OID: ", true);
-                printVariant(mib_value, "[Encode] MIB READ_NEXT Value: ", true);
-            }
-            else {
-                std::cout << "[Encode] Invalid command\n";
-            }
+        writer.reset();
 
-            std::vector<uint8_t> val = encodeNull();
-
-            if (std::holds_alternative<std::monostate>(mib_value)) {
-                val = encodeNull();
-            } else if (std::holds_alternative<int64_t>(mib_value)) {
-                val = encodeInteger(std::get<int64_t>(mib_value));
-            } else if (std::holds_alternative<std::string>(mib_value)) {
-                val = encodeOctetString(std::get<std::string>(mib_value));
-            } else if (std::holds_alternative<OID>(mib_value)) {
-                val = encodeOid(std::get<OID>(mib_value));
-            } else if (std::holds_alternative<ErrorCode>(mib_value)) {
-                val = encodeError(std::get<ErrorCode>(mib_value));
-            } else {
-                std::cout << "[Encode] Invalid value\n";
-            }
+        // Last varbind first
+        for (auto it = pdu.vars.rbegin(); it != pdu.vars.rend(); ++it)
+            write_varbind(writer, cmd_type, it->oid);
+        writer.close(DataType::SEQUENCE, 0);
+    }
 
-            std::vector<uint8_t> vbContent;
-            vbContent.insert(vbContent.end(), oid.begin(), oid.end());
-            vbContent.insert(vbContent.end(), val.begin(), val.end());
-            std::vector<uint8_t> vb = encodeSequence(vbContent);
-            varbindsContent.insert(varbindsContent.end(), vb.begin(), vb.end());
+    /**
+     * @brief Encodes a VarBindList of the given values (requests and
+     * traps: nothing is read from the MIB)
+     */
+    template <typename Vars>
+    inline void write_given_varbinds(const Vars& vars, BerWriter& writer) {
+        for (auto it = vars.rbegin(); it != vars.rend(); ++it) {
+            size_t start = writer.mark();
+            writer.write_variant(it->value);
+            writer.write_oid(it->oid);
+            writer.close(DataType::SEQUENCE, start);
         }
-        std::vector<uint8_t> varbindList = encodeSequence(varbindsContent);
+        writer.close(DataType::SEQUENCE, 0);
+    }
+
+    /**
+     * @brief Prepends a pdu_type PDU and the message headers to the
+     * VarBindList in writer
+     */
+    inline std::span<const uint8_t> write_headers(const SnmpPdu& pdu, DataType pdu_type,
+                                                  uint32_t err_status, uint32_t err_idx, BerWriter& writer) {
+        // Error Index, Error Status
+        writer.write_integer(err_idx);
+        writer.write_integer(err_status);
+
+        // Request ID (Integer32 on the wire)
+        writer.write_integer(static_cast<int32_t>(pdu.req_id));
 
         // Command PDU
-        std::vector<uint8_t> cmdContent;
-        cmdContent.insert(cmdContent.end(), reqId.begin(), reqId.end());
-        cmdContent.insert(cmdContent.end(), errStatus.begin(), errStatus.end());
-        cmdContent.insert(cmdContent.end(), errIdx.begin(), errIdx.end());
-        cmdContent.insert(cmdContent.end(), varbindList.begin(), varbindList.end());
-
-        std::vector<uint8_t> command;
-        if(cmd_type == DataType::GET_REQUEST || cmd_type == DataType::GET_NEXT_REQUEST)
-            command.push_back(static_cast<uint8_t>(DataType::GET_RESPONSE));
-        command.push_back(static_cast<uint8_t>(cmdContent.size()));
-        command.insert(command.end(), cmdContent.begin(), cmdContent.end());
+        writer.close(pdu_type, 0);
+
+        writer.write_octet_string(pdu.community);
+        writer.write_integer(pdu.version);
 
         // SNMP Message (SEQUENCE)
-        std::vector<uint8_t> messageContent;
-        messageContent.insert(messageContent.end(), version.begin(), version.end());
-        messageContent.insert(messageContent.end(), community.begin(), community.end());
-        messageContent.insert(messageContent.end(), command.begin(), command.end());
+        writer.close(DataType::SEQUENCE, 0);
 
-        return encodeSequence(messageContent);
+        return writer.data();
     }
 
     /**
-     * @brief Simulates building the RESPONSE PDU and BER serialization
+     * @brief Prepends the PDU and message headers to the VarBindList in writer
      */
-    inline std::vector<uint8_t> resp_get(const SnmpPdu& pdu) {
+    inline std::span<const uint8_t> write_response_headers(const SnmpPdu& pdu, BerWriter& writer) {
+        // GETBULK: always 0, oversized responses are truncated
+        bool bulk = pdu.command == DataTypeToString(DataType::GET_BULK_REQUEST);
+        return write_headers(pdu, DataType::GET_RESPONSE, bulk ? 0 : pdu.err_status, bulk ? 0 : pdu.err_idx, writer);
+    }
 
-        auto packet = buildSnmpPdu(pdu);
+    /**
+     * @brief Encodes pdu as a request (manager side): command is GET, GETNEXT,
+     * GETBULK or SET, the varbind values are sent as they are (NULL for
+     * reads). For GETBULK, err_status and err_idx hold non-repeaters and
+     * max-repetitions. The span is valid until the writer is reset or reused.
+     */
+    inline std::span<const uint8_t> build_request(const SnmpPdu& pdu, DataType command, BerWriter& writer) {
+        writer.reset();
+        write_given_varbinds(pdu.vars, writer);
+        return write_headers(pdu, command, pdu.err_status, pdu.err_idx, writer);
+    }
+
+    /**
+     * @brief Encodes an SNMPv1 Trap-PDU message. The span is valid until
+     * the writer is reset or reused.
+     */
+    inline std::span<const uint8_t> build_trap(const SnmpTrap& trap, std::string_view community, BerWriter& writer) {
+        writer.reset();
+        write_given_varbinds(trap.varbinds, writer);
+        writer.write_integer(trap.time_stamp, DataType::TIME_TICKS);
+        writer.write_integer(trap.specific_trap);
+        writer.write_integer(static_cast<uint32_t>(trap.generic_trap));
+        writer.write_octet_string({reinterpret_cast<const char*>(&trap.agent_addr), sizeof(trap.agent_addr)},
+                                  DataType::IP_ADDRESS);
+        writer.write_oid(trap.enterprise);
+        writer.close(DataType::TRAP, 0);
+
+        writer.write_octet_string(community);
+        writer.write_integer(0); // SNMPv1
+        writer.close(DataType::SEQUENCE, 0);
+        return writer.data();
+    }
+
+    /**
+     * @brief Trap parsing (trap receivers, tests)
+     * @param community Set to the message's community when given
+     * @return nullopt when the datagram is not a well-formed SNMPv1 trap
+     */
+    inline std::optional<SnmpTrap> process_trap(std::span<const uint8_t> raw_data, std::string* community = nullptr) {
+        size_t index = 0;
+        auto message = expectTlv(raw_data, index, DataType::SEQUENCE);
+        if (!message) return std::nullopt;
+
+        size_t pos = 0;
+        auto version = expectInt(message->value, pos);
+        auto community_tlv = expectTlv(message->value, pos, DataType::OCTET_STRING);
+        auto pdu = expectTlv(message->value, pos, DataType::TRAP);
+        if (!version || *version != 0 || !community_tlv || !pdu) return std::nullopt;
+        if (community) *community = parseOctetString(community_tlv->value);
+
+        SnmpTrap trap;
+        pos = 0;
+        auto enterprise = expectTlv(pdu->value, pos, DataType::OBJECT_ID);
+        auto enterprise_oid = enterprise ? parseOid(enterprise->value) : std::nullopt;
+        auto agent_addr = expectTlv(pdu->value, pos, DataType::IP_ADDRESS);
+        auto generic_trap = expectInt(pdu->value, pos);
+        auto specific_trap = expectInt(pdu->value, pos);
+        auto time_stamp = expectTlv(pdu->value, pos, DataType::TIME_TICKS);
+        auto ticks = time_stamp ? parseInt(time_stamp->value) : std::nullopt;
+        if (!enterprise_oid || !agent_addr || agent_addr->value.size() != sizeof(trap.agent_addr) ||
+            !generic_trap || !specific_trap || !ticks)
+            return std::nullopt;
+
+        SnmpPdu vars;
+        if (!process_var_sequence(pdu->value, vars, pos)) return std::nullopt;
+
+        trap.enterprise = enterprise_oid->to_oid();
+        std::memcpy(&trap.agent_addr, agent_addr->value.data(), sizeof(trap.agent_addr));
+        trap.generic_trap = static_cast<GenericTrap>(*generic_trap);
+        trap.specific_trap = static_cast<uint32_t>(*specific_trap);
+        trap.time_stamp = static_cast<uint32_t>(*ticks);
+        trap.varbinds.assign(vars.vars.begin(), vars.vars.end());
+        return trap;
+    }
+
+    /**
+     * @brief Response to pdu around an already encoded VarBindList (e.g.
+     * computed for an identical request). nullopt when a GETBULK response
+     * would exceed the size limit with this pdu's community and req_id.
+     */
+    inline std::optional<std::span<const uint8_t>> respond_with_varbinds(const SnmpPdu& pdu, std::span<const uint8_t> varbind_list,
+                                                                         BerWriter& writer) {
+        if (pdu.command == DataTypeToString(DataType::GET_BULK_REQUEST)) {
+            size_t pos = 0;
+            auto list = readBerTlv(varbind_list, pos);
+            if (!list || response_size(pdu, list->value.size()) > max_response_size)
+                return std::nullopt;
+        }
+        writer.reset();
+        writer.put_bytes(varbind_list);
+        return write_response_headers(pdu, writer);
+    }
+
+    /**
+     * @brief Build a SNMP buffer from a SnmpPdu, back to front into writer.
+     * The returned span is valid until the writer is reset or reused.
+     */
+    inline std::span<const uint8_t> buildSnmpPdu(const SnmpPdu& pdu, BerWriter& writer) {
+        write_varbind_list(pdu, writer);
+        return write_response_headers(pdu, writer);
+    }
 
-        print_hex_buffer(packet, "resp_get >>> ");
+    /**
+     * @brief Build a SNMP buffer from a SnmpPdu (owning copy)
+     */
+    inline std::vector<uint8_t> buildSnmpPdu(const SnmpPdu& pdu) {
+        BerWriter writer;
+        auto packet = buildSnmpPdu(pdu, writer);
+        return {packet.begin(), packet.end()};
+    }
+
+    /**
+     * @brief Builds the RESPONSE PDU into a reusable writer
+     */
+    inline std::span<const uint8_t> resp_get(const SnmpPdu& pdu, BerWriter& writer) {
+
+        auto packet = buildSnmpPdu(pdu, writer);
+
+        AZ_SNMP_LOG_FMT(DEBUG, os, print_hex_buffer(os, packet, "resp_get >>> "));
 
         return packet;
     }
+
+    /**
+     * @brief Simulates building the RESPONSE PDU and BER serialization
+     */
+    inline std::vector<uint8_t> resp_get(const SnmpPdu& pdu) {
+        BerWriter writer;
+        auto packet = resp_get(pdu, writer);
+        return {packet.begin(), packet.end()};
+    }
 };
 
 } //SnmpServer
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_worker_task.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief N listener threads bound to the same port with SO_REUSEPORT.
+ * The kernel spreads datagrams between the sockets; each shard decodes,
+ * looks up and answers on its own thread (run to completion), so there
+ * is no queue and no cross-thread handoff per request.
+ * Drop-in alternative to SnmpListener + ThreadPoll: the MIB must be safe
+ * for concurrent readers (e.g. ConcurrentMibMgr) when shards > 1.
+ */
+class ShardedSnmpListener {
+private:
+    ConnectIntf* connectMgr;
+    MibIntf* mibMgr;
+    RequestCoalescer* coalescer;
+    size_t shard_count;
+    bool pin_to_cores;
+
+    std::vector<std::thread> shards;
+    std::vector<int> sockets;
+    std::atomic<bool> running{true};
+
+    inline void run_loop(int socket_fd, size_t shard_idx) {
+        if (pin_to_cores) {
+            unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(shard_idx % cores, &cpus);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        }
+
+        SnmpPacketBatch batch;
+        while (running) {
+            batch.clear();
+            size_t received = connectMgr->receive_batch(socket_fd, batch);
+
+            if (!running) break;
+            mark_received(batch);
+
+            if (received > 0)
+                serve_batch(batch, mibMgr, connectMgr, socket_fd, coalescer);
+        }
+    }
+
+public:
+    // Dependencies are injected via the constructor (coalescer is optional)
+    ShardedSnmpListener(ConnectIntf* conn, MibIntf* mib, size_t shard_num, bool pin = false,
+                        RequestCoalescer* coalesce = nullptr)
+        : connectMgr(conn), mibMgr(mib), coalescer(coalesce), shard_count(std::max<size_t>(shard_num, 1)),
+          pin_to_cores(pin) {}
+
+    ~ShardedSnmpListener() { stop(); }
+
+    inline void start(int port) {
+        for (size_t i = 0; i < shard_count; ++i)
+            sockets.push_back(connectMgr->init_shared_socket(port));
+
+        for (size_t i = 0; i < shard_count; ++i)
+            shards.emplace_back(&ShardedSnmpListener::run_loop, this, sockets[i], i);
+    }
+
+    inline void stop() {
+        if (running.exchange(false)) {
+            // Force every blocked receive to return and terminate the loops
+            for (int fd : sockets)
+                connectMgr->interrupt(fd);
+            for (auto& shard : shards)
+                if (shard.joinable()) shard.join();
+            for (int fd : sockets)
+                connectMgr->close_socket(fd);
+            sockets.clear();
+        }
+    }
+};
+
+} //SnmpServer
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Vector paths follow the target flags (-msse2 is the x86-64 baseline,
+// -mavx2 / -march=native enable the wider ones). AZ_SNMP_NO_SIMD forces
+// the scalar code everywhere.
+#if !defined(AZ_SNMP_NO_SIMD) && defined(__AVX2__)
+#define AZ_SNMP_SIMD_AVX2 1
+#endif
+#if !defined(AZ_SNMP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define AZ_SNMP_SIMD_SSE2 1
+#endif
+
+#if defined(AZ_SNMP_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(AZ_SNMP_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace SnmpServer {
+
+//==============================================
+// SUB-IDENTIFIER ARRAYS
+//==============================================
+
+/**
+ * @brief Index of the first differing element of a and b, n when equal
+ */
+inline size_t subid_mismatch_scalar(const uint32_t* a, const uint32_t* b, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (a[i] != b[i]) return i;
+    return n;
+}
+
+inline size_t subid_mismatch(const uint32_t* a, const uint32_t* b, size_t n) {
+    size_t i = 0;
+#if defined(AZ_SNMP_SIMD_AVX2)
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        uint32_t equal = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, y)));
+        if (equal != 0xFFFFFFFFu) return i + std::countr_one(equal) / 4;
+    }
+#endif
+#if defined(AZ_SNMP_SIMD_SSE2)
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        uint32_t equal = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi32(x, y)));
+        if (equal != 0xFFFFu) return i + std::countr_one(equal) / 4;
+    }
+#endif
+    return i + subid_mismatch_scalar(a + i, b + i, n - i);
+}
+
+//==============================================
+// BASE-128 DECODING
+//==============================================
+
+/**
+ * @brief Number of sub-identifiers in a BER OID body (terminating bytes,
+ * i.e. bytes without the continuation bit)
+ */
+inline size_t ber_count_subids_scalar(std::span<const uint8_t> body) {
+    size_t count = 0;
+    for (uint8_t byte : body)
+        if ((byte & 0x80) == 0) ++count;
+    return count;
+}
+
+inline size_t ber_count_subids(std::span<const uint8_t> body) {
+    const uint8_t* p = body.data();
+    const uint8_t* e = p + body.size();
+    size_t count = 0;
+#if defined(AZ_SNMP_SIMD_AVX2)
+    for (; e - p >= 32; p += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        count += 32 - std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(bytes)));
+    }
+#endif
+#if defined(AZ_SNMP_SIMD_SSE2)
+    for (; e - p >= 16; p += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        count += 16 - std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(bytes)));
+    }
+#endif
+    return count + ber_count_subids_scalar({p, e});
+}
+
+/**
+ * @brief Decodes base-128 sub-identifiers into out (room for
+ * ber_count_subids() values) and returns how many were written. subid
+ * carries a sub-identifier left unfinished by a previous block.
+ */
+inline size_t ber_decode_subids_scalar(std::span<const uint8_t> body, uint32_t* out, uint32_t subid = 0) {
+    size_t n = 0;
+    for (uint8_t byte : body) {
+        subid = (subid << 7) | (byte & 0x7F);
+        if ((byte & 0x80) == 0) {
+            out[n++] = subid;
+            subid = 0;
+        }
+    }
+    return n;
+}
+
+#if defined(AZ_SNMP_SIMD_SSE2)
+/**
+ * @brief Decodes the groups of one 16-byte block whose terminating bytes
+ * are flagged in ends (bit i set when byte i ends a sub-identifier)
+ */
+inline size_t ber_decode_block(const uint8_t* p, uint32_t ends, uint32_t* out, uint32_t& subid) {
+    size_t n = 0;
+    size_t start = 0;
+    while (ends) {
+        size_t stop = static_cast<size_t>(std::countr_zero(ends));
+        for (size_t i = start; i <= stop; ++i)
+            subid = (subid << 7) | (p[i] & 0x7F);
+        out[n++] = subid;
+        subid = 0;
+        start = stop + 1;
+        ends &= ends - 1;
+    }
+    for (size_t i = start; i < 16; ++i)
+        subid = (subid << 7) | (p[i] & 0x7F);
+    return n;
+}
+#endif
+
+/**
+ * @brief ber_decode_subids_scalar() over 16-byte blocks (long OIDs such as
+ * string-indexed table rows): the continuation bits of a block come from
+ * one movemask. A block of single-byte sub-identifiers is widened as a
+ * whole; otherwise the group boundaries are walked from the mask instead of
+ * testing every byte.
+ */
+inline size_t ber_decode_subids(std::span<const uint8_t> body, uint32_t* out) {
+    uint32_t subid = 0;
+    size_t n = 0;
+#if defined(AZ_SNMP_SIMD_SSE2)
+    const uint8_t* p = body.data();
+    const uint8_t* e = p + body.size();
+    const __m128i zero = _mm_setzero_si128();
+    for (; e - p >= 16; p += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        uint32_t cont = static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+        if (cont == 0 && subid == 0) {
+            __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+            __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + n), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + n + 4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + n + 8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + n + 12), _mm_unpackhi_epi16(hi, zero));
+            n += 16;
+            continue;
+        }
+        n += ber_decode_block(p, ~cont & 0xFFFF, out + n, subid);
+    }
+    // Below one block (most OIDs) the plain loop is the fastest
+    n += ber_decode_subids_scalar({p, e}, out + n, subid);
+    return n;
+#else
+    return n + ber_decode_subids_scalar(body, out, subid);
+#endif
+}
+
+//==============================================
+// BASE-128 ENCODING
+//==============================================
+
+/**
+ * @brief Bytes taken by one base-128 sub-identifier (1 to 5)
+ */
+inline size_t ber_subid_size(uint32_t subid) {
+    return (static_cast<size_t>(std::bit_width(subid | 1)) + 6) / 7;
+}
+
+/**
+ * @brief Bytes taken by n base-128 sub-identifiers
+ */
+inline size_t ber_subids_size(const uint32_t* ids, size_t n) {
+    size_t size = 0;
+    size_t i = 0;
+#if defined(AZ_SNMP_SIMD_SSE2)
+    // Four sub-identifiers below 128 take four bytes
+    const __m128i high = _mm_set1_epi32(~0x7F);
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(v, high), _mm_setzero_si128())) == 0xFFFF) {
+            size += 4;
+        } else {
+            for (size_t j = i; j < i + 4; ++j) size += ber_subid_size(ids[j]);
+        }
+    }
+#endif
+    for (; i < n; ++i) size += ber_subid_size(ids[i]);
+    return size;
+}
+
+/**
+ * @brief Writes one base-128 sub-identifier at out, returns the end
+ */
+inline uint8_t* ber_encode_subid(uint32_t subid, uint8_t* out) {
+    size_t size = ber_subid_size(subid);
+    for (size_t i = size - 1; i > 0; --i)
+        *out++ = static_cast<uint8_t>(0x80 | ((subid >> (7 * i)) & 0x7F));
+    *out++ = static_cast<uint8_t>(subid & 0x7F);
+    return out;
+}
+
+/**
+ * @brief Writes n base-128 sub-identifiers at out (room for
+ * ber_subids_size() bytes), returns the end. Runs of eight single-byte
+ * sub-identifiers are narrowed with two packs.
+ */
+inline uint8_t* ber_encode_subids(const uint32_t* ids, size_t n, uint8_t* out) {
+    size_t i = 0;
+#if defined(AZ_SNMP_SIMD_SSE2)
+    const __m128i high = _mm_set1_epi32(~0x7F);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= n;) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + i + 4));
+        __m128i small = _mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(a, b), high), zero);
+        if (_mm_movemask_epi8(small) == 0xFFFF) {
+            __m128i words = _mm_packs_epi32(a, b);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(words, zero));
+            out += 8;
+            i += 8;
+        } else {
+            // _mm_or_si128 only says one of each pair is large: step by four
+            for (size_t end = i + 4; i < end; ++i) out = ber_encode_subid(ids[i], out);
+        }
+    }
+#endif
+    for (; i < n; ++i) out = ber_encode_subid(ids[i], out);
+    return out;
+}
+
+} //SnmpServer
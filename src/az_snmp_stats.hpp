@@ -0,0 +1,396 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Set to 0 to compile every counter and timer out
+#ifndef AZ_SNMP_STATS
+#define AZ_SNMP_STATS 1
+#endif
+
+// One request in AZ_SNMP_STATS_SAMPLE is timed (power of two); counters are exact
+#ifndef AZ_SNMP_STATS_SAMPLE
+#define AZ_SNMP_STATS_SAMPLE 8
+#endif
+
+namespace SnmpServer {
+
+using StatClock = std::chrono::steady_clock;
+
+/**
+ * @brief Request stages with a latency histogram
+ */
+enum class StatStage : uint8_t {
+    RECEIVE,    // Datagram received -> handed to the pool
+    QUEUE_WAIT, // Handed to the pool -> worker starts
+    DECODE,     // process_request
+    MIB,        // MIB reads while answering
+    ENCODE,     // Response encoding (answering minus MIB)
+    SEND,       // Transport send
+    COUNT
+};
+
+/**
+ * @brief Event counters
+ */
+enum class StatCounter : uint8_t {
+    PACKETS_IN,
+    PACKETS_OUT,
+    DECODE_ERRORS,
+    DROPS,         // Requests left without a response (worker error)
+    SEND_ERRORS,   // Responses the transport failed to send
+    TASKS_QUEUED,
+    TASKS_STARTED,
+    COUNT
+};
+
+inline std::string_view StatStageToString(StatStage stage) {
+    switch (stage) {
+        case StatStage::RECEIVE:    return "receive";
+        case StatStage::QUEUE_WAIT: return "queueWait";
+        case StatStage::DECODE:     return "decode";
+        case StatStage::MIB:        return "mib";
+        case StatStage::ENCODE:     return "encode";
+        case StatStage::SEND:       return "send";
+        default:                    return "unknown";
+    }
+}
+
+constexpr size_t STAT_STAGES = static_cast<size_t>(StatStage::COUNT);
+constexpr size_t STAT_COUNTERS = static_cast<size_t>(StatCounter::COUNT);
+
+//==============================================
+// HISTOGRAM
+//==============================================
+
+/**
+ * @brief Log-linear (HDR-style) bucketing of nanosecond values: 8 linear
+ * sub-buckets per power of two, so any value is known within 12.5%, from
+ * 1 ns to 2^36 ns (about 68 s, larger values land in the last bucket).
+ */
+struct HistogramLayout {
+    static constexpr unsigned SUB_BITS = 3;
+    static constexpr uint64_t SUB_BUCKETS = 1u << SUB_BITS;
+    static constexpr unsigned MAX_BITS = 36;
+    static constexpr size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+
+    static inline size_t bucket(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        unsigned msb = static_cast<unsigned>(std::bit_width(value)) - 1;
+        if (msb >= MAX_BITS) return BUCKETS - 1;
+        unsigned shift = msb - SUB_BITS;
+        return static_cast<size_t>((shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1)));
+    }
+
+    /**
+     * @brief Highest value falling in bucket
+     */
+    static inline uint64_t upper_bound(size_t bucket) {
+        if (bucket < SUB_BUCKETS) return bucket;
+        unsigned shift = static_cast<unsigned>(bucket / SUB_BUCKETS) - 1;
+        uint64_t base = (SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+        return base + (uint64_t{1} << shift) - 1;
+    }
+};
+
+/**
+ * @brief Aggregated copy of one stage's histograms
+ */
+struct HistogramSnapshot {
+    std::array<uint64_t, HistogramLayout::BUCKETS> buckets{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    inline uint64_t mean() const { return count ? sum / count : 0; }
+
+    /**
+     * @brief Value at quantile q (0..1), within the bucket precision
+     */
+    inline uint64_t percentile(double q) const {
+        if (count == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= rank) return std::min(HistogramLayout::upper_bound(i), max);
+        }
+        return max;
+    }
+};
+
+/**
+ * @brief Histogram written by a single thread and read by any.
+ * Updates are plain relaxed load/store pairs (no read-modify-write).
+ */
+class LatencyHistogram {
+private:
+    std::array<std::atomic<uint64_t>, HistogramLayout::BUCKETS> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+
+    static inline void bump(std::atomic<uint64_t>& cell, uint64_t n) {
+        cell.store(cell.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+public:
+    inline void record(uint64_t ns) {
+        bump(buckets[HistogramLayout::bucket(ns)], 1);
+        bump(count, 1);
+        bump(sum, ns);
+        if (ns > max.load(std::memory_order_relaxed)) max.store(ns, std::memory_order_relaxed);
+    }
+
+    inline void merge_into(HistogramSnapshot& out) const {
+        for (size_t i = 0; i < buckets.size(); ++i)
+            out.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+        out.count += count.load(std::memory_order_relaxed);
+        out.sum += sum.load(std::memory_order_relaxed);
+        out.max = std::max(out.max, max.load(std::memory_order_relaxed));
+    }
+};
+
+//==============================================
+// AGENT STATISTICS
+//==============================================
+
+/**
+ * @brief Aggregated statistics at one point in time
+ */
+struct StatsSnapshot {
+    std::array<uint64_t, STAT_COUNTERS> counters{};
+    std::array<HistogramSnapshot, STAT_STAGES> stages{};
+
+    inline uint64_t counter(StatCounter c) const { return counters[static_cast<size_t>(c)]; }
+    inline const HistogramSnapshot& stage(StatStage s) const { return stages[static_cast<size_t>(s)]; }
+
+    /**
+     * @brief Tasks handed to the pool and not started yet
+     */
+    inline uint64_t queue_depth() const {
+        uint64_t queued = counter(StatCounter::TASKS_QUEUED);
+        uint64_t started = counter(StatCounter::TASKS_STARTED);
+        return queued > started ? queued - started : 0;
+    }
+};
+
+/**
+ * @brief Process-wide per-stage latency histograms and counters.
+ * Every thread writes its own block (no locks, no shared cache lines);
+ * snapshot() sums the blocks on demand. A block outlives its thread and is
+ * adopted by the next new thread, so totals never go backwards.
+ * Latencies are sampled (AZ_SNMP_STATS_SAMPLE); see register_stats_subtree()
+ * to serve them over SNMP.
+ */
+class AgentStats {
+private:
+    struct alignas(64) Block {
+        std::array<std::atomic<uint64_t>, STAT_COUNTERS> counters{};
+        std::array<LatencyHistogram, STAT_STAGES> stages;
+        std::atomic<bool> in_use{false};
+    };
+
+    std::mutex blocks_mutex;
+    std::vector<std::unique_ptr<Block>> blocks;
+
+    /**
+     * @brief Per-thread block ownership (released at thread exit)
+     */
+    struct ThreadBlock {
+        Block* block = nullptr;
+
+        ~ThreadBlock() {
+            if (block) block->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    inline Block& acquire_block(ThreadBlock& local) {
+        std::lock_guard<std::mutex> lock(blocks_mutex);
+        for (auto& block : blocks) {
+            bool expected = false;
+            if (block->in_use.compare_exchange_strong(expected, true)) {
+                local.block = block.get();
+                return *block;
+            }
+        }
+        blocks.push_back(std::make_unique<Block>());
+        blocks.back()->in_use.store(true, std::memory_order_relaxed);
+        local.block = blocks.back().get();
+        return *local.block;
+    }
+
+    inline Block& local_block() {
+        thread_local ThreadBlock local;
+        if (local.block) return *local.block;
+        return acquire_block(local);
+    }
+
+public:
+    static AgentStats& instance() {
+        static AgentStats stats;
+        return stats;
+    }
+
+    inline void count(StatCounter counter, uint64_t n = 1) {
+        std::atomic<uint64_t>& cell = local_block().counters[static_cast<size_t>(counter)];
+        cell.store(cell.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    inline void record(StatStage stage, StatClock::duration elapsed) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        local_block().stages[static_cast<size_t>(stage)].record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+    }
+
+    inline StatsSnapshot snapshot() {
+        StatsSnapshot out;
+        std::lock_guard<std::mutex> lock(blocks_mutex);
+        for (const auto& block : blocks) {
+            for (size_t i = 0; i < STAT_COUNTERS; ++i)
+                out.counters[i] += block->counters[i].load(std::memory_order_relaxed);
+            for (size_t i = 0; i < STAT_STAGES; ++i)
+                block->stages[i].merge_into(out.stages[i]);
+        }
+        return out;
+    }
+};
+
+/**
+ * @brief Counts an event (no-op when AZ_SNMP_STATS is 0)
+ */
+inline void stat_count(StatCounter counter, uint64_t n = 1) {
+    if constexpr (AZ_SNMP_STATS) AgentStats::instance().count(counter, n);
+}
+
+/**
+ * @brief Times one stage of a sampled request (does nothing when off)
+ */
+class StageTimer {
+private:
+    StatClock::time_point begin{};
+public:
+    explicit StageTimer(bool on) {
+        if constexpr (AZ_SNMP_STATS) {
+            if (on) begin = StatClock::now();
+        }
+    }
+
+    inline StatClock::duration elapsed() const {
+        return begin == StatClock::time_point{} ? StatClock::duration{} : StatClock::now() - begin;
+    }
+
+    /**
+     * @brief Records the time elapsed since construction
+     */
+    inline void stop(StatStage stage) {
+        if (begin != StatClock::time_point{}) AgentStats::instance().record(stage, elapsed());
+    }
+};
+
+/**
+ * @brief Records the time since start for stage (start set by stat_sample())
+ */
+inline void stat_record(StatStage stage, StatClock::time_point start) {
+    if constexpr (AZ_SNMP_STATS) {
+        if (start != StatClock::time_point{}) AgentStats::instance().record(stage, StatClock::now() - start);
+    }
+}
+
+/**
+ * @brief Sampling decision for one received request: the receive time when
+ * it is to be timed, a default time point otherwise
+ */
+inline StatClock::time_point stat_sample() {
+    if constexpr (AZ_SNMP_STATS) {
+        thread_local uint32_t received = 0;
+        if ((received++ & (AZ_SNMP_STATS_SAMPLE - 1)) == 0) return StatClock::now();
+    }
+    return {};
+}
+
+/**
+ * @brief MIB time of the request being timed on this thread. The handler
+ * wraps every MIB access in a Scope; encoding done from inside a MIB walk
+ * (GETBULK visitors) is taken back out with a Pause. Both are no-ops unless
+ * start() was called for the current request.
+ */
+class MibStageClock {
+private:
+    struct State {
+        bool active = false;
+        unsigned depth = 0; // Scopes open
+        StatClock::duration elapsed{};
+    };
+
+    static inline State& state() {
+        thread_local State local;
+        return local;
+    }
+
+public:
+    static inline void start() { state() = {true, 0, {}}; }
+
+    /**
+     * @brief Stops timing and returns the MIB time accumulated
+     */
+    static inline StatClock::duration stop() {
+        State& local = state();
+        local.active = false;
+        return local.elapsed;
+    }
+
+    class Scope {
+    private:
+        StatClock::time_point begin{};
+        bool done = false;
+    public:
+        Scope() {
+            if constexpr (AZ_SNMP_STATS) {
+                State& local = state();
+                if (local.active && local.depth++ == 0) begin = StatClock::now();
+            }
+        }
+        ~Scope() { stop(); }
+
+        /**
+         * @brief Ends the scope early (e.g. before encoding what was read)
+         */
+        inline void stop() {
+            if constexpr (AZ_SNMP_STATS) {
+                if (done) return;
+                done = true;
+                State& local = state();
+                if (!local.active) return;
+                --local.depth;
+                if (begin != StatClock::time_point{}) local.elapsed += StatClock::now() - begin;
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    class Pause {
+    private:
+        StatClock::time_point begin{};
+    public:
+        Pause() {
+            if constexpr (AZ_SNMP_STATS) {
+                State& local = state();
+                if (local.active && local.depth > 0) begin = StatClock::now();
+            }
+        }
+        ~Pause() {
+            if (begin != StatClock::time_point{}) state().elapsed -= StatClock::now() - begin;
+        }
+        Pause(const Pause&) = delete;
+        Pause& operator=(const Pause&) = delete;
+    };
+};
+
+} //SnmpServer
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "az_snmp_global.hpp"
+#include "az_snmp_mib_lazy.hpp"
+#include "az_snmp_stats.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief Default root of the agent's own statistics: enterprises.32473 is
+ * the documentation enterprise number (RFC 5612), change it for a real PEN
+ */
+inline const OID AZ_SNMP_STATS_PREFIX{1,3,6,1,4,1,32473,1};
+
+/**
+ * @brief Objects of the statistics subtree, computed from one snapshot.
+ *   P.1.<n>.0         counters, n = StatCounter + 1, then queueDepth
+ *   P.2.1.1.<stage>   stage name (stage = StatStage + 1)
+ *   P.2.1.2.<stage>   samples timed
+ *   P.2.1.3..8        mean, p50, p90, p99, p99.9 and max (ns)
+ * Values are INTEGER: the variant has no Counter64.
+ */
+inline void stats_entries(const OID& prefix, const StatsSnapshot& stats, std::vector<MibEntry>& objects) {
+    auto object = [&](std::initializer_list<uint32_t> suffix, SnmpVariant value) {
+        OID oid = prefix;
+        for (uint32_t subid : suffix) oid.push_back(subid);
+        objects.push_back({std::move(oid), std::move(value)});
+    };
+    auto integer = [](uint64_t value) { return SnmpVariant{static_cast<int64_t>(value)}; };
+
+    uint32_t n = 1;
+    for (; n <= STAT_COUNTERS; ++n)
+        object({1, n, 0}, integer(stats.counters[n - 1]));
+    object({1, n, 0}, integer(stats.queue_depth()));
+
+    for (uint32_t stage = 1; stage <= STAT_STAGES; ++stage) {
+        const HistogramSnapshot& histogram = stats.stages[stage - 1];
+        object({2, 1, 1, stage}, SnmpVariant{std::pmr::string(StatStageToString(static_cast<StatStage>(stage - 1)))});
+        object({2, 1, 2, stage}, integer(histogram.count));
+        object({2, 1, 3, stage}, integer(histogram.mean()));
+        object({2, 1, 4, stage}, integer(histogram.percentile(0.50)));
+        object({2, 1, 5, stage}, integer(histogram.percentile(0.90)));
+        object({2, 1, 6, stage}, integer(histogram.percentile(0.99)));
+        object({2, 1, 7, stage}, integer(histogram.percentile(0.999)));
+        object({2, 1, 8, stage}, integer(histogram.max));
+    }
+}
+
+/**
+ * @brief Serves AgentStats under prefix through the agent's own MIB. The
+ * per-thread blocks are summed only when a request reaches the subtree,
+ * at most once per ttl.
+ */
+inline void register_stats_subtree(LazyMib& mib, const OID& prefix = AZ_SNMP_STATS_PREFIX,
+                                   std::chrono::milliseconds ttl = std::chrono::seconds(1)) {
+    mib.register_subtree(prefix, [prefix](std::vector<MibEntry>& objects) {
+        stats_entries(prefix, AgentStats::instance().snapshot(), objects);
+    }, ttl);
+}
+
+} //SnmpServer
@@ -6,6 +6,7 @@
 #include <condition_variable>
 
 #include "az_snmp_global.hpp"
+#include "az_snmp_intfs.hpp"
 
 namespace SnmpServer {
 
@@ -15,7 +16,7 @@ namespace SnmpServer {
 class ThreadPoll : public ThreadPollIntf {
 private:
     std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
+    std::queue<SnmpTask> tasks;
     std::mutex queue_mutex;
     std::condition_variable condition;
     bool stop = false;
@@ -23,7 +24,7 @@ private:
     // The main loop executed by each worker thread
     inline void worker_loop() {
         while (true) {
-            std::function<void()> task;
+            SnmpTask task;
             {
                 std::unique_lock<std::mutex> lock(queue_mutex);
                 condition.wait(lock, [this]{ return stop || !tasks.empty(); });
@@ -45,7 +46,7 @@ public:
         }
     }
 
-    inline void enqueue(std::function<void()> task) override {
+    inline void enqueue(SnmpTask task) override {
         {
             std::unique_lock<std::mutex> lock(queue_mutex);
             if(stop) throw std::runtime_error("ThreadPool cannot enqueue: already stopped.");
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <streambuf>
+#include <ostream>
+
+#include "az_snmp_global.hpp"
+
+//==============================================
+// COMPILE-TIME LEVELS
+//==============================================
+
+#define AZ_SNMP_LOG_LEVEL_TRACE 0
+#define AZ_SNMP_LOG_LEVEL_DEBUG 1
+#define AZ_SNMP_LOG_LEVEL_INFO  2
+#define AZ_SNMP_LOG_LEVEL_WARN  3
+#define AZ_SNMP_LOG_LEVEL_ERROR 4
+#define AZ_SNMP_LOG_LEVEL_OFF   5
+
+#ifndef AZ_SNMP_LOG_LEVEL
+#define AZ_SNMP_LOG_LEVEL AZ_SNMP_LOG_LEVEL_INFO
+#endif
+
+// Slots per thread ring and bytes per record
+#ifndef AZ_SNMP_TRACE_RING_SIZE
+#define AZ_SNMP_TRACE_RING_SIZE 256
+#endif
+
+#ifndef AZ_SNMP_TRACE_RECORD_SIZE
+#define AZ_SNMP_TRACE_RECORD_SIZE 512
+#endif
+
+/**
+ * @brief Streams a trace line: AZ_SNMP_LOG(DEBUG, "index " << index);
+ * Levels below AZ_SNMP_LOG_LEVEL are discarded at compile time and their
+ * arguments are never evaluated.
+ */
+#define AZ_SNMP_LOG(LEVEL, ...)                                              \
+    do {                                                                     \
+        if constexpr (AZ_SNMP_LOG_LEVEL_##LEVEL >= AZ_SNMP_LOG_LEVEL) {      \
+            ::SnmpServer::TraceLine az_trace_line(AZ_SNMP_LOG_LEVEL_##LEVEL); \
+            az_trace_line.stream() << __VA_ARGS__;                           \
+        }                                                                    \
+    } while (0)
+
+/**
+ * @brief Runs a formatter on the trace stream:
+ * AZ_SNMP_LOG_FMT(DEBUG, os, printSnmpPdu(os, pdu));
+ */
+#define AZ_SNMP_LOG_FMT(LEVEL, os, ...)                                      \
+    do {                                                                     \
+        if constexpr (AZ_SNMP_LOG_LEVEL_##LEVEL >= AZ_SNMP_LOG_LEVEL) {      \
+            ::SnmpServer::TraceLine az_trace_line(AZ_SNMP_LOG_LEVEL_##LEVEL); \
+            std::ostream& os = az_trace_line.stream();                       \
+            __VA_ARGS__;                                                     \
+        }                                                                    \
+    } while (0)
+
+namespace SnmpServer {
+
+/**
+ * @brief One formatted trace line
+ */
+struct TraceRecord {
+    uint8_t level;
+    uint16_t len;
+    char text[AZ_SNMP_TRACE_RECORD_SIZE];
+};
+
+/**
+ * @brief Single-producer/single-consumer ring owned by one thread.
+ * The owning thread formats directly into the reserved slot; the drain
+ * thread is the only consumer. A full ring drops the line.
+ */
+class TraceRing {
+private:
+    static constexpr size_t MASK = AZ_SNMP_TRACE_RING_SIZE - 1;
+    static_assert((AZ_SNMP_TRACE_RING_SIZE & MASK) == 0, "Trace ring size must be a power of two");
+
+    std::array<TraceRecord, AZ_SNMP_TRACE_RING_SIZE> slots;
+    alignas(64) std::atomic<size_t> head{0}; // Written by the producer
+    alignas(64) std::atomic<size_t> tail{0}; // Written by the drain thread
+
+public:
+    const uint32_t thread_idx;
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> closed{false};
+
+    explicit TraceRing(uint32_t idx) : thread_idx(idx) {}
+
+    inline TraceRecord* try_reserve() {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= AZ_SNMP_TRACE_RING_SIZE) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &slots[h & MASK];
+    }
+
+    inline void commit() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Consumer side: hands every published record to fn
+     */
+    template <typename Fn>
+    inline size_t drain(Fn&& fn) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        for (size_t i = t; i != h; ++i)
+            fn(slots[i & MASK]);
+        tail.store(h, std::memory_order_release);
+        return h - t;
+    }
+};
+
+/**
+ * @brief Process-wide consumer: owns the background thread that drains
+ * every registered ring to std::cout (std::cerr for WARN and above).
+ */
+class TraceSink {
+private:
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    uint32_t next_idx = 0;
+    uint64_t retired_dropped = 0;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread drain_thread;
+
+    inline size_t drain_once() {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        size_t total = 0;
+        for (auto it = rings.begin(); it != rings.end();) {
+            TraceRing& ring = **it;
+            bool closed = ring.closed.load(std::memory_order_acquire);
+            total += ring.drain([&](const TraceRecord& rec) {
+                std::ostream& out = (rec.level >= AZ_SNMP_LOG_LEVEL_WARN) ? std::cerr : std::cout;
+                out << "[T" << ring.thread_idx << "] ";
+                out.write(rec.text, rec.len);
+                if (rec.len == 0 || rec.text[rec.len - 1] != '\n') out.put('\n');
+            });
+            // A closed ring has no producer left, so it is empty after this pass
+            if (closed) {
+                retired_dropped += ring.dropped.load(std::memory_order_relaxed);
+                it = rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (total) std::cout.flush();
+        return total;
+    }
+
+    inline void run() {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        while (!stopping) {
+            lock.unlock();
+            size_t drained = drain_once();
+            lock.lock();
+            if (drained == 0)
+                wake.wait_for(lock, std::chrono::milliseconds(1), [this] { return stopping; });
+        }
+    }
+
+public:
+    TraceSink() : drain_thread(&TraceSink::run, this) {}
+
+    ~TraceSink() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (drain_thread.joinable()) drain_thread.join();
+        drain_once();
+    }
+
+    static TraceSink& instance() {
+        static TraceSink sink;
+        return sink;
+    }
+
+    inline std::shared_ptr<TraceRing> register_thread() {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        auto ring = std::make_shared<TraceRing>(next_idx++);
+        rings.push_back(ring);
+        return ring;
+    }
+
+    /**
+     * @brief Synchronously drains every ring (e.g. before exit)
+     */
+    inline void flush() { drain_once(); }
+
+    /**
+     * @brief Lines lost because a thread ring was full
+     */
+    inline uint64_t dropped() {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        uint64_t total = retired_dropped;
+        for (auto& ring : rings) total += ring->dropped.load(std::memory_order_relaxed);
+        return total;
+    }
+};
+
+/**
+ * @brief Streambuf writing into a fixed record; extra output is truncated.
+ */
+class TraceStreamBuf : public std::streambuf {
+public:
+    inline void attach(char* buf, size_t size) { setp(buf, buf + size); }
+    inline size_t length() const { return static_cast<size_t>(pptr() - pbase()); }
+};
+
+/**
+ * @brief Per-thread producer state (ring + reusable stream)
+ */
+struct TraceThreadState {
+    std::shared_ptr<TraceRing> ring = TraceSink::instance().register_thread();
+    TraceStreamBuf buf;
+    std::ostream os{&buf};
+
+    ~TraceThreadState() { ring->closed.store(true, std::memory_order_release); }
+
+    static TraceThreadState& local() {
+        thread_local TraceThreadState state;
+        return state;
+    }
+};
+
+/**
+ * @brief RAII handle for one line: reserves a slot, publishes it on scope exit.
+ */
+class TraceLine {
+private:
+    TraceThreadState& state;
+    TraceRecord* rec;
+
+public:
+    explicit TraceLine(int level) : state(TraceThreadState::local()), rec(state.ring->try_reserve()) {
+        state.os.clear();
+        if (rec) {
+            rec->level = static_cast<uint8_t>(level);
+            state.buf.attach(rec->text, sizeof(rec->text));
+        } else {
+            // Ring full: the stream goes bad and formatting is skipped
+            state.buf.attach(nullptr, 0);
+            state.os.setstate(std::ios::badbit);
+        }
+    }
+
+    ~TraceLine() {
+        if (!rec) return;
+        rec->len = static_cast<uint16_t>(state.buf.length());
+        state.ring->commit();
+    }
+
+    TraceLine(const TraceLine&) = delete;
+    TraceLine& operator=(const TraceLine&) = delete;
+
+    inline std::ostream& stream() { return state.os; }
+};
+
+} //SnmpServer
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "az_snmp_connect.hpp"
+#include "az_snmp_mpmc_queue.hpp"
+#include "az_snmp_prot_handler.hpp"
+#include "az_snmp_trace.hpp"
+
+namespace SnmpServer {
+
+/**
+ * @brief Trap destination (an NMS) and how fast it may be sent traps
+ */
+struct TrapSink {
+    sockaddr_in address{};
+    std::string community = "public";
+    double rate = 50;  // Traps per second, sustained (0: unlimited)
+    double burst = 100; // Traps sent back to back before the rate applies
+};
+
+struct TrapSenderOptions {
+    size_t queue_capacity = 4096; // Traps enqueued and not yet taken by the sender
+    size_t batch = 32;            // Datagrams per sendmmsg
+    size_t max_backlog = 1024;    // Per sink, traps waiting for tokens (oldest dropped beyond)
+    in_addr_t agent_address = 0;  // agent-addr of the traps, network order
+};
+
+/**
+ * @brief Notification subsystem: application threads enqueue SNMPv1 traps
+ * on a lock-free ring (no lock, no allocation beyond the trap's own, never
+ * blocking: a full ring drops the trap). A sender thread encodes them with
+ * SnmpProtocolHandler and sends them to every sink with sendmmsg.
+ * Each sink has a token bucket. Traps over its rate wait in a backlog,
+ * where a newer trap about the same objects (same enterprise and varbind
+ * OIDs, e.g. linkDown/linkUp of one interface) replaces the waiting one:
+ * a flapping link costs the NMS one trap per interval carrying the latest
+ * state, whatever the flap rate.
+ */
+class TrapSender {
+private:
+    using Clock = std::chrono::steady_clock;
+    using TrapPtr = std::shared_ptr<const SnmpTrap>; // One trap, shared by the sinks' backlogs
+
+    // Longest sleep while a backlog waits for tokens (bounds stop() latency)
+    static constexpr std::chrono::milliseconds MAX_WAIT{20};
+
+    struct Waiting {
+        uint64_t subject;
+        TrapPtr trap;
+    };
+
+    struct Sink {
+        TrapSink config;
+        double tokens;
+        Clock::time_point refilled;
+        std::list<Waiting> backlog; // Oldest first
+        std::unordered_multimap<uint64_t, std::list<Waiting>::iterator> by_subject;
+
+        inline void refill(Clock::time_point now) {
+            if (config.rate <= 0) return;
+            std::chrono::duration<double> elapsed = now - refilled;
+            tokens = std::min(config.burst, tokens + elapsed.count() * config.rate);
+            refilled = now;
+        }
+
+        inline bool take_token() {
+            if (config.rate <= 0) return true;
+            if (tokens < 1) return false;
+            tokens -= 1;
+            return true;
+        }
+
+        inline void pop_front() {
+            auto range = by_subject.equal_range(backlog.front().subject);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == backlog.begin()) {
+                    by_subject.erase(it);
+                    break;
+                }
+            }
+            backlog.pop_front();
+        }
+    };
+
+    TrapSenderOptions options;
+    SnmpProtocolHandler protocol{nullptr};
+    ConnectMgr transport;
+    int socket_fd = -1;
+    const Clock::time_point started = Clock::now();
+
+    MpmcQueue<SnmpTrap> queue;
+    alignas(64) std::atomic<bool> parked{false};
+    alignas(64) std::atomic<uint32_t> wake_signal{0};
+    std::atomic<bool> wake_pending{false};
+    std::atomic<bool> stopping{false};
+
+    std::atomic<uint64_t> sent_count{0};
+    std::atomic<uint64_t> coalesced_count{0};
+    std::atomic<uint64_t> dropped_count{0};
+
+    // Sender thread only
+    std::vector<Sink> sinks;
+    BerWriter writer;
+    std::vector<std::vector<uint8_t>> buffers; // Encoded datagrams of the batch being built
+    std::vector<SnmpOutPacket> outgoing;
+    std::thread sender_thread;
+
+    /**
+     * @brief Trap type for coalescing: linkDown and linkUp report the same
+     * state, every other generic and specific trap is its own event
+     */
+    static inline uint32_t kind_of(const SnmpTrap& trap) {
+        GenericTrap generic = trap.generic_trap == GenericTrap::LINK_UP ? GenericTrap::LINK_DOWN : trap.generic_trap;
+        return static_cast<uint32_t>(generic);
+    }
+
+    /**
+     * @brief Traps of the same kind about the same objects share a subject
+     * (enterprise, trap type and varbind OIDs; values left out)
+     */
+    static inline uint64_t subject_of(const SnmpTrap& trap) {
+        uint64_t hash = SnmpOid::mix(trap.enterprise.hash(), static_cast<uint32_t>(trap.varbinds.size()));
+        hash = SnmpOid::mix(SnmpOid::mix(hash, kind_of(trap)), trap.specific_trap);
+        for (const SnmpValue& var : trap.varbinds)
+            hash = SnmpOid::mix(hash, static_cast<uint32_t>(var.oid.hash() ^ (var.oid.hash() >> 32)));
+        return hash;
+    }
+
+    static inline bool same_subject(const SnmpTrap& a, const SnmpTrap& b) {
+        return a.enterprise == b.enterprise && kind_of(a) == kind_of(b) && a.specific_trap == b.specific_trap &&
+               std::equal(a.varbinds.begin(), a.varbinds.end(), b.varbinds.begin(), b.varbinds.end(),
+                          [](const SnmpValue& x, const SnmpValue& y) { return x.oid == y.oid; });
+    }
+
+    inline void wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) && !wake_pending.exchange(true)) {
+            wake_signal.fetch_add(1, std::memory_order_seq_cst);
+            wake_signal.notify_one();
+        }
+    }
+
+    inline void flush() {
+        if (outgoing.empty()) return;
+        transport.send_batch(socket_fd, outgoing);
+        sent_count.fetch_add(outgoing.size(), std::memory_order_relaxed);
+        outgoing.clear();
+    }
+
+    inline void send_to(Sink& sink, const SnmpTrap& trap) {
+        std::span<const uint8_t> packet = protocol.build_trap(trap, sink.config.community, writer);
+        // Buffers stay put until the batch is flushed
+        if (buffers.size() <= outgoing.size()) buffers.resize(outgoing.size() + 1);
+        std::vector<uint8_t>& buffer = buffers[outgoing.size()];
+        buffer.assign(packet.begin(), packet.end());
+        outgoing.push_back({buffer, sink.config.address, -1});
+        if (outgoing.size() >= std::max<size_t>(options.batch, 1)) flush();
+    }
+
+    /**
+     * @brief Sends the trap at once when the sink has a token and nothing
+     * waiting, otherwise puts it in the backlog (replacing a waiting trap
+     * about the same objects)
+     */
+    inline void admit(Sink& sink, const TrapPtr& trap, uint64_t subject) {
+        if (sink.backlog.empty() && sink.take_token()) {
+            send_to(sink, *trap);
+            return;
+        }
+
+        auto range = sink.by_subject.equal_range(subject);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (same_subject(*it->second->trap, *trap)) {
+                it->second->trap = trap; // Latest state, place in line kept
+                coalesced_count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        if (sink.backlog.size() >= std::max<size_t>(options.max_backlog, 1)) {
+            sink.pop_front();
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        sink.backlog.push_back({subject, trap});
+        sink.by_subject.emplace(subject, std::prev(sink.backlog.end()));
+    }
+
+    /**
+     * @brief Sends what the tokens allow from each backlog.
+     * @return Time until the next token of a sink still waiting (zero: none waiting)
+     */
+    inline Clock::duration drain_backlogs(Clock::time_point now) {
+        Clock::duration next = Clock::duration::zero();
+        for (Sink& sink : sinks) {
+            sink.refill(now);
+            while (!sink.backlog.empty() && sink.take_token()) {
+                send_to(sink, *sink.backlog.front().trap);
+                sink.pop_front();
+            }
+            if (!sink.backlog.empty()) {
+                auto until = std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>((1 - sink.tokens) / sink.config.rate));
+                if (next == Clock::duration::zero() || until < next) next = until;
+            }
+        }
+        return next;
+    }
+
+    /**
+     * @brief Takes every queued trap and hands it to the sinks
+     */
+    inline bool take_queued() {
+        SnmpTrap trap;
+        bool any = false;
+        Clock::time_point now = Clock::now();
+        for (Sink& sink : sinks) sink.refill(now);
+        while (queue.try_pop(trap)) {
+            any = true;
+            TrapPtr shared = std::make_shared<const SnmpTrap>(std::move(trap));
+            uint64_t subject = subject_of(*shared);
+            for (Sink& sink : sinks) admit(sink, shared, subject);
+        }
+        return any;
+    }
+
+    inline void park() {
+        parked.store(true, std::memory_order_seq_cst);
+        wake_pending.store(false, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32_t signal = wake_signal.load(std::memory_order_seq_cst);
+        // A trap pushed before parked was visible has not woken anyone
+        if (!take_queued() && !stopping.load(std::memory_order_seq_cst))
+            wake_signal.wait(signal, std::memory_order_seq_cst);
+        parked.store(false, std::memory_order_seq_cst);
+    }
+
+    inline void run() {
+        while (!stopping.load(std::memory_order_acquire)) {
+            take_queued();
+            Clock::duration wait = drain_backlogs(Clock::now());
+            flush();
+
+            if (wait == Clock::duration::zero()) park();
+            else std::this_thread::sleep_for(std::min<Clock::duration>(wait, MAX_WAIT));
+        }
+
+        // Last round: what the tokens allow goes out, the rest is dropped
+        take_queued();
+        drain_backlogs(Clock::now());
+        flush();
+        for (Sink& sink : sinks) {
+            dropped_count.fetch_add(sink.backlog.size(), std::memory_order_relaxed);
+            sink.backlog.clear();
+            sink.by_subject.clear();
+        }
+    }
+
+public:
+    explicit TrapSender(std::vector<TrapSink> trap_sinks, TrapSenderOptions opts = {})
+        : options(opts),
+          transport(std::max<size_t>(opts.batch, 1), 1),
+          queue(opts.queue_capacity) {
+        socket_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (socket_fd < 0) throw std::runtime_error("Failed to create the trap socket.");
+
+        for (TrapSink& config : trap_sinks) {
+            Sink sink;
+            sink.tokens = config.burst;
+            sink.refilled = started;
+            sink.config = std::move(config);
+            sinks.push_back(std::move(sink));
+        }
+        sender_thread = std::thread(&TrapSender::run, this);
+    }
+
+    ~TrapSender() {
+        stop();
+        close(socket_fd);
+    }
+
+    TrapSender(const TrapSender&) = delete;
+    TrapSender& operator=(const TrapSender&) = delete;
+
+    /**
+     * @brief sysUpTime of the traps: hundredths of a second since construction
+     */
+    inline uint32_t uptime() const {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - started).count() / 10);
+    }
+
+    /**
+     * @brief Enqueues a trap for every sink (any thread, never blocks).
+     * The time stamp is taken now; agent_addr defaults to the options'.
+     * @return false when the queue is full or the sender stopped (trap dropped)
+     */
+    inline bool send(SnmpTrap trap) {
+        if (stopping.load(std::memory_order_relaxed)) return false;
+        trap.time_stamp = uptime();
+        if (trap.agent_addr == 0) trap.agent_addr = options.agent_address;
+        if (!queue.try_push(trap)) {
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        wake();
+        return true;
+    }
+
+    /**
+     * @brief linkDown/linkUp trap for an interface (varbinds ifIndex,
+     * ifAdminStatus, ifOperStatus as in RFC 2863's notifications)
+     */
+    inline bool send_link(bool up, uint32_t if_index, int64_t admin_status, int64_t oper_status, const OID& enterprise) {
+        SnmpTrap trap;
+        trap.enterprise = enterprise;
+        trap.generic_trap = up ? GenericTrap::LINK_UP : GenericTrap::LINK_DOWN;
+        trap.varbinds.push_back({{1,3,6,1,2,1,2,2,1,1,if_index}, static_cast<uint8_t>(DataType::INTEGER), int64_t{if_index}});
+        trap.varbinds.push_back({{1,3,6,1,2,1,2,2,1,7,if_index}, static_cast<uint8_t>(DataType::INTEGER), admin_status});
+        trap.varbinds.push_back({{1,3,6,1,2,1,2,2,1,8,if_index}, static_cast<uint8_t>(DataType::INTEGER), oper_status});
+        return send(std::move(trap));
+    }
+
+    /**
+     * @brief Sends what the sinks' tokens allow, drops the rest, and stops
+     * the sender thread
+     */
+    inline void stop() {
+        if (stopping.exchange(true)) return;
+        wake_signal.fetch_add(1, std::memory_order_seq_cst);
+        wake_signal.notify_one();
+        if (sender_thread.joinable()) sender_thread.join();
+    }
+
+    inline uint64_t sent() const { return sent_count.load(std::memory_order_relaxed); }
+    inline uint64_t coalesced() const { return coalesced_count.load(std::memory_order_relaxed); }
+    inline uint64_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+};
+
+} //SnmpServer
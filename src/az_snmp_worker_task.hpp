@@ -2,40 +2,176 @@
 
 #include "az_snmp_global.hpp"
 #include "az_snmp_prot_handler.hpp"
+#include "az_snmp_arena.hpp"
+#include "az_snmp_coalescer.hpp"
+#include "az_snmp_stats.hpp"
+#include "az_snmp_trace.hpp"
 
 namespace SnmpServer {
 
+/**
+ * @brief Counts the packets the listener just received and picks those whose
+ * stages are timed (one in AZ_SNMP_STATS_SAMPLE)
+ */
+inline void mark_received(SnmpPacketBatch& batch) {
+    stat_count(StatCounter::PACKETS_IN, batch.size());
+    for (auto& context : batch)
+        context->received_at = stat_sample();
+}
+
+inline bool is_timed(const SnmpPacketContext& context) {
+    return context.received_at != StatClock::time_point{};
+}
+
+/**
+ * @brief Decodes one request (DECODE stage when timed)
+ * @return nullopt for a malformed datagram, which gets no response
+ */
+inline std::optional<SnmpPdu> decode_request(SnmpProtocolHandler& handler, const SnmpPacketContext& context, RequestArena& arena) {
+    StageTimer timer(is_timed(context));
+    auto snmp_pdu = handler.process_request(context.raw_data, arena.allocator());
+    timer.stop(StatStage::DECODE);
+    return snmp_pdu;
+}
+
+/**
+ * @brief Encodes the response, through the coalescer when there is one.
+ * Timed requests split the time into MIB reads and encoding.
+ */
+inline std::span<const uint8_t> encode_response(SnmpProtocolHandler& handler, const SnmpPdu& snmp_pdu, BerWriter& writer,
+                                                RequestCoalescer* coalescer, bool timed) {
+    if (!AZ_SNMP_STATS || !timed)
+        return coalescer ? coalescer->respond(handler, snmp_pdu, writer) : handler.resp_get(snmp_pdu, writer);
+
+    StageTimer timer(true);
+    MibStageClock::start();
+    std::span<const uint8_t> response;
+    try {
+        response = coalescer ? coalescer->respond(handler, snmp_pdu, writer) : handler.resp_get(snmp_pdu, writer);
+    } catch (...) {
+        MibStageClock::stop();
+        throw;
+    }
+    StatClock::duration mib_time = MibStageClock::stop();
+    AgentStats& stats = AgentStats::instance();
+    stats.record(StatStage::MIB, mib_time);
+    stats.record(StatStage::ENCODE, timer.elapsed() - mib_time);
+    return response;
+}
+
 /**
  * @brief The actual logic executed by the worker threads.
- * Receives all necessary dependencies (Context, Mib, Connect)
+ * Receives all necessary dependencies (Context, Mib, Connect, optional Coalescer)
+ * The context goes back to its pool when the task returns.
  */
 inline void WorkerTask(
-    std::shared_ptr<SnmpPacketContext> context,
+    PacketPtr context,
     MibIntf* mib_service,
     ConnectIntf* connect_service,
-    int listener_socket_fd
+    int listener_socket_fd,
+    RequestCoalescer* coalescer = nullptr
 ) {
     // Handler is instantiated inside the worker for complete thread-safety
     SnmpProtocolHandler handler(mib_service);
 
+    // Encode buffer and decode arena are reused by every request served on this thread
+    thread_local BerWriter writer;
+    RequestArena& arena = RequestArena::local();
+    arena.reset();
+
     try {
-        std::cout << "[Worker] Processing request from: "
+        AZ_SNMP_LOG(DEBUG, "[Worker] Processing request from: "
                   << inet_ntoa(context->client_addr.sin_addr)
-                  << " on thread " << std::this_thread::get_id() << std::endl;
+                  << " on thread " << std::this_thread::get_id());
 
         // Deserialize the request
-        auto snmp_pdu = handler.process_request(context->raw_data);
+        auto snmp_pdu = decode_request(handler, *context, arena);
+        if (!snmp_pdu) {
+            AZ_SNMP_LOG(DEBUG, "[Worker] Malformed request dropped.");
+            return;
+        }
 
         // Serialize the Response PDU
-        std::vector<uint8_t> response_data = handler.resp_get(snmp_pdu);
+        std::span<const uint8_t> response_data = encode_response(handler, *snmp_pdu, writer, coalescer, is_timed(*context));
 
         // Send the response back (via injected interface and context address)
-        connect_service->send(listener_socket_fd, response_data, context->client_addr);
-        std::cout << "[Worker] Response sent successfully." << std::endl;
+        StageTimer send_timer(is_timed(*context));
+        int reply_fd = context->socket_fd >= 0 ? context->socket_fd : listener_socket_fd;
+        connect_service->send(reply_fd, response_data, context->client_addr);
+        send_timer.stop(StatStage::SEND);
+        stat_count(StatCounter::PACKETS_OUT);
+        AZ_SNMP_LOG(DEBUG, "[Worker] Response sent successfully.");
+
+    } catch (const std::exception& e) {
+        stat_count(StatCounter::DROPS);
+        AZ_SNMP_LOG(ERROR, "WORKER ERROR: " << e.what());
+    }
+}
+
+/**
+ * @brief Serves a batch of packets received together on the calling thread.
+ * Every response is encoded into its own writer, then all are flushed
+ * with one send_batch call.
+ */
+inline void serve_batch(
+    const SnmpPacketBatch& batch,
+    MibIntf* mib_service,
+    ConnectIntf* connect_service,
+    int listener_socket_fd,
+    RequestCoalescer* coalescer = nullptr
+) {
+    SnmpProtocolHandler handler(mib_service);
+
+    // Writers and the send list grow to the largest batch seen, then stay
+    thread_local std::vector<BerWriter> writers;
+    thread_local std::vector<SnmpOutPacket> responses;
+
+    if (writers.size() < batch.size()) writers.resize(batch.size());
+    responses.clear();
+
+    RequestArena& arena = RequestArena::local();
+    bool timed = false;
 
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const SnmpPacketContext& context = *batch[i];
+        timed = timed || is_timed(context);
+        // The previous PDU went out of scope with the last iteration
+        arena.reset();
+        try {
+            auto snmp_pdu = decode_request(handler, context, arena);
+            if (!snmp_pdu) continue; // Malformed: no response
+            auto response = encode_response(handler, *snmp_pdu, writers[i], coalescer, is_timed(context));
+            responses.push_back({response, context.client_addr, context.socket_fd});
+        } catch (const std::exception& e) {
+            stat_count(StatCounter::DROPS);
+            AZ_SNMP_LOG(ERROR, "WORKER ERROR: " << e.what());
+        }
+    }
+
+    try {
+        // One send for the batch: timed when any of its requests is
+        StageTimer send_timer(timed);
+        connect_service->send_batch(listener_socket_fd, responses);
+        send_timer.stop(StatStage::SEND);
+        stat_count(StatCounter::PACKETS_OUT, responses.size());
+        AZ_SNMP_LOG(DEBUG, "[Worker] " << responses.size() << " responses sent.");
     } catch (const std::exception& e) {
-        std::cerr << "WORKER ERROR: " << e.what() << std::endl;
+        stat_count(StatCounter::DROPS, responses.size());
+        AZ_SNMP_LOG(ERROR, "WORKER ERROR: " << e.what());
     }
 }
 
+/**
+ * @brief Worker logic for a batch handed over by the listener
+ */
+inline void WorkerBatchTask(
+    SnmpPacketBatch batch,
+    MibIntf* mib_service,
+    ConnectIntf* connect_service,
+    int listener_socket_fd,
+    RequestCoalescer* coalescer = nullptr
+) {
+    serve_batch(batch, mib_service, connect_service, listener_socket_fd, coalescer);
+}
+
 } //SnmpServer
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_async.hpp"
+#include "../src/az_snmp_thread_poll.hpp"
+
+using namespace SnmpServer;
+
+/**
+ * @brief Transport keeping the responses sent and the threads sending them
+ */
+class WaitingConnect : public ConnectIntf {
+private:
+    std::mutex mutex;
+    std::condition_variable arrived;
+public:
+    std::vector<std::vector<uint8_t>> sent;
+    std::vector<std::thread::id> senders;
+
+    int init_socket(int) override { return -1; }
+    PacketPtr receive(int) override { return nullptr; }
+
+    void send(int, std::span<const uint8_t> data, const sockaddr_in&) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        sent.emplace_back(data.begin(), data.end());
+        senders.push_back(std::this_thread::get_id());
+        arrived.notify_all();
+    }
+
+    bool wait_for(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return arrived.wait_for(lock, std::chrono::seconds(5), [&] { return sent.size() >= count; });
+    }
+};
+
+/**
+ * @brief MibMgr whose reads under a prefix take a while (a slow device)
+ */
+class SlowMib : public MibMgr {
+public:
+    OID slow_prefix{1,3,6,1,4,1,9};
+    std::atomic<bool> fail{false};
+
+    SnmpVariant read(const OID& oid) override {
+        if (oid_has_prefix(oid, slow_prefix)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (fail) throw std::runtime_error("device not answering");
+        }
+        return MibMgr::read(oid);
+    }
+};
+
+static std::vector<uint8_t> encode_request(DataType command, const std::vector<OID>& oids,
+                                           int non_repeaters = 0, int max_repetitions = 0) {
+    BerWriter writer;
+    for (auto it = oids.rbegin(); it != oids.rend(); ++it) {
+        size_t start = writer.mark();
+        writer.write_null();
+        writer.write_oid(*it);
+        writer.close(DataType::SEQUENCE, start);
+    }
+    writer.close(DataType::SEQUENCE, 0);
+    writer.write_integer(max_repetitions);
+    writer.write_integer(non_repeaters);
+    writer.write_integer(77);
+    writer.close(command, 0);
+    writer.write_octet_string("public");
+    writer.write_integer(1);
+    writer.close(DataType::SEQUENCE, 0);
+    auto data = writer.data();
+    return {data.begin(), data.end()};
+}
+
+static PacketPtr packet(const std::vector<uint8_t>& raw) {
+    PacketPtr context(new SnmpPacketContext{});
+    context->raw_data = raw;
+    return context;
+}
+
+TEST_CASE("Async answers are the synchronous handler's, byte for byte") {
+
+    MibMgr store;
+    store.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+    for (uint32_t row = 1; row <= 60; ++row) {
+        store.create({1,3,6,1,2,1,2,2,1,2,row}, std::pmr::string(20, 'x'));
+        store.create({1,3,6,1,2,1,2,2,1,10,row}, int64_t{row * 100});
+    }
+
+    ThreadPoll io(1);
+    OffloadedMib mib(&store, &io);
+    SnmpProtocolHandler handler(&store);
+
+    std::vector<std::vector<uint8_t>> requests{
+        encode_request(DataType::GET_REQUEST, {{1,3,6,1,2,1,1,5,0}, {1,3,6,1,2,1,2,2,1,10,3}, {1,3,6,1,2,1,9,9}}),
+        encode_request(DataType::GET_NEXT_REQUEST, {{1,3,6,1,2,1,1}, {1,3,6,1,2,1,2,2,1,10,60}}),
+        encode_request(DataType::GET_BULK_REQUEST, {{1,3,6,1,2,1,1}, {1,3,6,1,2,1,2,2,1,2,58}, {1,3,6,1,2,1,2,2,1,10,57}}, 1, 5),
+        encode_request(DataType::GET_BULK_REQUEST, {{1,3,6,1,2,1,2,2,1,10,55}}, 0, 10),
+        encode_request(DataType::GET_BULK_REQUEST, {{1,3,6,1,2,1,2,2,1,2}}, 0, 100), // Truncated to 1472 bytes
+    };
+
+    for (const auto& raw : requests) {
+        WaitingConnect connect;
+        AsyncWorkerTask(packet(raw), &mib, &connect, -1, nullptr);
+        REQUIRE(connect.wait_for(1));
+
+        BerWriter writer;
+        auto expected = handler.resp_get(*handler.process_request(raw), writer);
+        CHECK(connect.sent[0] == std::vector<uint8_t>(expected.begin(), expected.end()));
+    }
+}
+
+TEST_CASE("Async GETBULK stops reading once the response is full") {
+
+    // Counts the reads the I/O pool runs
+    class CountingMib : public MibMgr {
+    public:
+        std::atomic<size_t> reads{0};
+        std::tuple<OID, SnmpVariant> read_next(const OID& oid) override {
+            ++reads;
+            return MibMgr::read_next(oid);
+        }
+    } store;
+    for (uint32_t row = 1; row <= 5000; ++row)
+        store.create({1,3,6,1,2,1,2,2,1,2,row}, std::pmr::string(20, 'x'));
+
+    ThreadPoll io(1);
+    OffloadedMib mib(&store, &io);
+    WaitingConnect connect;
+    auto raw = encode_request(DataType::GET_BULK_REQUEST, {{1,3,6,1,2,1,2,2,1,2}}, 0, 5000);
+    AsyncWorkerTask(packet(raw), &mib, &connect, -1, nullptr);
+    REQUIRE(connect.wait_for(1));
+
+    // About 40 varbinds fit in 1472 bytes: one read each, plus the one that did not fit
+    CHECK(store.reads < 50);
+
+    SnmpProtocolHandler handler(&store);
+    BerWriter writer;
+    auto expected = handler.resp_get(*handler.process_request(raw), writer);
+    CHECK(connect.sent[0] == std::vector<uint8_t>(expected.begin(), expected.end()));
+}
+
+TEST_CASE("A request waiting on a slow read does not hold its worker thread") {
+
+    SlowMib store;
+    store.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+    store.create({1,3,6,1,4,1,9,1,0}, int64_t{42});
+
+    WaitingConnect connect;
+    ThreadPoll io(1);
+    ThreadPoll workers(1);
+    OffloadedMib mib(&store, &io, {{1,3,6,1,4,1,9}});
+
+    auto slow = encode_request(DataType::GET_REQUEST, {{1,3,6,1,4,1,9,1,0}});
+    auto fast = encode_request(DataType::GET_REQUEST, {{1,3,6,1,2,1,1,5,0}});
+    workers.enqueue([&] { AsyncWorkerTask(packet(slow), &mib, &connect, -1, &workers); });
+    workers.enqueue([&] { AsyncWorkerTask(packet(fast), &mib, &connect, -1, &workers); });
+
+    REQUIRE(connect.wait_for(2));
+    SnmpProtocolHandler handler(&store);
+    auto expected = [&](const std::vector<uint8_t>& raw) {
+        BerWriter writer;
+        auto response = handler.resp_get(*handler.process_request(raw), writer);
+        return std::vector<uint8_t>(response.begin(), response.end());
+    };
+    CHECK(connect.sent[0] == expected(fast));
+    CHECK(connect.sent[1] == expected(slow));
+    // Resumed on the worker pool, not on the I/O thread
+    CHECK(connect.senders[1] == connect.senders[0]);
+}
+
+TEST_CASE("A failed slow read drops the request") {
+
+    SlowMib store;
+    store.create({1,3,6,1,4,1,9,1,0}, int64_t{42});
+    store.fail = true;
+
+    WaitingConnect connect;
+    ThreadPoll io(1);
+    OffloadedMib mib(&store, &io);
+    uint64_t drops = AgentStats::instance().snapshot().counter(StatCounter::DROPS);
+
+    AsyncWorkerTask(packet(encode_request(DataType::GET_REQUEST, {{1,3,6,1,4,1,9,1,0}})), &mib, &connect, -1, nullptr);
+    auto dropped = [&] { return AgentStats::instance().snapshot().counter(StatCounter::DROPS) - drops; };
+    for (int i = 0; i < 500 && dropped() == 0; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(dropped() == 1);
+    CHECK(connect.sent.empty());
+}
+
+TEST_CASE("Malformed datagrams get no async response") {
+
+    MibMgr store;
+    WaitingConnect connect;
+    ThreadPoll io(1);
+    OffloadedMib mib(&store, &io);
+
+    AsyncWorkerTask(packet({0x30, 0x03, 0x02, 0x01}), &mib, &connect, -1, nullptr);
+    AsyncWorkerTask(packet(encode_request(DataType::GET_REQUEST, {{1,3,6,1,2,1,1,5,0}})), &mib, &connect, -1, nullptr);
+    REQUIRE(connect.wait_for(1));
+    CHECK(connect.sent.size() == 1);
+}
@@ -0,0 +1,110 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_mib_lazy.hpp"
+#include "../src/az_snmp_coalescer.hpp"
+
+using namespace SnmpServer;
+
+static std::vector<std::uint8_t> encode_get(DataType command, uint32_t req_id, std::string_view community,
+                                            const std::vector<OID>& oids, int max_repetitions = 0) {
+    BerWriter writer;
+    for (auto it = oids.rbegin(); it != oids.rend(); ++it) {
+        size_t start = writer.mark();
+        writer.write_null();
+        writer.write_oid(*it);
+        writer.close(DataType::SEQUENCE, start);
+    }
+    writer.close(DataType::SEQUENCE, 0);
+    writer.write_integer(max_repetitions);
+    writer.write_integer(0);
+    writer.write_integer(static_cast<int32_t>(req_id));
+    writer.close(command, 0);
+    writer.write_octet_string(community);
+    writer.write_integer(1);
+    writer.close(DataType::SEQUENCE, 0);
+    auto data = writer.data();
+    return {data.begin(), data.end()};
+}
+
+TEST_CASE("Identical concurrent GETs share one MIB read") {
+
+    MibMgr store;
+    store.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+
+    // Slow provider, no TTL: each uncoalesced request would run it
+    std::atomic<int> calls{0};
+    LazyMib mib(&store);
+    mib.register_subtree({1,3,6,1,2,1,2,2}, [&calls](std::vector<MibEntry>& objects) {
+        ++calls;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        objects.push_back({{1,3,6,1,2,1,2,2,1,10,1}, int64_t{42}});
+    }, std::chrono::milliseconds(0));
+
+    std::vector<OID> oids{{1,3,6,1,2,1,1,5,0}, {1,3,6,1,2,1,2,2,1,10,1}};
+    RequestCoalescer coalescer;
+
+    constexpr int POLLERS = 4;
+    std::vector<std::vector<uint8_t>> requests;
+    std::vector<std::vector<uint8_t>> responses(POLLERS);
+    for (int i = 0; i < POLLERS; ++i)
+        requests.push_back(encode_get(DataType::GET_REQUEST, 100 + i, i % 2 ? "public" : "monitoring", oids));
+
+    std::vector<std::thread> pollers;
+    for (int i = 0; i < POLLERS; ++i) {
+        pollers.emplace_back([&, i] {
+            SnmpProtocolHandler handler(&mib);
+            BerWriter writer;
+            SnmpPdu pdu = *handler.process_request(requests[i]);
+            auto response = coalescer.respond(handler, pdu, writer);
+            responses[i].assign(response.begin(), response.end());
+        });
+    }
+    for (auto& poller : pollers) poller.join();
+
+    CHECK(coalescer.leaders() + coalescer.coalesced() == POLLERS);
+    CHECK(coalescer.leaders() == static_cast<uint64_t>(calls));
+    CHECK(calls < POLLERS);
+
+    // Every poller gets its own req_id and community around the same values
+    MibMgr expected_mib;
+    expected_mib.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+    expected_mib.create({1,3,6,1,2,1,2,2,1,10,1}, int64_t{42});
+    SnmpProtocolHandler expected(&expected_mib);
+    for (int i = 0; i < POLLERS; ++i)
+        CHECK(responses[i] == expected.resp_get(*expected.process_request(requests[i])));
+}
+
+TEST_CASE("Coalesced GETBULK respects each response's size limit") {
+
+    MibMgr mib;
+    for (uint32_t row = 1; row <= 100; ++row)
+        mib.create({1,3,6,1,2,1,2,2,1,2,row}, "ethernet-csmacd");
+
+    SnmpProtocolHandler handler(&mib, 300);
+    BerWriter writer;
+    // raw_vars points into the request buffer: keep it alive
+    std::vector<uint8_t> request = encode_get(DataType::GET_BULK_REQUEST, 1, "public", {{1,3,6,1,2,1,2,2,1,2}}, 50);
+    SnmpPdu pdu = *handler.process_request(request);
+
+    // The list was filled up to the limit with "public": a longer community no longer fits
+    handler.write_varbind_list(pdu, writer);
+    std::vector<uint8_t> varbinds(writer.data().begin(), writer.data().end());
+    CHECK(handler.respond_with_varbinds(pdu, varbinds, writer).has_value());
+
+    std::vector<uint8_t> raw = encode_get(DataType::GET_BULK_REQUEST, 2, std::string(40, 'c'), {{1,3,6,1,2,1,2,2,1,2}}, 50);
+    SnmpPdu longer = *handler.process_request(raw);
+    CHECK_FALSE(handler.respond_with_varbinds(longer, varbinds, writer).has_value());
+
+    // Sequential requests never coalesce
+    RequestCoalescer coalescer;
+    coalescer.respond(handler, pdu, writer);
+    coalescer.respond(handler, pdu, writer);
+    CHECK(coalescer.leaders() == 2);
+    CHECK(coalescer.coalesced() == 0);
+}
@@ -0,0 +1,115 @@
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_epoll_connect.hpp"
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_thread_poll.hpp"
+#include "../src/az_snmp_listener.hpp"
+#include "../src/az_snmp_sharded_listener.hpp"
+
+using namespace SnmpServer;
+
+// GET 1.3.6.1.2.1.1.5.0, community "public"
+static const std::vector<uint8_t> GET_SYS_NAME = {
+    0x30,0x29,0x02,0x01,0x00,0x04,0x06,0x70,0x75,0x62,0x6C,0x69,0x63,0xA0,0x1C,0x02,
+    0x04,0x20,0xA5,0xD3,0xE3,0x02,0x01,0x00,0x02,0x01,0x00,0x30,0x0E,0x30,0x0C,0x06,
+    0x08,0x2B,0x06,0x01,0x02,0x01,0x01,0x05,0x00,0x05,0x00};
+
+/**
+ * @brief Sends the GET to the agent on loopback, returns the answer and the
+ * port it came from (empty answer on timeout)
+ */
+static std::string ask(int port, int& from_port) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval tv{2, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    sockaddr_in agent{};
+    agent.sin_family = AF_INET;
+    agent.sin_port = htons(port);
+    agent.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sendto(sock, GET_SYS_NAME.data(), GET_SYS_NAME.size(), 0, (sockaddr*)&agent, sizeof(agent));
+
+    char buf[1500];
+    sockaddr_in from{};
+    socklen_t from_len = sizeof(from);
+    ssize_t len = recvfrom(sock, buf, sizeof(buf), 0, (sockaddr*)&from, &from_len);
+    close(sock);
+
+    from_port = ntohs(from.sin_port);
+    return len > 0 ? std::string(buf, len) : std::string();
+}
+
+TEST_CASE("One event loop serves several ports and answers through each") {
+
+    EpollConnectMgr connect;
+    MibMgr mib;
+    mib.create({1,3,6,1,2,1,1,5,0}, "epoll-agent");
+    ThreadPoll pool(2);
+
+    SnmpListener listener(&connect, &pool, &mib);
+    listener.start(0);
+    // Second port on one interface, added while the loop is running
+    connect.add_endpoint(listener.socket_fd(), 0, "127.0.0.1");
+    std::vector<int> ports = connect.ports(listener.socket_fd());
+    REQUIRE(ports.size() == 2);
+
+    for (int port : ports) {
+        int from_port = 0;
+        std::string response = ask(port, from_port);
+        CHECK(response.find("epoll-agent") != std::string::npos);
+        CHECK(from_port == port);
+    }
+
+    CHECK_THROWS(connect.add_endpoint(listener.socket_fd(), 0, "not-an-address"));
+    listener.stop();
+}
+
+TEST_CASE("Interrupting a loop stops its listener at once, without traffic") {
+
+    EpollConnectMgr connect;
+    MibMgr mib;
+    ThreadPoll pool(1);
+
+    SnmpListener listener(&connect, &pool, &mib);
+    listener.start(0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto begin = std::chrono::steady_clock::now();
+    listener.stop();
+    CHECK(std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(500));
+
+    // An interrupted loop never blocks again
+    int handle = connect.init_socket(0);
+    connect.interrupt(handle);
+    SnmpPacketBatch batch;
+    CHECK(connect.receive_batch(handle, batch) == 0);
+    CHECK(connect.receive(handle) == nullptr);
+    connect.close_socket(handle);
+    CHECK_THROWS(connect.interrupt(handle));
+}
+
+TEST_CASE("Sharded listeners run one event loop each") {
+
+    EpollConnectMgr connect;
+    MibMgr mib;
+    mib.create({1,3,6,1,2,1,1,5,0}, "epoll-shard");
+
+    // Free port for both SO_REUSEPORT loops
+    int probe = connect.init_socket(0);
+    int port = connect.ports(probe).front();
+    connect.close_socket(probe);
+
+    ShardedSnmpListener listener(&connect, &mib, 2);
+    listener.start(port);
+
+    for (int i = 0; i < 8; ++i) {
+        int from_port = 0;
+        CHECK(ask(port, from_port).find("epoll-shard") != std::string::npos);
+        CHECK(from_port == port);
+    }
+    listener.stop();
+}
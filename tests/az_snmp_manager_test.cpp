@@ -0,0 +1,196 @@
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_epoll_connect.hpp"
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_thread_poll.hpp"
+#include "../src/az_snmp_listener.hpp"
+#include "../src/az_snmp_manager.hpp"
+
+using namespace SnmpServer;
+
+/**
+ * @brief Callback results, gathered from the manager's I/O thread
+ */
+struct Results {
+    std::mutex mutex;
+    std::condition_variable done;
+    std::vector<PollResult> results;
+
+    PollCallback callback() {
+        return [this](PollResult& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(std::move(result));
+            done.notify_all();
+        };
+    }
+
+    bool wait_for(size_t count, std::chrono::milliseconds limit = std::chrono::seconds(5)) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return done.wait_for(lock, limit, [&] { return results.size() >= count; });
+    }
+};
+
+/**
+ * @brief UDP socket on a loopback ephemeral port, standing in for an agent
+ */
+static int bind_loopback(int& port) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval tv{2, 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    sockaddr_in addr = SnmpManager::make_target("127.0.0.1", 0);
+    bind(sock, (sockaddr*)&addr, sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(sock, (sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+    return sock;
+}
+
+TEST_CASE("Thousands of outstanding requests are answered by a loopback agent") {
+
+    EpollConnectMgr connect;
+    MibMgr mib;
+    for (uint32_t row = 1; row <= 100; ++row) mib.create({1,3,6,1,2,1,2,2,1,10,row}, int64_t{row * 7});
+    mib.create({1,3,6,1,2,1,1,5,0}, "polled-agent");
+    ThreadPoll pool(2);
+    SnmpListener listener(&connect, &pool, &mib);
+    listener.start(0);
+    sockaddr_in agent = SnmpManager::make_target("127.0.0.1", connect.ports(listener.socket_fd())[0]);
+
+    SnmpManagerOptions options;
+    options.sockets = 2;
+    options.timeout = std::chrono::milliseconds(500);
+    options.retries = 3;
+    options.max_in_flight = 200; // Within the agent's default socket buffer
+    SnmpManager manager(options);
+
+    Results results;
+    const size_t GETS = 3000;
+    for (uint32_t i = 0; i < GETS; ++i)
+        CHECK(manager.get(agent, {{1,3,6,1,2,1,2,2,1,10,i % 100 + 1}, {1,3,6,1,2,1,1,5,0}}, results.callback()));
+    manager.get_next(agent, {{1,3,6,1,2,1,2,2,1,10,50}}, results.callback());
+    manager.get_bulk(agent, 0, 10, {{1,3,6,1,2,1,2,2,1,10}}, results.callback());
+    REQUIRE(results.wait_for(GETS + 2));
+
+    size_t ok = 0;
+    for (const PollResult& result : results.results) {
+        REQUIRE(result.status == PollStatus::OK);
+        const SnmpPdu& pdu = result.pdu;
+        if (pdu.vars.size() == 2) {
+            uint32_t row = pdu.vars[0].oid.back();
+            ok += std::get<int64_t>(pdu.vars[0].value) == row * 7 &&
+                  std::get<std::pmr::string>(pdu.vars[1].value) == "polled-agent";
+        } else if (pdu.vars.size() == 1) {
+            ok += pdu.vars[0].oid == OID{1,3,6,1,2,1,2,2,1,10,51} && std::get<int64_t>(pdu.vars[0].value) == 357;
+        } else {
+            ok += pdu.vars.size() == 10 && pdu.vars[9].oid == OID{1,3,6,1,2,1,2,2,1,10,10};
+        }
+    }
+    CHECK(ok == GETS + 2);
+    CHECK(manager.responses() == GETS + 2);
+    CHECK(manager.unmatched() == 0);
+
+    // Past the last object: an answer, with the exception in the varbind
+    Results end;
+    manager.get_next(agent, {{1,3,6,1,2,1,2,2,1,10,100}}, end.callback());
+    REQUIRE(end.wait_for(1));
+    CHECK(std::holds_alternative<ErrorCode>(end.results[0].pdu.vars[0].value));
+    CHECK(end.results[0].pdu.vars[0].type == std::get<ErrorCode>(end.results[0].pdu.vars[0].value));
+
+    manager.stop();
+    listener.stop();
+}
+
+TEST_CASE("Requests are retried until answered, from the agent's address only") {
+
+    int port = 0;
+    int agent_sock = bind_loopback(port);
+    int other_port = 0;
+    int other_sock = bind_loopback(other_port);
+
+    SnmpManagerOptions options;
+    options.timeout = std::chrono::milliseconds(50);
+    options.retries = 2;
+    SnmpManager manager(options);
+    Results results;
+    manager.get(SnmpManager::make_target("127.0.0.1", port), {{1,3,6,1,2,1,1,5,0}}, results.callback());
+
+    MibMgr mib;
+    mib.create({1,3,6,1,2,1,1,5,0}, "late-agent");
+    SnmpProtocolHandler protocol(&mib);
+    uint8_t buf[1500];
+    sockaddr_in from{};
+    socklen_t from_len = sizeof(from);
+
+    // First attempt: answered from another port, which must be ignored
+    ssize_t len = recvfrom(agent_sock, buf, sizeof(buf), 0, (sockaddr*)&from, &from_len);
+    REQUIRE(len > 0);
+    SnmpPdu first = *protocol.process_request({buf, static_cast<size_t>(len)});
+    CHECK(first.command == "GET_REQUEST");
+    std::vector<uint8_t> response = protocol.resp_get(first);
+    sendto(other_sock, response.data(), response.size(), 0, (sockaddr*)&from, from_len);
+
+    // Retry: same req_id, answered properly this time
+    len = recvfrom(agent_sock, buf, sizeof(buf), 0, (sockaddr*)&from, &from_len);
+    REQUIRE(len > 0);
+    SnmpPdu retry = *protocol.process_request({buf, static_cast<size_t>(len)});
+    CHECK(retry.req_id == first.req_id);
+    response = protocol.resp_get(retry);
+    sendto(agent_sock, response.data(), response.size(), 0, (sockaddr*)&from, from_len);
+
+    REQUIRE(results.wait_for(1));
+    CHECK(results.results[0].status == PollStatus::OK);
+    CHECK(results.results[0].attempts == 2);
+    CHECK(std::get<std::pmr::string>(results.results[0].pdu.vars[0].value) == "late-agent");
+    CHECK(manager.unmatched() == 1);
+
+    // Silent agent: 1 + retries datagrams, then a timeout
+    Results silent;
+    manager.get(SnmpManager::make_target("127.0.0.1", port), {{1,3,6,1,2,1,1,5,0}}, silent.callback());
+    REQUIRE(silent.wait_for(1));
+    CHECK(silent.results[0].status == PollStatus::TIMEOUT);
+    CHECK(silent.results[0].attempts == 3);
+    int received = 0;
+    while (recv(agent_sock, buf, sizeof(buf), MSG_DONTWAIT) > 0) ++received;
+    CHECK(received == 3);
+    CHECK(manager.timeouts() == 1);
+
+    close(agent_sock);
+    close(other_sock);
+}
+
+TEST_CASE("Stopping the manager cancels the requests in flight and waiting") {
+
+    int port = 0;
+    int agent_sock = bind_loopback(port);
+
+    SnmpManagerOptions options;
+    options.timeout = std::chrono::seconds(30);
+    options.max_in_flight = 4;
+    SnmpManager manager(options);
+    Results results;
+    for (int i = 0; i < 10; ++i)
+        manager.get(SnmpManager::make_target("127.0.0.1", port), {{1,3,6,1,2,1,1,5,0}}, results.callback());
+
+    // Only the first four are sent
+    uint8_t buf[1500];
+    int received = 0;
+    while (received < 10 && recv(agent_sock, buf, sizeof(buf), 0) > 0) {
+        ++received;
+        timeval tv{0, 200000};
+        setsockopt(agent_sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+    CHECK(received == 4);
+
+    manager.stop();
+    REQUIRE(results.results.size() == 10);
+    for (const PollResult& result : results.results) CHECK(result.status == PollStatus::CANCELLED);
+    CHECK_FALSE(manager.get(SnmpManager::make_target("127.0.0.1", port), {{1,3,6,1,2,1,1,5,0}}, results.callback()));
+    CHECK_THROWS(SnmpManager::make_target("localhost"));
+
+    close(agent_sock);
+}
@@ -0,0 +1,118 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_mib_cache.hpp"
+#include "../src/az_snmp_mib_concurrent.hpp"
+#include "../src/az_snmp_prot_handler.hpp"
+
+using namespace SnmpServer;
+
+static SnmpPdu get_pdu(std::vector<OID> oids) {
+    SnmpPdu pdu;
+    pdu.version = 1;
+    pdu.community = "public";
+    pdu.command = "GET_REQUEST";
+    pdu.req_id = 1234;
+    for (OID& oid : oids) pdu.vars.push_back({std::move(oid), 0, std::monostate{}});
+    return pdu;
+}
+
+TEST_CASE("Cached GET answers match the uncached encoder") {
+
+    MibMgr mib;
+    mib.create({1,3,6,1,2,1,1,1,0}, "SNMP Server C++ Header-Only Library"); // sysDescr
+    mib.create({1,3,6,1,2,1,1,5,0}, "agent-01");                             // sysName
+    mib.create({1,3,6,1,2,1,2,1,0}, int64_t{4});                             // ifNumber
+
+    CachedMib cache(&mib, {{1,3,6,1,2,1,1}});
+    SnmpProtocolHandler plain(&mib);
+    SnmpProtocolHandler cached(&cache);
+
+    SnmpPdu pdu = get_pdu({{1,3,6,1,2,1,1,1,0}, {1,3,6,1,2,1,1,5,0}, {1,3,6,1,2,1,2,1,0}, {1,3,6,1,2,1,1,9,0}});
+    std::vector<uint8_t> expected = plain.resp_get(pdu);
+
+    // First GET fills the cache, the second is served from it
+    CHECK(cached.resp_get(pdu) == expected);
+    CHECK(cache.misses() == 3);
+    CHECK(cache.hits() == 0);
+    CHECK(cache.size() == 2); // Outside the subtree and missing objects are not kept
+
+    CHECK(cached.resp_get(pdu) == expected);
+    CHECK(cache.hits() == 2);
+    CHECK(cache.misses() == 4);
+}
+
+TEST_CASE("Writes through the cache invalidate the encoded answer") {
+
+    MibMgr mib;
+    mib.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+
+    CachedMib cache(&mib);
+    SnmpProtocolHandler plain(&mib);
+    SnmpProtocolHandler cached(&cache);
+    SnmpPdu pdu = get_pdu({{1,3,6,1,2,1,1,5,0}, {1,3,6,1,2,1,1,6,0}});
+
+    cached.resp_get(pdu);
+    CHECK(cache.size() == 1);
+
+    cache.update({1,3,6,1,2,1,1,5,0}, "agent-02");
+    CHECK(cache.invalidations() == 1);
+    CHECK(cached.resp_get(pdu) == plain.resp_get(pdu));
+
+    // Missing answers were never stored: the new object shows up at once
+    cache.create({1,3,6,1,2,1,1,6,0}, "lab");
+    CHECK(cached.resp_get(pdu) == plain.resp_get(pdu));
+    CHECK(cache.size() == 2);
+
+    cache.delete_oid({1,3,6,1,2,1,1,5,0});
+    CHECK(cache.size() == 1);
+    CHECK(cached.resp_get(pdu) == plain.resp_get(pdu));
+}
+
+TEST_CASE("Readers through the cache never see part of a batch") {
+
+    // Widens the window between the store publishing a batch and its return
+    class SlowBatchMib : public ConcurrentMibMgr {
+    public:
+        void apply_batch(std::span<const MibEntry> upserts, std::span<const OID> deletes = {}) override {
+            ConcurrentMibMgr::apply_batch(upserts, deletes);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    } store;
+
+    // ifDescr is cached, ifInOctets is not: one batch writes both columns of the row
+    const OID descr{1,3,6,1,2,1,2,2,1,2,1};
+    const OID octets{1,3,6,1,2,1,2,2,1,10,1};
+    store.create(descr, "gen-0");
+    store.create(octets, int64_t{0});
+    CachedMib cache(&store, {{1,3,6,1,2,1,2,2,1,2}});
+
+    std::atomic<bool> done{false};
+    std::atomic<int> mixed{0};
+    std::thread reader([&] {
+        while (!done) {
+            // The cached column is read last: it must be at least as new
+            int64_t newer = std::get<int64_t>(cache.read(octets));
+            std::string encoded;
+            cache.read_encoded(descr, [&](std::span<const uint8_t> varbind) {
+                encoded.assign(varbind.begin(), varbind.end());
+            });
+            size_t gen = encoded.rfind("gen-");
+            if (gen == std::string::npos || std::stoll(encoded.substr(gen + 4)) < newer) ++mixed;
+        }
+    });
+
+    for (int64_t gen = 1; gen <= 500; ++gen) {
+        std::vector<MibEntry> row{{descr, std::pmr::string("gen-" + std::to_string(gen))}, {octets, gen}};
+        cache.apply_batch(row);
+    }
+    done = true;
+    reader.join();
+    CHECK(mixed == 0);
+    CHECK(cache.hits() > 0);
+}
@@ -0,0 +1,144 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_mib_concurrent.hpp"
+#include "../src/az_snmp_mib_lazy.hpp"
+
+using namespace SnmpServer;
+
+/**
+ * @brief ifInOctets / ifOutOctets for two interfaces, counting the calls
+ */
+static MibProvider if_counters(std::atomic<int>& calls) {
+    return [&calls](std::vector<MibEntry>& objects) {
+        int call = ++calls;
+        for (uint32_t column : {16u, 10u})
+            for (uint32_t row : {2u, 1u})
+                objects.push_back({{1,3,6,1,2,1,2,2,1,column,row}, int64_t{call * 1000 + column * 10 + row}});
+        objects.push_back({{1,3,6,1,4,1,1}, int64_t{0}}); // Outside the subtree: dropped
+    };
+}
+
+TEST_CASE("Provided subtree is computed on demand and merged with the store") {
+
+    MibMgr store;
+    store.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+    store.create({1,3,6,1,2,1,4,1,0}, int64_t{2});
+
+    std::atomic<int> calls{0};
+    LazyMib mib(&store);
+    mib.register_subtree({1,3,6,1,2,1,2,2}, if_counters(calls), std::chrono::hours(1));
+    CHECK(calls == 0);
+
+    CHECK(std::get<int64_t>(mib.read({1,3,6,1,2,1,2,2,1,10,2})) == 1102);
+    CHECK(std::get<std::pmr::string>(mib.read({1,3,6,1,2,1,1,5,0})) == "agent-01");
+    CHECK(std::holds_alternative<std::monostate>(mib.read({1,3,6,1,2,1,2,2,1,99,1})));
+
+    auto [next, value] = mib.read_next({1,3,6,1,2,1,1,5,0});
+    CHECK(next == OID{1,3,6,1,2,1,2,2,1,10,1});
+    auto [after, after_value] = mib.read_next({1,3,6,1,2,1,2,2,1,16,2});
+    CHECK(after == OID{1,3,6,1,2,1,4,1,0});
+
+    std::vector<OID> walked;
+    mib.walk({1,3}, [&](const OID& oid, const SnmpVariant&) {
+        walked.push_back(oid);
+        return true;
+    });
+    CHECK(walked == std::vector<OID>{
+        {1,3,6,1,2,1,1,5,0},
+        {1,3,6,1,2,1,2,2,1,10,1}, {1,3,6,1,2,1,2,2,1,10,2},
+        {1,3,6,1,2,1,2,2,1,16,1}, {1,3,6,1,2,1,2,2,1,16,2},
+        {1,3,6,1,2,1,4,1,0}});
+
+    // Every lookup above shared one snapshot
+    CHECK(calls == 1);
+
+    // Provided objects are read-only, the rest reaches the store
+    mib.update({1,3,6,1,2,1,2,2,1,10,1}, int64_t{0});
+    mib.update({1,3,6,1,2,1,4,1,0}, int64_t{1});
+    CHECK(std::get<int64_t>(mib.read({1,3,6,1,2,1,2,2,1,10,1})) == 1101);
+    CHECK(std::get<int64_t>(store.read({1,3,6,1,2,1,4,1,0})) == 1);
+
+    CHECK_THROWS(mib.register_subtree({1,3,6,1,2,1,2}, if_counters(calls), std::chrono::hours(1)));
+}
+
+TEST_CASE("Provided values expire after the TTL") {
+
+    MibMgr store;
+    std::atomic<int> calls{0};
+    LazyMib mib(&store);
+    mib.register_subtree({1,3,6,1,2,1,2,2}, if_counters(calls), std::chrono::milliseconds(1));
+
+    CHECK(std::get<int64_t>(mib.read({1,3,6,1,2,1,2,2,1,10,1})) == 1101);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    CHECK(std::get<int64_t>(mib.read({1,3,6,1,2,1,2,2,1,10,1})) == 2101);
+    CHECK(mib.provider_calls() == 2);
+
+    // Nothing after the subtree: end of MIB as reported by the store
+    auto [next, value] = mib.read_next({1,3,6,1,2,1,2,2,1,16,2});
+    CHECK(std::holds_alternative<ErrorCode>(value));
+}
+
+TEST_CASE("Concurrent misses share one provider call") {
+
+    MibMgr store;
+    std::atomic<int> calls{0};
+    LazyMib mib(&store);
+    mib.register_subtree({1,3,6,1,2,1,2,2}, [&calls](std::vector<MibEntry>& objects) {
+        ++calls;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        objects.push_back({{1,3,6,1,2,1,2,2,1,10,1}, int64_t{7}});
+    }, std::chrono::hours(1));
+
+    std::vector<std::thread> readers;
+    std::atomic<int> correct{0};
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            if (std::get<int64_t>(mib.read({1,3,6,1,2,1,2,2,1,10,1})) == 7) ++correct;
+        });
+    }
+    for (auto& reader : readers) reader.join();
+
+    CHECK(correct == 4);
+    CHECK(calls == 1);
+}
+
+TEST_CASE("A slow provider does not hold back epoch reclamation") {
+
+    ConcurrentMibMgr store;
+    store.create({1,3,6,1,2,1,1,3,0}, int64_t{0});
+    store.create({1,3,6,1,2,1,4,1,0}, int64_t{2});
+
+    std::atomic<bool> in_provider{false};
+    std::atomic<bool> release{false};
+    LazyMib mib(&store);
+    mib.register_subtree({1,3,6,1,2,1,2,2}, [&](std::vector<MibEntry>& objects) {
+        in_provider = true;
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        objects.push_back({{1,3,6,1,2,1,2,2,1,10,1}, int64_t{7}});
+    }, std::chrono::milliseconds(0));
+
+    std::thread reader([&] { CHECK(std::get<int64_t>(mib.read({1,3,6,1,2,1,2,2,1,10,1})) == 7); });
+    while (!in_provider) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // Versions retired while the provider blocks are freed all the same
+    for (int64_t tick = 1; tick <= 100; ++tick)
+        store.update({1,3,6,1,2,1,1,3,0}, tick);
+    CHECK(store.pending_reclaim() == 0);
+
+    release = true;
+    reader.join();
+
+    // Walks refresh outside the store's walk too
+    std::vector<OID> walked;
+    mib.walk({1,3}, [&](const OID& oid, const SnmpVariant&) {
+        walked.push_back(oid);
+        return true;
+    });
+    CHECK(walked == std::vector<OID>{{1,3,6,1,2,1,1,3,0}, {1,3,6,1,2,1,2,2,1,10,1}, {1,3,6,1,2,1,4,1,0}});
+}
@@ -0,0 +1,192 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_mib_snapshot.hpp"
+#include "../src/az_snmp_prot_handler.hpp"
+
+using namespace SnmpServer;
+
+static std::string snapshot_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() /
+            ("az_snmp_" + name + "_" + std::to_string(getpid()) + ".mib")).string();
+}
+
+static std::vector<uint8_t> encode_varbind(const OID& oid, const SnmpVariant& value) {
+    BerWriter writer;
+    writer.write_variant(value);
+    writer.write_oid(oid);
+    writer.close(DataType::SEQUENCE, 0);
+    return {writer.data().begin(), writer.data().end()};
+}
+
+/**
+ * @brief Every object of mib, as the VarBinds a walk would answer
+ */
+static std::vector<std::vector<uint8_t>> walk_all(MibIntf& mib) {
+    std::vector<std::vector<uint8_t>> objects;
+    mib.walk(OID{}, [&](const OID& oid, const SnmpVariant& value) {
+        objects.push_back(encode_varbind(oid, value));
+        return true;
+    });
+    return objects;
+}
+
+TEST_CASE("A mapped snapshot serves what the store held") {
+
+    MibMgr store;
+    store.create({1,3,6,1,2,1,1,1,0}, "Snapshot agent");
+    store.create({1,3,6,1,2,1,1,2,0}, OID{1,3,6,1,4,1,32473});
+    store.create({1,3,6,1,2,1,1,3,0}, int64_t{-123456789});
+    store.create({1,3,6,1,2,1,1,4,0}, std::pmr::string(300, 'c')); // Long form length
+    store.create({1,3,6,1,2,1,1,9,0}, static_cast<ErrorCode>(DataType::NO_SUCH_OBJECT));
+    OID long_oid{1,3,6,1,4,1,32473};
+    for (uint32_t i = 0; i < 40; ++i) long_oid.push_back(i * 1000); // Beyond the inline capacity
+    store.create(long_oid, int64_t{7});
+    for (uint32_t row = 1; row <= 2000; ++row)
+        store.create({1,3,6,1,2,1,2,2,1,10,row}, int64_t{row * 3});
+
+    std::string path = snapshot_path("roundtrip");
+    CHECK(write_mib_snapshot(store, path) == 2006);
+
+    MibMgr empty;
+    MappedMib mib(path, &empty);
+    CHECK(mib.snapshot_objects() == 2006);
+
+    CHECK(walk_all(mib) == walk_all(store));
+
+    store.walk(OID{}, [&](const OID& oid, const SnmpVariant& value) {
+        CHECK(encode_varbind(oid, mib.read(oid)) == encode_varbind(oid, value));
+
+        std::vector<uint8_t> served;
+        CHECK(mib.read_encoded(oid, [&](std::span<const uint8_t> varbind) { served.assign(varbind.begin(), varbind.end()); }));
+        CHECK(served == encode_varbind(oid, value));
+        return true;
+    });
+
+    auto [next, value] = mib.read_next({1,3,6,1,2,1,2,2,1,10,1999});
+    CHECK(next == OID{1,3,6,1,2,1,2,2,1,10,2000});
+    CHECK(std::holds_alternative<std::monostate>(mib.read({1,3,6,1,2,1,1,5,0})));
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Store objects are merged with the snapshot, which stays read-only") {
+
+    MibMgr source;
+    source.create({1,3,6,1,2,1,1,1,0}, "from snapshot");
+    source.create({1,3,6,1,2,1,1,3,0}, int64_t{3});
+    std::string path = snapshot_path("merge");
+    write_mib_snapshot(source, path);
+
+    MibMgr store;
+    MappedMib mib(path, &store);
+    mib.create({1,3,6,1,2,1,1,2,0}, int64_t{2});
+    mib.create({1,3,6,1,2,1,1,4,0}, int64_t{4});
+    mib.update({1,3,6,1,2,1,1,3,0}, int64_t{30});
+    mib.delete_oid({1,3,6,1,2,1,1,1,0});
+
+    CHECK(std::get<int64_t>(mib.read({1,3,6,1,2,1,1,3,0})) == 3);
+    CHECK(std::get<std::pmr::string>(mib.read({1,3,6,1,2,1,1,1,0})) == "from snapshot");
+
+    std::vector<OID> walked;
+    mib.walk(OID{}, [&](const OID& oid, const SnmpVariant&) {
+        walked.push_back(oid);
+        return true;
+    });
+    CHECK(walked == std::vector<OID>{{1,3,6,1,2,1,1,1,0}, {1,3,6,1,2,1,1,2,0}, {1,3,6,1,2,1,1,3,0}, {1,3,6,1,2,1,1,4,0}});
+
+    auto [next, value] = mib.read_next({1,3,6,1,2,1,1,1,0});
+    CHECK(next == OID{1,3,6,1,2,1,1,2,0});
+
+    // A new snapshot replaces the file; the mapped one is unchanged
+    source.update({1,3,6,1,2,1,1,3,0}, int64_t{33});
+    write_mib_snapshot(source, path);
+    CHECK(std::get<int64_t>(mib.read({1,3,6,1,2,1,1,3,0})) == 3);
+    CHECK(std::get<int64_t>(MappedMib(path, &store).read({1,3,6,1,2,1,1,3,0})) == 33);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Files that are not valid snapshots are rejected") {
+
+    MibMgr store;
+    store.create({1,3,6,1,2,1,1,3,0}, int64_t{3});
+    std::string path = snapshot_path("invalid");
+    write_mib_snapshot(store, path);
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    auto rejected = [&](std::vector<char> content) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(content.data(), content.size());
+        try {
+            MappedMib mib(path, &store);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+
+    CHECK_FALSE(rejected(bytes));
+    CHECK(rejected({bytes.begin(), bytes.begin() + 20}));       // Truncated header
+    CHECK(rejected({bytes.begin(), bytes.end() - 1}));          // Truncated values
+    std::vector<char> wrong_magic = bytes;
+    wrong_magic[0] = 'X';
+    CHECK(rejected(wrong_magic));
+    std::vector<char> wrong_version = bytes;
+    wrong_version[offsetof(MibSnapshotHeader, version)] = 2;
+    CHECK(rejected(wrong_version));
+    CHECK_THROWS(MappedMib(path + ".missing", &store));
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("A corrupted index entry keeps its place in the response") {
+
+    MibMgr store;
+    store.create({1,3,6,1,2,1,1,3,0}, int64_t{3});
+    store.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+    std::string path = snapshot_path("corrupted");
+    write_mib_snapshot(store, path);
+
+    // Only the snapshot itself is left beside path
+    size_t files = 0;
+    for (const auto& file : std::filesystem::directory_iterator(std::filesystem::path(path).parent_path()))
+        files += file.path().string().starts_with(path);
+    CHECK(files == 1);
+
+    // sysUpTime's VarBind now points past the end of the file
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    uint32_t length = 1u << 30;
+    file.seekp(sizeof(MibSnapshotHeader) + offsetof(MibSnapshotEntry, varbind_len));
+    file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    file.close();
+
+    MibMgr empty;
+    MappedMib mib(path, &empty);
+    CHECK_FALSE(mib.read_encoded({1,3,6,1,2,1,1,3,0}, [](std::span<const uint8_t>) {}));
+
+    // The response still has one VarBind per requested object
+    SnmpPdu pdu;
+    pdu.version = 1;
+    pdu.community = "public";
+    pdu.command = "GET_REQUEST";
+    pdu.req_id = 1;
+    for (OID oid : {OID{1,3,6,1,2,1,1,3,0}, OID{1,3,6,1,2,1,1,5,0}})
+        pdu.vars.push_back({std::move(oid), 0, std::monostate{}});
+    SnmpProtocolHandler handler(&mib);
+    auto response = handler.process_response(handler.resp_get(pdu));
+    REQUIRE(response);
+    REQUIRE(response->vars.size() == 2);
+    CHECK(response->vars[0].oid == OID{1,3,6,1,2,1,1,3,0});
+    CHECK(std::get<std::pmr::string>(response->vars[1].value) == "agent-01");
+
+    std::filesystem::remove(path);
+}
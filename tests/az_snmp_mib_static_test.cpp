@@ -0,0 +1,117 @@
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_mib_static.hpp"
+#include "../src/az_snmp_prot_handler.hpp"
+
+using namespace SnmpServer;
+
+constexpr auto SYSTEM_MIB = make_static_mib({
+    {{1,3,6,1,2,1,1,7,0}, 72},
+    {{1,3,6,1,2,1,1,1,0}, "Test agent"},
+    {{1,3,6,1,2,1,1,2,0}, StaticOid{1,3,6,1,4,1,32473}},
+    {{1,3,6,1,2,1,1,4,0}, "ops@example.com"},
+    {{1,3,6,1,4,1,32473,2,1,0}, -5},
+});
+
+// Sorted and hashed by the compiler
+static_assert(SYSTEM_MIB.size() == 5);
+static_assert(SYSTEM_MIB.objects[0].value.text == "Test agent");
+static_assert(SYSTEM_MIB.view().find(StaticOid{1,3,6,1,2,1,1,7,0}.span(), StaticOid{1,3,6,1,2,1,1,7,0}.hash) == 3);
+static_assert(SYSTEM_MIB.view().find(StaticOid{1,3,6,1,2,1,1,3,0}.span(), StaticOid{1,3,6,1,2,1,1,3,0}.hash) == 5);
+
+template <size_t... I>
+constexpr auto make_row_table(std::index_sequence<I...>) {
+    return make_static_mib({StaticMibObject{{1,3,6,1,2,1,2,2,1,2,static_cast<uint32_t>(I + 1)}, static_cast<int64_t>(I)}...});
+}
+
+TEST_CASE("Every static object is found by its run-time OID hash") {
+
+    constexpr auto ROWS = make_row_table(std::make_index_sequence<300>{});
+    StaticMibView view = ROWS.view();
+
+    for (uint32_t row = 1; row <= 300; ++row) {
+        OID oid{1,3,6,1,2,1,2,2,1,2,row};
+        size_t idx = view.find(oid.span(), oid.hash());
+        REQUIRE(idx < view.objects.size());
+        CHECK(view.objects[idx].value.integer == row - 1);
+    }
+    for (const OID& missing : {OID{1,3,6,1,2,1,2,2,1,2,301}, OID{1,3,6,1,2,1,2,2,1,2}, OID{}})
+        CHECK(view.find(missing.span(), missing.hash()) == view.objects.size());
+}
+
+TEST_CASE("Static objects sit in front of the store, merged in OID order") {
+
+    MibMgr store;
+    store.create({1,3,6,1,2,1,1,3,0}, int64_t{1234});
+    store.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+    store.create({1,3,6,1,2,1,2,1,0}, int64_t{2});
+    StaticMib mib(SYSTEM_MIB, &store);
+
+    CHECK(std::get<std::pmr::string>(mib.read({1,3,6,1,2,1,1,1,0})) == "Test agent");
+    CHECK(std::get<OID>(mib.read({1,3,6,1,2,1,1,2,0})) == OID{1,3,6,1,4,1,32473});
+    CHECK(std::get<int64_t>(mib.read({1,3,6,1,2,1,1,3,0})) == 1234);
+    CHECK(std::holds_alternative<std::monostate>(mib.read({1,3,6,1,2,1,1,6,0})));
+
+    // Static objects are read-only
+    mib.update({1,3,6,1,2,1,1,7,0}, int64_t{1});
+    CHECK(std::get<int64_t>(mib.read({1,3,6,1,2,1,1,7,0})) == 72);
+    CHECK(std::holds_alternative<std::monostate>(store.read({1,3,6,1,2,1,1,7,0})));
+
+    auto [next, value] = mib.read_next({1,3,6,1,2,1,1,2,0});
+    CHECK(next == OID{1,3,6,1,2,1,1,3,0});
+    std::tie(next, value) = mib.read_next({1,3,6,1,2,1,2,1,0});
+    CHECK(next == OID{1,3,6,1,4,1,32473,2,1,0});
+    std::tie(next, value) = mib.read_next({1,3,6,1,4,1,32473,2,1,0});
+    CHECK(std::holds_alternative<ErrorCode>(value));
+
+    std::vector<OID> walked;
+    mib.walk({1,3,6,1,2,1,1,1,0}, [&](const OID& oid, const SnmpVariant&) {
+        walked.push_back(oid);
+        return true;
+    });
+    CHECK(walked == std::vector<OID>{{1,3,6,1,2,1,1,2,0}, {1,3,6,1,2,1,1,3,0}, {1,3,6,1,2,1,1,4,0},
+                                     {1,3,6,1,2,1,1,5,0}, {1,3,6,1,2,1,1,7,0}, {1,3,6,1,2,1,2,1,0},
+                                     {1,3,6,1,4,1,32473,2,1,0}});
+}
+
+TEST_CASE("GET answers from the static table are the ones encoded from the values") {
+
+    MibMgr store;
+    MibMgr copy;
+    for (const StaticMibObject& object : SYSTEM_MIB.objects)
+        copy.create(object.oid.to_oid(), object.value.to_variant());
+    StaticMib mib(SYSTEM_MIB, &store);
+
+    for (const StaticMibObject& object : SYSTEM_MIB.objects) {
+        std::vector<uint8_t> served;
+        CHECK(mib.read_encoded(object.oid.to_oid(), [&](std::span<const uint8_t> varbind) {
+            served.assign(varbind.begin(), varbind.end());
+        }));
+
+        BerWriter writer;
+        writer.write_variant(copy.read(object.oid.to_oid()));
+        writer.write_oid(object.oid.to_oid());
+        writer.close(DataType::SEQUENCE, 0);
+        CHECK(served == std::vector<uint8_t>(writer.data().begin(), writer.data().end()));
+    }
+    CHECK_FALSE(mib.read_encoded({1,3,6,1,2,1,1,5,0}, [](std::span<const uint8_t>) {}));
+}
+
+TEST_CASE("Batches pass through to the store, without the static objects") {
+
+    MibMgr store;
+    StaticMib mib(SYSTEM_MIB, &store);
+    std::vector<MibEntry> batch{
+        {{1,3,6,1,2,1,1,1,0}, "overwritten?"},
+        {{1,3,6,1,2,1,1,5,0}, "agent-01"},
+        {{1,3,6,1,2,1,1,6,0}, "rack 4"},
+    };
+    mib.apply_batch(batch);
+
+    CHECK(store.size() == 2);
+    CHECK(std::get<std::pmr::string>(mib.read({1,3,6,1,2,1,1,1,0})) == "Test agent");
+    CHECK(std::get<std::pmr::string>(mib.read({1,3,6,1,2,1,1,6,0})) == "rack 4");
+}
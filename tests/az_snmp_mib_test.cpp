@@ -0,0 +1,196 @@
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_global.hpp"
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_mib_concurrent.hpp"
+
+using namespace SnmpServer;
+
+TEST_CASE("MIB walk follows OID order") {
+
+    MibMgr mibMgr;
+    mibMgr.create({1,3,6,1,4,1,121,1,10}, int64_t{10});
+    mibMgr.create({1,3,6,1,4,1,121,1,2}, int64_t{2});
+    mibMgr.create({1,3,6,1,4,1,121,1,1}, int64_t{1});
+    mibMgr.create({1,3,6,1,4,1,121,1}, "prefix");
+
+    REQUIRE(std::get<int64_t>(mibMgr.read({1,3,6,1,4,1,121,1,10})) == 10);
+    REQUIRE(std::holds_alternative<std::monostate>(mibMgr.read({1,3,6,1,4,1,121,1,3})));
+
+    std::vector<OID> walk;
+    OID cursor{1,3,6,1,4,1,121};
+    while (true) {
+        auto [next, value] = mibMgr.read_next(cursor);
+        if (std::holds_alternative<ErrorCode>(value)) break;
+        walk.push_back(next);
+        cursor = next;
+    }
+
+    REQUIRE(walk.size() == 4);
+    REQUIRE((walk[0] == OID{1,3,6,1,4,1,121,1}));
+    REQUIRE((walk[1] == OID{1,3,6,1,4,1,121,1,1}));
+    REQUIRE((walk[2] == OID{1,3,6,1,4,1,121,1,2}));
+    REQUIRE((walk[3] == OID{1,3,6,1,4,1,121,1,10}));
+}
+
+TEST_CASE("MIB keeps order across leaf splits") {
+
+    MibMgr mibMgr;
+    std::vector<uint32_t> rows(2000);
+    for (uint32_t i = 0; i < rows.size(); ++i) rows[i] = i + 1;
+    std::shuffle(rows.begin(), rows.end(), std::mt19937{42});
+
+    for (uint32_t row : rows)
+        mibMgr.create({1,3,6,1,2,1,2,2,1,1,row}, int64_t{row});
+    mibMgr.delete_oid({1,3,6,1,2,1,2,2,1,1,500});
+
+    REQUIRE(mibMgr.size() == 1999);
+
+    OID cursor{1,3,6,1,2,1,2,2,1,1};
+    int64_t expected = 1;
+    while (true) {
+        auto [next, value] = mibMgr.read_next(cursor);
+        if (std::holds_alternative<ErrorCode>(value)) break;
+        if (expected == 500) ++expected;
+        REQUIRE(std::get<int64_t>(value) == expected);
+        ++expected;
+        cursor = next;
+    }
+    REQUIRE(expected == 2001);
+}
+
+TEST_CASE("Concurrent MIB readers see consistent snapshots") {
+
+    ConcurrentMibMgr mibMgr;
+    for (uint32_t row = 1; row <= 300; ++row)
+        mibMgr.create({1,3,6,1,2,1,2,2,1,10,row}, int64_t{0});
+
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                // Rows are updated in order, so a snapshot never holds
+                // more than two consecutive rounds, newest first
+                int64_t first = -1;
+                mibMgr.for_each([&](const OID&, const SnmpVariant& value) {
+                    int64_t v = std::get<int64_t>(value);
+                    if (first < 0) first = v;
+                    else if (v > first || first - v > 1) bad.fetch_add(1);
+                });
+                auto [next, value] = mibMgr.read_next({1,3,6,1,2,1,2,2,1,10});
+                if (!std::holds_alternative<int64_t>(value)) bad.fetch_add(1);
+            }
+        });
+    }
+
+    for (int64_t round = 1; round <= 20; ++round)
+        for (uint32_t row = 1; row <= 300; ++row)
+            mibMgr.update({1,3,6,1,2,1,2,2,1,10,row}, round);
+
+    done.store(true);
+    for (auto& reader : readers) reader.join();
+
+    REQUIRE(bad.load() == 0);
+    REQUIRE(mibMgr.size() == 300);
+    REQUIRE(std::get<int64_t>(mibMgr.read({1,3,6,1,2,1,2,2,1,10,300})) == 20);
+}
+
+/**
+ * @brief Applies the same random batches to store and to a reference made
+ * of single operations, comparing both after each batch
+ */
+template <typename Mib>
+static void check_batches_match_single_operations() {
+    Mib mib;
+    MibMgr reference;
+    std::mt19937 rng(7);
+    auto oid_of = [](uint32_t key) { return OID{1,3,6,1,2,1,2,2,1,key / 1000 + 1,key % 1000 + 1}; };
+
+    // Bulk load into the empty MIB
+    std::vector<MibEntry> load;
+    for (uint32_t key = 0; key < 6000; key += 2) load.push_back({oid_of(key), int64_t{key}});
+    mib.apply_batch(load);
+    for (const MibEntry& entry : load) reference.create(entry.oid, entry.value);
+
+    for (int round = 0; round < 60; ++round) {
+        std::vector<uint32_t> keys(rng() % 400 + 1);
+        for (uint32_t& key : keys) key = rng() % 8000;
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::vector<MibEntry> upserts;
+        std::vector<OID> deletes;
+        for (uint32_t key : keys) {
+            if (rng() % 3 == 0) deletes.push_back(oid_of(key));
+            else upserts.push_back({oid_of(key), int64_t{round}});
+        }
+        mib.apply_batch(upserts, deletes);
+        for (const MibEntry& entry : upserts) reference.update(entry.oid, entry.value);
+        for (const OID& oid : deletes) reference.delete_oid(oid);
+
+        REQUIRE(mib.size() == reference.size());
+        std::vector<std::pair<OID, int64_t>> expected, actual;
+        reference.for_each([&](const OID& oid, const SnmpVariant& value) { expected.emplace_back(oid, std::get<int64_t>(value)); });
+        mib.for_each([&](const OID& oid, const SnmpVariant& value) { actual.emplace_back(oid, std::get<int64_t>(value)); });
+        REQUIRE(actual == expected);
+    }
+}
+
+TEST_CASE("Batches give the MIB that single operations give") {
+
+    check_batches_match_single_operations<MibMgr>();
+    check_batches_match_single_operations<ConcurrentMibMgr>();
+
+    MibMgr mibMgr;
+    std::vector<MibEntry> unsorted{{{1,3,6,1,2,1,1,5,0}, int64_t{1}}, {{1,3,6,1,2,1,1,1,0}, int64_t{2}}};
+    CHECK_THROWS(mibMgr.apply_batch(unsorted));
+    CHECK(mibMgr.size() == 0);
+}
+
+TEST_CASE("Concurrent MIB readers never see part of a batch") {
+
+    // ifTable layout: the columns of one row are far apart in OID order
+    auto cell = [](uint32_t column, uint32_t row) { return OID{1,3,6,1,2,1,2,2,1,column,row}; };
+    ConcurrentMibMgr mibMgr;
+    std::vector<MibEntry> table;
+    for (uint32_t column = 1; column <= 8; ++column)
+        for (uint32_t row = 1; row <= 100; ++row)
+            table.push_back({cell(column, row), int64_t{0}});
+    mibMgr.apply_batch(table);
+
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+    std::thread reader([&] {
+        while (!done.load()) {
+            std::vector<int64_t> row_value(101, -1);
+            mibMgr.for_each([&](const OID& oid, const SnmpVariant& value) {
+                int64_t& seen = row_value[oid.back()];
+                int64_t v = std::get<int64_t>(value);
+                if (seen >= 0 && seen != v) bad.fetch_add(1);
+                seen = v;
+            });
+        }
+    });
+
+    // One batch per row refresh: every column of the row at once
+    for (int64_t round = 1; round <= 30; ++round) {
+        for (uint32_t row = 1; row <= 100; ++row) {
+            std::vector<MibEntry> refresh;
+            for (uint32_t column = 1; column <= 8; ++column) refresh.push_back({cell(column, row), round});
+            mibMgr.apply_batch(refresh);
+        }
+    }
+
+    done.store(true);
+    reader.join();
+    REQUIRE(bad.load() == 0);
+    REQUIRE(std::get<int64_t>(mibMgr.read(cell(8, 100))) == 30);
+}
@@ -0,0 +1,135 @@
+#include <random>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_ber.hpp"
+
+using namespace SnmpServer;
+
+TEST_CASE("OID stays inline up to the inline capacity and spills beyond") {
+
+    OID oid;
+    for (uint32_t i = 0; i < SnmpOid::INLINE_CAPACITY; ++i) oid.push_back(i);
+    CHECK(oid.is_inline());
+    CHECK(oid.size() == SnmpOid::INLINE_CAPACITY);
+
+    oid.push_back(99);
+    CHECK_FALSE(oid.is_inline());
+    CHECK(oid.back() == 99);
+    CHECK(oid[3] == 3);
+
+    // Copies and moves keep contents and hash
+    OID copy = oid;
+    CHECK(copy == oid);
+    CHECK(copy.hash() == oid.hash());
+
+    OID moved = std::move(copy);
+    CHECK(moved == oid);
+    CHECK(copy.empty());
+
+    OID small{1,3,6,1};
+    moved = small;
+    CHECK(moved == small);
+    moved = std::move(oid);
+    CHECK(moved.size() == SnmpOid::INLINE_CAPACITY + 1);
+}
+
+TEST_CASE("OID hash, compare and prefix") {
+
+    std::vector<uint32_t> ids{1,3,6,1,2,1,1,5,0};
+    OID listed{1,3,6,1,2,1,1,5,0};
+    OID spanned{std::span<const uint32_t>(ids)};
+    OID pushed;
+    for (uint32_t id : ids) pushed.push_back(id);
+
+    // Same value whichever way it was built
+    CHECK(listed == spanned);
+    CHECK(listed == pushed);
+    CHECK(listed.hash() == pushed.hash());
+
+    pushed.pop_back();
+    CHECK(pushed == OID{1,3,6,1,2,1,1,5});
+    CHECK(pushed.hash() == OID{1,3,6,1,2,1,1,5}.hash());
+
+    // A prefix sorts before its children
+    CHECK(oid_compare(pushed, listed) < 0);
+    CHECK(oid_compare(listed, pushed) > 0);
+    CHECK(OID{1,3,6,1,2,1,1,5,0} < OID{1,3,6,1,2,1,2});
+    CHECK(OID{1,3,6,1,2,1,10} > OID{1,3,6,1,2,1,9,1});
+
+    CHECK(oid_has_prefix(listed, pushed));
+    CHECK(oid_has_prefix(listed, listed));
+    CHECK_FALSE(oid_has_prefix(pushed, listed));
+    CHECK_FALSE(oid_has_prefix(listed, OID{1,3,6,1,4}));
+
+    std::unordered_set<OID> set{listed, pushed};
+    CHECK(set.count(spanned) == 1);
+    CHECK(set.size() == 2);
+}
+
+TEST_CASE("OID base-128 codec round-trips large sub-identifiers") {
+
+    std::vector<OID> oids{
+        {1,3,6,1,4,1,25000,1,2,127,128,16383,16384},
+        {1,3,6,1,4,1,4294967295u,2097151,2097152,268435455,268435456},
+        {2,999,3},
+        {0,0},
+        {1,3,6,1,2,1,2,2,1,1,1,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30},
+    };
+    for (const OID& oid : oids) {
+        BerWriter writer;
+        writer.write_oid(oid);
+        size_t index = 0;
+        auto tlv = readBerTlv(writer.data(), index);
+        REQUIRE(tlv.has_value());
+        auto view = parseOid(tlv->value);
+        REQUIRE(view.has_value());
+        CHECK(view->size() == oid.size());
+        CHECK(view->to_oid() == oid);
+        CHECK(*view == oid);
+    }
+
+    // 25000 is two bytes: 0x81 0xC3 0x28
+    BerWriter writer;
+    writer.write_oid({1,3,6,1,4,1,25000});
+    std::vector<uint8_t> expected{0x06, 0x08, 0x2B, 0x06, 0x01, 0x04, 0x01, 0x81, 0xC3, 0x28};
+    CHECK(std::vector<uint8_t>(writer.data().begin(), writer.data().end()) == expected);
+}
+
+TEST_CASE("Vector OID paths match the scalar code") {
+
+    std::mt19937 rng(7);
+    for (int round = 0; round < 500; ++round) {
+        // Mostly single-byte sub-identifiers, with some long ones
+        std::vector<uint32_t> ids(rng() % 70);
+        for (uint32_t& id : ids) id = (rng() % 4) ? rng() % 128 : rng() >> (rng() % 32);
+
+        size_t size = ber_subids_size(ids.data(), ids.size());
+        std::vector<uint8_t> body(size);
+        CHECK(ber_encode_subids(ids.data(), ids.size(), body.data()) == body.data() + size);
+
+        std::vector<uint8_t> scalar_body;
+        for (uint32_t id : ids) {
+            uint8_t bytes[5];
+            scalar_body.insert(scalar_body.end(), bytes, ber_encode_subid(id, bytes));
+        }
+        CHECK(body == scalar_body);
+
+        CHECK(ber_count_subids(body) == ids.size());
+        CHECK(ber_count_subids_scalar(body) == ids.size());
+        std::vector<uint32_t> decoded(ids.size());
+        CHECK(ber_decode_subids(body, decoded.data()) == ids.size());
+        CHECK(decoded == ids);
+
+        if (ids.empty()) continue;
+        std::vector<uint32_t> other = ids;
+        size_t at = rng() % ids.size();
+        other[at] ^= 1;
+        CHECK(subid_mismatch(ids.data(), other.data(), ids.size()) == at);
+        CHECK(subid_mismatch_scalar(ids.data(), other.data(), ids.size()) == at);
+        CHECK(subid_mismatch(ids.data(), ids.data(), ids.size()) == ids.size());
+    }
+}
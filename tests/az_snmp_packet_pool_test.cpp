@@ -0,0 +1,40 @@
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_packet_pool.hpp"
+
+using namespace SnmpServer;
+
+TEST_CASE("Packet pool recycles contexts and counts exhaustion") {
+
+    PacketPool pool(2, 1500);
+    REQUIRE(pool.capacity() == 2);
+
+    SnmpPacketContext* first = nullptr;
+    {
+        PacketPtr a = pool.acquire();
+        first = a.get();
+        REQUIRE(a->raw_data.size() == 1500);
+        a->raw_data.resize(42);
+    }
+    // Released on destruction, then handed out again at full size
+    std::vector<PacketPtr> held;
+    held.push_back(pool.acquire());
+    held.push_back(pool.acquire());
+    CHECK((held[0].get() == first || held[1].get() == first));
+    CHECK(held[0]->raw_data.size() == 1500);
+    CHECK(pool.exhausted() == 0);
+
+    // Slab empty: served from the heap and counted
+    PacketPtr extra = pool.acquire();
+    REQUIRE(extra);
+    CHECK(extra->owner == nullptr);
+    CHECK(extra->raw_data.size() == 1500);
+    CHECK(pool.exhausted() == 1);
+
+    held.clear();
+    PacketPtr again = pool.acquire();
+    CHECK(again->owner == &pool);
+    CHECK(pool.exhausted() == 1);
+}
@@ -8,6 +8,7 @@
 #include "../src/az_snmp_global.hpp"
 #include "../src/az_snmp_mib.hpp"
 #include "../src/az_snmp_prot_handler.hpp"
+#include "../src/az_snmp_arena.hpp"
 
 using namespace SnmpServer;
 
@@ -23,7 +24,7 @@ TEST_CASE("Process GET-REQUEST") {
                                           0x30,0x0E,0x30,0x0C,0x06,0x08,0x2B,0x06,0x01,
                                           0x02,0x01,0x01,0x01,0x00,0x05,0x00};
 
-    SnmpPdu pdu = handler.process_request(raw_data);
+    SnmpPdu pdu = *handler.process_request(raw_data);
 
     printSnmpPdu(pdu);
 
@@ -63,10 +64,9 @@ TEST_CASE("Build GET-RESPONSE") {
     vars.type = 0x0;
     pdu.vars.push_back(vars);
 
-    std::vector<std::uint8_t> resp_msg = {0x30,0x55,0x02,0x04,0x00,0x00,0x00,0x00,0x04,
-                                         0x06,0x70,0x75,0x62,0x6C,0x69,0x63,0xA2,0x45,
-                                         0x02,0x04,0x20,0xA5,0xD3,0xE3,0x02,0x04,0x00,
-                                         0x00,0x00,0x00,0x02,0x04,0x00,0x00,0x00,0x00,
+    std::vector<std::uint8_t> resp_msg = {0x30,0x4C,0x02,0x01,0x00,0x04,0x06,0x70,0x75,
+                                         0x62,0x6C,0x69,0x63,0xA2,0x3F,0x02,0x04,0x20,
+                                         0xA5,0xD3,0xE3,0x02,0x01,0x00,0x02,0x01,0x00,
                                          0x30,0x31,0x30,0x2F,0x06,0x08,0x2B,0x06,0x01,
                                          0x02,0x01,0x01,0x01,0x00,0x04,0x23,0x53,0x4E,
                                          0x4D,0x50,0x20,0x53,0x65,0x72,0x76,0x65,0x72,
@@ -78,6 +78,217 @@ TEST_CASE("Build GET-RESPONSE") {
 
     print_hex_buffer(response);
 
+    REQUIRE(response.size() == resp_msg.size());
     REQUIRE((std::equal(response.begin(), response.end(), resp_msg.begin())) == true);
 
-}
\ No newline at end of file
+}
+
+TEST_CASE("Process SET-REQUEST with long form lengths") {
+
+    MibMgr mibMgr;
+    auto handler = SnmpProtocolHandler(&mibMgr);
+
+    std::string value(200, 'x');
+
+    // VarBind: OID 1.3.6.1.2.1.1.5.0 + OCTET STRING (200 bytes, 0x81 long form)
+    std::vector<std::uint8_t> varbind = {0x06,0x08,0x2B,0x06,0x01,0x02,0x01,0x01,0x05,0x00,
+                                         0x04,0x81,0xC8};
+    varbind.insert(varbind.end(), value.begin(), value.end());
+
+    std::vector<std::uint8_t> pdu_body = {0x02,0x01,0x07,0x02,0x01,0x00,0x02,0x01,0x00,
+                                          0x30,0x81,0xD8,0x30,0x81,0xD5};
+    pdu_body.insert(pdu_body.end(), varbind.begin(), varbind.end());
+
+    std::vector<std::uint8_t> message = {0x02,0x01,0x00,0x04,0x06,0x70,0x75,0x62,0x6C,0x69,0x63,
+                                         0xA3,0x81,0xE4};
+    message.insert(message.end(), pdu_body.begin(), pdu_body.end());
+
+    std::vector<std::uint8_t> raw_data = {0x30,0x81,0xF2};
+    raw_data.insert(raw_data.end(), message.begin(), message.end());
+
+    SnmpPdu pdu = *handler.process_request(raw_data);
+
+    REQUIRE(pdu.command == "SET_REQUEST");
+    REQUIRE(pdu.req_id == 7);
+    REQUIRE(pdu.vars.size() == 1);
+    REQUIRE((pdu.vars.at(0).oid == OID{1,3,6,1,2,1,1,5,0}));
+    REQUIRE(std::get<std::pmr::string>(pdu.vars.at(0).value) == std::string_view(value));
+
+    // Truncated buffer must be rejected without reading past the end
+    raw_data.resize(raw_data.size() - 10);
+    REQUIRE_FALSE(handler.process_request(raw_data));
+}
+
+
+TEST_CASE("BER writer minimal encodings") {
+
+    BerWriter writer;
+    auto encode = [&](auto&& fn) {
+        writer.reset();
+        fn();
+        auto out = writer.data();
+        return std::vector<std::uint8_t>(out.begin(), out.end());
+    };
+
+    REQUIRE(encode([&]{ writer.write_integer(0); }) == std::vector<std::uint8_t>{0x02,0x01,0x00});
+    REQUIRE(encode([&]{ writer.write_integer(127); }) == std::vector<std::uint8_t>{0x02,0x01,0x7F});
+    REQUIRE(encode([&]{ writer.write_integer(128); }) == std::vector<std::uint8_t>{0x02,0x02,0x00,0x80});
+    REQUIRE(encode([&]{ writer.write_integer(-1); }) == std::vector<std::uint8_t>{0x02,0x01,0xFF});
+    REQUIRE(encode([&]{ writer.write_integer(-129); }) == std::vector<std::uint8_t>{0x02,0x02,0xFF,0x7F});
+
+    REQUIRE(encode([&]{ writer.write_oid(OID{1,3,6,1,4,1,25000}); }) ==
+            std::vector<std::uint8_t>{0x06,0x08,0x2B,0x06,0x01,0x04,0x01,0x81,0xC3,0x28});
+
+    auto long_string = encode([&]{ writer.write_octet_string(std::string(200, 'x')); });
+    REQUIRE(long_string.size() == 203);
+    REQUIRE(long_string[0] == 0x04);
+    REQUIRE(long_string[1] == 0x81);
+    REQUIRE(long_string[2] == 0xC8);
+}
+
+/**
+ * @brief v2c GetBulkRequest with NULL varbinds
+ */
+static std::vector<std::uint8_t> encode_bulk_request(std::vector<OID> oids, int non_repeaters, int max_repetitions) {
+    BerWriter writer;
+    for (auto it = oids.rbegin(); it != oids.rend(); ++it) {
+        size_t start = writer.mark();
+        writer.write_null();
+        writer.write_oid(*it);
+        writer.close(DataType::SEQUENCE, start);
+    }
+    writer.close(DataType::SEQUENCE, 0);
+    writer.write_integer(max_repetitions);
+    writer.write_integer(non_repeaters);
+    writer.write_integer(42);
+    writer.close(DataType::GET_BULK_REQUEST, 0);
+    writer.write_octet_string("public");
+    writer.write_integer(1);
+    writer.close(DataType::SEQUENCE, 0);
+    auto out = writer.data();
+    return {out.begin(), out.end()};
+}
+
+/**
+ * @brief (OID, value tag) of every varbind in a GET-RESPONSE
+ */
+static std::vector<std::pair<OID, std::uint8_t>> response_varbinds(std::span<const std::uint8_t> packet) {
+    std::vector<std::pair<OID, std::uint8_t>> out;
+    size_t pos = 0;
+    auto message = readBerTlv(packet, pos);
+    REQUIRE(message);
+    REQUIRE(pos == packet.size());
+
+    pos = 0;
+    readBerTlv(message->value, pos); // version
+    readBerTlv(message->value, pos); // community
+    auto pdu = readBerTlv(message->value, pos);
+    REQUIRE(pdu);
+    REQUIRE(pdu->tag == static_cast<std::uint8_t>(DataType::GET_RESPONSE));
+
+    pos = 0;
+    auto req_id = readBerTlv(pdu->value, pos);
+    REQUIRE(*parseInt(req_id->value) == 42);
+    readBerTlv(pdu->value, pos);
+    readBerTlv(pdu->value, pos);
+    auto list = readBerTlv(pdu->value, pos);
+    REQUIRE(list);
+
+    pos = 0;
+    while (pos < list->value.size()) {
+        auto varbind = readBerTlv(list->value, pos);
+        REQUIRE(varbind);
+        size_t vpos = 0;
+        auto oid = readBerTlv(varbind->value, vpos);
+        auto value = readBerTlv(varbind->value, vpos);
+        REQUIRE(oid);
+        REQUIRE(value);
+        out.emplace_back(parseOid(oid->value)->to_oid(), value->tag);
+    }
+    return out;
+}
+
+TEST_CASE("Process GETBULK-REQUEST") {
+
+    MibMgr mibMgr;
+    mibMgr.create({1,3,6,1,2,1,1,3,0}, int64_t{1234}); // sysUpTime
+    for (uint32_t column = 1; column <= 2; ++column)
+        for (uint32_t row = 1; row <= 3; ++row)
+            mibMgr.create({1,3,6,1,2,1,2,2,1,column,row}, int64_t{row});
+    auto handler = SnmpProtocolHandler(&mibMgr);
+
+    // sysUpTime as non-repeater, then two columns walked side by side
+    auto request = encode_bulk_request({{1,3,6,1,2,1,1,3}, {1,3,6,1,2,1,2,2,1,1}, {1,3,6,1,2,1,2,2,1,2}}, 1, 2);
+    SnmpPdu pdu = *handler.process_request(request);
+    REQUIRE(pdu.command == "GET_BULK_REQUEST");
+    REQUIRE(pdu.err_status == 1);
+    REQUIRE(pdu.err_idx == 2);
+    REQUIRE(pdu.vars.size() == 3);
+
+    auto varbinds = response_varbinds(handler.resp_get(pdu));
+    REQUIRE(varbinds.size() == 5);
+    CHECK((varbinds[0].first == OID{1,3,6,1,2,1,1,3,0}));
+    CHECK((varbinds[1].first == OID{1,3,6,1,2,1,2,2,1,1,1}));
+    CHECK((varbinds[2].first == OID{1,3,6,1,2,1,2,2,1,2,1}));
+    CHECK((varbinds[3].first == OID{1,3,6,1,2,1,2,2,1,1,2}));
+    CHECK((varbinds[4].first == OID{1,3,6,1,2,1,2,2,1,2,2}));
+
+    // Single repeater past the end of the MIB
+    auto tail = handler.resp_get(*handler.process_request(encode_bulk_request({{1,3,6,1,2,1,2,2,1,2,2}}, 0, 10)));
+    varbinds = response_varbinds(tail);
+    REQUIRE(varbinds.size() == 2);
+    CHECK((varbinds[0].first == OID{1,3,6,1,2,1,2,2,1,2,3}));
+    CHECK(varbinds[0].second == static_cast<std::uint8_t>(DataType::INTEGER));
+    CHECK((varbinds[1].first == OID{1,3,6,1,2,1,2,2,1,2,3}));
+    CHECK(varbinds[1].second == static_cast<std::uint8_t>(DataType::END_OF_MIB_VIEW));
+}
+
+TEST_CASE("GETBULK response is truncated to the size limit") {
+
+    MibMgr mibMgr;
+    for (uint32_t row = 1; row <= 500; ++row)
+        mibMgr.create({1,3,6,1,2,1,2,2,1,2,row}, std::pmr::string(20, 'x'));
+
+    for (size_t limit : {size_t{200}, SnmpProtocolHandler::MAX_RESPONSE_SIZE}) {
+        SnmpProtocolHandler handler(&mibMgr, limit);
+        BerWriter writer;
+        auto pdu = *handler.process_request(encode_bulk_request({{1,3,6,1,2,1,2,2,1,2}}, 0, 1000));
+        auto packet = handler.resp_get(pdu, writer);
+
+        REQUIRE(packet.size() <= limit);
+        auto varbinds = response_varbinds(packet);
+        REQUIRE(varbinds.size() > 1);
+        // One more varbind (same encoded size) would not have fitted
+        CHECK(packet.size() + packet.size() / varbinds.size() > limit);
+        for (size_t i = 0; i < varbinds.size(); ++i)
+            CHECK((varbinds[i].first == OID{1,3,6,1,2,1,2,2,1,2,static_cast<uint32_t>(i + 1)}));
+    }
+}
+
+TEST_CASE("Requests decode into a reused arena") {
+
+    MibMgr mibMgr;
+    auto handler = SnmpProtocolHandler(&mibMgr);
+    auto request = encode_bulk_request({{1,3,6,1,2,1,2,2,1,1}, {1,3,6,1,2,1,2,2,1,2}}, 0, 5);
+
+    RequestArena arena;
+    const void* first_vars = nullptr;
+    {
+        SnmpPdu pdu = *handler.process_request(request, arena.allocator());
+        REQUIRE(pdu.vars.size() == 2);
+        CHECK(pdu.vars.get_allocator() == arena.allocator());
+        CHECK(pdu.community.get_allocator() == arena.allocator());
+        CHECK(pdu.vars[1].oid.is_inline());
+        first_vars = pdu.vars.data();
+
+        // Copies kept beyond the request (e.g. by the MIB) use the heap
+        std::pmr::string copy = pdu.community;
+        CHECK(copy.get_allocator() != arena.allocator());
+    }
+
+    // Same memory again after a reset
+    arena.reset();
+    SnmpPdu pdu = *handler.process_request(request, arena.allocator());
+    CHECK(pdu.vars.data() == first_vars);
+    CHECK((pdu.vars[1].oid == OID{1,3,6,1,2,1,2,2,1,2}));
+}
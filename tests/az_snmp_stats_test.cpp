@@ -0,0 +1,170 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_mib.hpp"
+#include "../src/az_snmp_stats_mib.hpp"
+#include "../src/az_snmp_worker_task.hpp"
+
+using namespace SnmpServer;
+
+/**
+ * @brief Transport keeping the responses sent
+ */
+class RecordingConnect : public ConnectIntf {
+public:
+    std::vector<std::vector<uint8_t>> sent;
+
+    int init_socket(int) override { return -1; }
+    void send(int, std::span<const uint8_t> data, const sockaddr_in&) override { sent.emplace_back(data.begin(), data.end()); }
+    PacketPtr receive(int) override { return nullptr; }
+};
+
+static PacketPtr timed_get(const OID& oid) {
+    BerWriter writer;
+    writer.write_null();
+    writer.write_oid(oid);
+    writer.close(DataType::SEQUENCE, 0);
+    writer.close(DataType::SEQUENCE, 0);
+    writer.write_integer(0);
+    writer.write_integer(0);
+    writer.write_integer(7);
+    writer.close(DataType::GET_REQUEST, 0);
+    writer.write_octet_string("public");
+    writer.write_integer(1);
+    writer.close(DataType::SEQUENCE, 0);
+
+    PacketPtr context(new SnmpPacketContext{});
+    context->raw_data.assign(writer.data().begin(), writer.data().end());
+    context->received_at = StatClock::now();
+    return context;
+}
+
+TEST_CASE("Histogram percentiles stay within the bucket precision") {
+
+    LatencyHistogram histogram;
+    for (uint64_t ns = 1; ns <= 100000; ++ns)
+        histogram.record(ns);
+
+    HistogramSnapshot snapshot;
+    histogram.merge_into(snapshot);
+    CHECK(snapshot.count == 100000);
+    CHECK(snapshot.max == 100000);
+    CHECK(snapshot.mean() == 50000);
+
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        double exact = q * 100000;
+        double reported = static_cast<double>(snapshot.percentile(q));
+        CHECK(reported >= exact * 0.99);
+        CHECK(reported <= exact * 1.125 + 1);
+    }
+    CHECK(snapshot.percentile(1.0) == 100000);
+
+    // Every value falls in a bucket whose bound is not below it
+    for (uint64_t value : std::initializer_list<uint64_t>{0, 7, 8, 1000, 123456789, uint64_t{1} << 40})
+        CHECK(HistogramLayout::upper_bound(HistogramLayout::bucket(value)) >= std::min<uint64_t>(value, (uint64_t{1} << 36) - 1));
+}
+
+TEST_CASE("Counters of every thread are summed, also after the threads exit") {
+
+    AgentStats& stats = AgentStats::instance();
+    uint64_t before = stats.snapshot().counter(StatCounter::PACKETS_IN);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([] {
+            for (int i = 0; i < 1000; ++i) stat_count(StatCounter::PACKETS_IN);
+        });
+    for (auto& thread : threads) thread.join();
+    CHECK(stats.snapshot().counter(StatCounter::PACKETS_IN) - before == 4000);
+
+    // A new thread reuses a released block: the totals are kept
+    std::thread([] { stat_count(StatCounter::PACKETS_IN, 5); }).join();
+    CHECK(stats.snapshot().counter(StatCounter::PACKETS_IN) - before == 4005);
+}
+
+TEST_CASE("Workers time the stages of sampled requests and count errors") {
+
+    MibMgr store;
+    store.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+    RecordingConnect connect;
+    AgentStats& stats = AgentStats::instance();
+    StatsSnapshot before = stats.snapshot();
+
+    WorkerTask(timed_get({1,3,6,1,2,1,1,5,0}), &store, &connect, -1);
+    CHECK(connect.sent.size() == 1);
+
+    // Not sampled: counted, not timed
+    PacketPtr untimed = timed_get({1,3,6,1,2,1,1,5,0});
+    untimed->received_at = {};
+    WorkerTask(std::move(untimed), &store, &connect, -1);
+
+    PacketPtr garbage(new SnmpPacketContext{});
+    garbage->raw_data = {0x30, 0x05, 0x02, 0x01};
+    WorkerTask(std::move(garbage), &store, &connect, -1);
+    CHECK(connect.sent.size() == 2);
+
+    StatsSnapshot after = stats.snapshot();
+    for (StatStage stage : {StatStage::DECODE, StatStage::MIB, StatStage::ENCODE, StatStage::SEND})
+        CHECK(after.stage(stage).count - before.stage(stage).count == 1);
+    CHECK(after.counter(StatCounter::PACKETS_OUT) - before.counter(StatCounter::PACKETS_OUT) == connect.sent.size());
+    CHECK(after.counter(StatCounter::DECODE_ERRORS) - before.counter(StatCounter::DECODE_ERRORS) == 1);
+}
+
+TEST_CASE("Malformed datagrams are dropped without a response") {
+
+    MibMgr store;
+    store.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+    RecordingConnect connect;
+    AgentStats& stats = AgentStats::instance();
+    StatsSnapshot before = stats.snapshot();
+
+    // A truncated INTEGER, then a bare header
+    SnmpPacketBatch batch;
+    for (std::vector<uint8_t> raw : {std::vector<uint8_t>{0x30, 0x03, 0x02, 0x01}, std::vector<uint8_t>{0x30, 0x00}}) {
+        PacketPtr garbage(new SnmpPacketContext{});
+        garbage->raw_data = raw;
+        batch.push_back(std::move(garbage));
+    }
+    batch.push_back(timed_get({1,3,6,1,2,1,1,5,0}));
+    serve_batch(batch, &store, &connect, -1);
+
+    StatsSnapshot after = stats.snapshot();
+    REQUIRE(connect.sent.size() == 1);
+    CHECK(after.counter(StatCounter::PACKETS_OUT) - before.counter(StatCounter::PACKETS_OUT) == 1);
+    CHECK(after.counter(StatCounter::DECODE_ERRORS) - before.counter(StatCounter::DECODE_ERRORS) == 2);
+}
+
+TEST_CASE("Statistics are served from the enterprise subtree") {
+
+    MibMgr store;
+    store.create({1,3,6,1,2,1,1,5,0}, "agent-01");
+    LazyMib mib(&store);
+    register_stats_subtree(mib);
+
+    stat_count(StatCounter::PACKETS_IN, 3);
+    AgentStats::instance().record(StatStage::DECODE, std::chrono::microseconds(2));
+
+    OID packets_in = AZ_SNMP_STATS_PREFIX;
+    for (uint32_t subid : {1u, 1u, 0u}) packets_in.push_back(subid);
+    CHECK(std::get<int64_t>(mib.read(packets_in)) >= 3);
+
+    OID decode_name = AZ_SNMP_STATS_PREFIX;
+    for (uint32_t subid : {2u, 1u, 1u, 3u}) decode_name.push_back(subid);
+    CHECK(std::get<std::pmr::string>(mib.read(decode_name)) == "decode");
+
+    OID decode_max = AZ_SNMP_STATS_PREFIX;
+    for (uint32_t subid : {2u, 1u, 8u, 3u}) decode_max.push_back(subid);
+    CHECK(std::get<int64_t>(mib.read(decode_max)) >= 2000);
+
+    // The store comes first, then every statistic in OID order
+    std::vector<OID> walked;
+    mib.walk({1,3,6,1}, [&](const OID& oid, const SnmpVariant&) {
+        walked.push_back(oid);
+        return true;
+    });
+    CHECK(walked.size() == 1 + STAT_COUNTERS + 1 + STAT_STAGES * 8);
+    CHECK(std::is_sorted(walked.begin(), walked.end()));
+}
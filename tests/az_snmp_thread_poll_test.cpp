@@ -0,0 +1,94 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_mpmc_thread_poll.hpp"
+
+using namespace SnmpServer;
+
+TEST_CASE("MPMC queue reports full and empty") {
+
+    MpmcQueue<int> queue(4);
+    int value = 0;
+
+    REQUIRE(queue.capacity() == 4);
+    REQUIRE_FALSE(queue.try_pop(value));
+
+    for (int i = 1; i <= 4; ++i) {
+        value = i;
+        REQUIRE(queue.try_push(value));
+    }
+    value = 5;
+    REQUIRE_FALSE(queue.try_push(value));
+
+    for (int i = 1; i <= 4; ++i) {
+        REQUIRE(queue.try_pop(value));
+        CHECK(value == i);
+    }
+    REQUIRE_FALSE(queue.try_pop(value));
+}
+
+TEST_CASE("MPMC pool runs every task from many producers") {
+
+    constexpr int PRODUCERS = 4;
+    constexpr int TASKS = 20000;
+    std::atomic<int> executed{0};
+    {
+        // Small ring so producers hit back-pressure
+        MpmcThreadPoll pool(3, 64);
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            producers.emplace_back([&] {
+                for (int i = 0; i < TASKS; ++i)
+                    pool.enqueue([&] { executed.fetch_add(1, std::memory_order_relaxed); });
+            });
+        }
+        for (auto& t : producers) t.join();
+    }
+    // The destructor drains the ring before joining the workers
+    CHECK(executed.load() == PRODUCERS * TASKS);
+}
+
+TEST_CASE("MPMC pool wakes a parked worker for every queued task") {
+
+    constexpr int WORKERS = 4;
+    struct Latch {
+        std::mutex mutex;
+        std::condition_variable all_in;
+        int arrived = 0;
+        int met = 0;
+    };
+    MpmcThreadPoll pool(WORKERS);
+
+    for (int round = 0; round < 5; ++round) {
+        // Shared with the tasks, which may outlive a failed round
+        auto latch = std::make_shared<Latch>();
+        // Each task waits for all the others: only possible if every worker runs one
+        auto latch_task = [latch] {
+            std::unique_lock<std::mutex> lock(latch->mutex);
+            ++latch->arrived;
+            latch->all_in.notify_all();
+            if (latch->all_in.wait_for(lock, std::chrono::seconds(1), [&] { return latch->arrived == WORKERS; }))
+                ++latch->met;
+            latch->all_in.notify_all();
+        };
+
+        // Let every worker give up spinning and park
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // One woken worker queues the burst faster than the others can wake up
+        pool.enqueue([&pool, latch_task] {
+            for (int i = 1; i < WORKERS; ++i) pool.enqueue(latch_task);
+            latch_task();
+        });
+
+        std::unique_lock<std::mutex> lock(latch->mutex);
+        latch->all_in.wait_for(lock, std::chrono::seconds(2), [&] { return latch->met == WORKERS; });
+        CHECK(latch->met == WORKERS);
+    }
+}
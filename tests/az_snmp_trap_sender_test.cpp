@@ -0,0 +1,184 @@
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../src/az_snmp_trap_sender.hpp"
+
+using namespace SnmpServer;
+
+static const OID ENTERPRISE{1,3,6,1,4,1,32473};
+
+// linkDown, enterprise 1.3.6.1.4.1.32473, agent 192.0.2.1, uptime 12.34 s,
+// ifIndex.3 = 3, community "public"
+static const std::vector<uint8_t> LINK_DOWN_TRAP = {
+    0x30,0x3A,0x02,0x01,0x00,0x04,0x06,0x70,0x75,0x62,0x6C,0x69,0x63,0xA4,0x2D,0x06,
+    0x08,0x2B,0x06,0x01,0x04,0x01,0x81,0xFD,0x59,0x40,0x04,0xC0,0x00,0x02,0x01,0x02,
+    0x01,0x02,0x02,0x01,0x00,0x43,0x02,0x04,0xD2,0x30,0x11,0x30,0x0F,0x06,0x0A,0x2B,
+    0x06,0x01,0x02,0x01,0x02,0x02,0x01,0x01,0x03,0x02,0x01,0x03};
+
+/**
+ * @brief Trap sink on a loopback ephemeral port
+ */
+static int bind_sink(TrapSink& sink) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    timeval tv{0, 300000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(sock, (sockaddr*)&addr, sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(sock, (sockaddr*)&addr, &len);
+    sink.address = addr;
+    return sock;
+}
+
+/**
+ * @brief Decodes the traps arriving on sock until it stays quiet
+ */
+static std::vector<SnmpTrap> receive_traps(int sock, std::string* community = nullptr) {
+    SnmpProtocolHandler protocol(nullptr);
+    std::vector<SnmpTrap> traps;
+    uint8_t buf[1500];
+    ssize_t len;
+    while ((len = recv(sock, buf, sizeof(buf), 0)) > 0) {
+        auto trap = protocol.process_trap({buf, static_cast<size_t>(len)}, community);
+        REQUIRE(trap);
+        traps.push_back(std::move(*trap));
+    }
+    return traps;
+}
+
+TEST_CASE("Traps are encoded as SNMPv1 Trap-PDUs") {
+
+    SnmpTrap trap;
+    trap.enterprise = ENTERPRISE;
+    inet_pton(AF_INET, "192.0.2.1", &trap.agent_addr);
+    trap.generic_trap = GenericTrap::LINK_DOWN;
+    trap.time_stamp = 1234;
+    trap.varbinds.push_back({{1,3,6,1,2,1,2,2,1,1,3}, static_cast<uint8_t>(DataType::INTEGER), int64_t{3}});
+
+    SnmpProtocolHandler protocol(nullptr);
+    BerWriter writer;
+    std::span<const uint8_t> packet = protocol.build_trap(trap, "public", writer);
+    CHECK(std::vector<uint8_t>(packet.begin(), packet.end()) == LINK_DOWN_TRAP);
+
+    std::string community;
+    auto decoded = protocol.process_trap(LINK_DOWN_TRAP, &community);
+    REQUIRE(decoded);
+    CHECK(community == "public");
+    CHECK(decoded->enterprise == ENTERPRISE);
+    CHECK(decoded->agent_addr == trap.agent_addr);
+    CHECK(decoded->generic_trap == GenericTrap::LINK_DOWN);
+    CHECK(decoded->time_stamp == 1234);
+    REQUIRE(decoded->varbinds.size() == 1);
+    CHECK(std::get<int64_t>(decoded->varbinds[0].value) == 3);
+
+    // Requests are not traps, and traps are not requests
+    CHECK_FALSE(protocol.process_trap(std::vector<uint8_t>(LINK_DOWN_TRAP.begin(), LINK_DOWN_TRAP.end() - 1)));
+    CHECK_FALSE(protocol.process_request(LINK_DOWN_TRAP));
+}
+
+TEST_CASE("Every sink receives the traps, with its own community") {
+
+    TrapSink first, second;
+    int first_sock = bind_sink(first);
+    int second_sock = bind_sink(second);
+    second.community = "nms-2";
+
+    TrapSenderOptions options;
+    inet_pton(AF_INET, "192.0.2.1", &options.agent_address);
+    TrapSender sender({first, second}, options);
+
+    for (uint32_t specific = 1; specific <= 20; ++specific) {
+        SnmpTrap trap;
+        trap.enterprise = ENTERPRISE;
+        trap.specific_trap = specific;
+        trap.varbinds.push_back({{1,3,6,1,4,1,32473,3,specific}, static_cast<uint8_t>(DataType::OCTET_STRING), "event"});
+        CHECK(sender.send(std::move(trap)));
+    }
+
+    std::string community;
+    std::vector<SnmpTrap> traps = receive_traps(first_sock);
+    std::vector<SnmpTrap> other = receive_traps(second_sock, &community);
+    CHECK(community == "nms-2");
+    REQUIRE(traps.size() == 20);
+    CHECK(other.size() == 20);
+    for (uint32_t i = 0; i < traps.size(); ++i) {
+        CHECK(traps[i].specific_trap == i + 1);
+        CHECK(traps[i].agent_addr == options.agent_address);
+        CHECK(traps[i].generic_trap == GenericTrap::ENTERPRISE_SPECIFIC);
+    }
+    CHECK(sender.sent() == 40);
+    CHECK(sender.coalesced() == 0);
+
+    close(first_sock);
+    close(second_sock);
+}
+
+TEST_CASE("A link-flap storm is rate limited and coalesced to the latest state") {
+
+    TrapSink sink;
+    int sock = bind_sink(sink);
+    sink.rate = 20;
+    sink.burst = 5;
+    TrapSender sender({sink});
+
+    // 4 interfaces flapping 50 times each, ending up
+    for (int flap = 0; flap < 100; ++flap)
+        for (uint32_t if_index = 1; if_index <= 4; ++if_index)
+            sender.send_link(flap % 2 == 1, if_index, 1, flap % 2 == 1 ? 1 : 2, ENTERPRISE);
+
+    std::vector<SnmpTrap> traps = receive_traps(sock);
+
+    // The burst, then one waiting trap per interface
+    CHECK(traps.size() >= 5);
+    CHECK(traps.size() <= 5 + 4 + 1);
+    CHECK(sender.sent() == traps.size());
+    CHECK(sender.sent() + sender.coalesced() + sender.dropped() == 400);
+
+    std::map<uint32_t, GenericTrap> last;
+    for (const SnmpTrap& trap : traps) {
+        REQUIRE(trap.varbinds.size() == 3);
+        last[static_cast<uint32_t>(std::get<int64_t>(trap.varbinds[0].value))] = trap.generic_trap;
+    }
+    REQUIRE(last.size() == 4);
+    for (const auto& [if_index, generic] : last) CHECK(generic == GenericTrap::LINK_UP);
+
+    close(sock);
+}
+
+TEST_CASE("Traps of different kinds are never coalesced") {
+
+    TrapSink sink;
+    int sock = bind_sink(sink);
+    sink.rate = 20;
+    sink.burst = 1;
+    TrapSender sender({sink});
+
+    // No varbinds, or the same ones: only the trap type tells them apart
+    std::vector<std::pair<GenericTrap, uint32_t>> kinds{
+        {GenericTrap::COLD_START, 0}, {GenericTrap::WARM_START, 0}, {GenericTrap::AUTHENTICATION_FAILURE, 0},
+        {GenericTrap::EGP_NEIGHBOR_LOSS, 0}, {GenericTrap::ENTERPRISE_SPECIFIC, 1}, {GenericTrap::ENTERPRISE_SPECIFIC, 2}};
+    for (const auto& [generic, specific] : kinds) {
+        SnmpTrap trap;
+        trap.enterprise = ENTERPRISE;
+        trap.generic_trap = generic;
+        trap.specific_trap = specific;
+        CHECK(sender.send(std::move(trap)));
+    }
+
+    std::vector<SnmpTrap> traps = receive_traps(sock);
+    CHECK(sender.coalesced() == 0);
+    REQUIRE(traps.size() == kinds.size());
+    for (size_t i = 0; i < kinds.size(); ++i) {
+        CHECK(traps[i].generic_trap == kinds[i].first);
+        CHECK(traps[i].specific_trap == kinds[i].second);
+    }
+
+    close(sock);
+}